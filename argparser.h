@@ -5,9 +5,16 @@
 #include <cerrno>
 #include <sstream>
 
+#include "connection.h"
+#include "cpu_features.h"
 #include "global.h"
 #include "logger.h"
+#include "node_set.h"
 #include "structs.h"
+#include "tick_archive.h"
+#include "tick_follower.h"
+#include "verification_context.h"
+#include "wire_capture.h"
 #include "contracts.h"
 
 #define CHECK_OVER_PARAMETERS                                                           \
@@ -46,11 +53,35 @@ void print_help()
     printf("\t\tEnable test contract indices and names for commands using a contract index parameter. This flag has to be passed before the contract index/name. The node to connect to needs to have test contracts running.\n");
     printf("\t-print-only <base64 | hex>\n");
     printf("\t\tPrint the raw transaction data without sending it to the network. Useful for offline signing or broadcasting later.\n");
+    printf("\t-fastconnect\n");
+    printf("\t\tDon't wait for the optional RequestComputors packet when connecting to a node (saves up to 200 ms per connection).\n");
+    printf("\t-nodeset <IP[:PORT],IP[:PORT],...>\n");
+    printf("\t\tSend read-only requests (current tick, balance, tick data, contract functions) to several nodes and use the first valid response. For the current tick and balances, the responses of %d nodes (or those arriving within %d ms) are compared and the one with the highest tick is used. Responses with a tick more than %d ticks behind the highest tick seen are rejected. Other commands use the first node.\n", NODE_SET_TICK_QUORUM, NODE_SET_TICK_WINDOW_MSEC, MAX_NODE_SET_TICK_LAG);
+    printf("\t-hedge <PERCENTILE>\n");
+    printf("\t\tWith -nodeset, ask one node first and the next one only if no valid response arrived within the given latency percentile of the node (e.g. 95). Default: ask all nodes at once.\n");
+    printf("\t-record <FILE>\n");
+    printf("\t\tWrite all bytes sent to and received from nodes, with timestamps, to a capture file.\n");
+    printf("\t-replay <FILE>\n");
+    printf("\t\tServe the responses of a capture file written with -record instead of connecting to nodes. The command must send the same requests as in the recorded session. Only the blocking connections are captured, not -nodeset requests.\n");
+    printf("\t-replayspeed <FACTOR>\n");
+    printf("\t\tWith -replay, divide the recorded delays by FACTOR (default: 1, 0 = no delays).\n");
+    printf("\t-cpu <scalar | avx2 | avx512>\n");
+    printf("\t\tForce the variant of the hashing kernels, e.g. for benchmarking. Default: the best variant the CPU supports.\n");
+    printf("\t-cachekeys\n");
+    printf("\t\tSave the computor public keys prepared for signature verification to <COMPUTOR_LIST>.keys and reuse them in later runs with the same computor list. A corrupt file is prepared and written again.\n");
+    printf("\t-threads <NUMBER>\n");
+    printf("\t\tNumber of threads for -derivekeys and -buildtxindex (default: one per hardware thread).\n");
+    printf("\t-combtable <WIDTH> <TABLES>\n");
+    printf("\t\tWith -derivekeys, compute public keys with a fixed-base comb of <TABLES> tables of 2^(<WIDTH>-1) points, built at start. Wider combs take more memory and fewer point additions, e.g. 8 4 uses 48 KiB and 31 instead of 49 additions per key. Default: 5 5 (the built-in 7.5 KiB table).\n");
+    printf("\t-inflight <NUMBER>\n");
+    printf("\t\tNumber of ticks requested at once by -gettickrangetoarchive and -followticks (default: %d).\n", DEFAULT_TICKS_IN_FLIGHT);
 
     printf("\nCommands:\n");
     printf("\n[WALLET COMMANDS]\n");
     printf("\t-showkeys\n");
     printf("\t\tGenerate identity, public key and private key from seed. Seed must be passed either from params or configuration file.\n");
+    printf("\t-derivekeys <SEED_FILE> <OUTPUT_CSV_FILE>\n");
+    printf("\t\tDerive identity and public key of each seed in <SEED_FILE> (one 55-char seed per line) on all cores and write them to <OUTPUT_CSV_FILE>. Prints the keys per second. See -threads and -combtable.\n");
     printf("\t-getbalance <IDENTITY>\n");
     printf("\t\tBalance of an identity (amount of qubic, number of in/out txs)\n");
     printf("\t-getasset <IDENTITY>\n");
@@ -101,6 +132,10 @@ void print_help()
     printf("\n[BLOCKCHAIN/PROTOCOL COMMANDS]\n");
     printf("\t-gettickdata <TICK_NUMBER> <OUTPUT_FILE_NAME>\n");
     printf("\t\tGet tick data and write it to a file. Use -readtickdata to examine the file. valid node ip/port are required.\n");
+    printf("\t-gettickrangetoarchive <FIRST_TICK> <LAST_TICK> <OUTPUT_DIRECTORY>\n");
+    printf("\t\tGet tick data and transactions of all ticks from <FIRST_TICK> to <LAST_TICK> over several connections (to all nodes given with -nodeset) and append them to the tick archive <OUTPUT_DIRECTORY>, which stores %d ticks per segment file with an index. Failed ticks are retried on the next node. A tick without tick data is only archived as empty once two nodes confirm it. Running the command again skips the archived ticks, so an interrupted download resumes. Use -readtickdata and -checktxonfile with <OUTPUT_DIRECTORY> or <OUTPUT_DIRECTORY>@<TICK> to examine the archive. See -inflight. valid node ip/port are required.\n", TICK_ARCHIVE_SEGMENT_TICKS);
+    printf("\t-followticks <START_TICK>\n");
+    printf("\t\tFollow the current tick of the node (or of all nodes given with -nodeset) from <START_TICK> on (0 = the current tick) and print each transaction as one line of JSON with tick, hash, source, destination, amount, inputType and payload (hex). The next ticks are downloaded while a tick is printed. Failed ticks are retried on the next node, so no tick is skipped when a connection breaks, and a tick that keeps failing is reported as stuck. A tick without tick data is only printed as empty once a second node, if one is up, confirms it. Status messages go to stderr. Runs until stopped. See -inflight. valid node ip/port are required.\n");
     printf("\t-getquorumtick <COMP_LIST_FILE> <TICK_NUMBER>\n");
     printf("\t\tGet quorum tick data, the summary of quorum tick will be printed, <COMP_LIST_FILE> is fetched by command -getcomputorlist. valid node ip/port are required.\n");
     printf("\t-getcomputorlist <OUTPUT_FILE_NAME>\n");
@@ -116,9 +151,13 @@ void print_help()
     printf("\t-checktxontick <TICK_NUMBER> <TX_ID>\n");
     printf("\t\tCheck if a transaction is included in a tick. valid node ip/port are required.\n");
     printf("\t-checktxonfile <TX_ID> <TICK_DATA_FILE>\n");
-    printf("\t\tCheck if a transaction is included in a tick (tick data from a file). valid node ip/port are required.\n");
+    printf("\t\tCheck if a transaction is included in a tick (tick data from a file). <TICK_DATA_FILE> can also be a tick archive (all ticks) or <ARCHIVE>@<TICK>. valid node ip/port are required.\n");
     printf("\t-readtickdata <FILE_NAME> <COMPUTOR_LIST>\n");
-    printf("\t\tRead tick data from a file, print the output on screen, COMPUTOR_LIST is required if you need to verify block data\n");
+    printf("\t\tRead tick data from a file, print the output on screen, COMPUTOR_LIST is required if you need to verify block data. <FILE_NAME> can also be a tick archive (all ticks) or <ARCHIVE>@<TICK>.\n");
+    printf("\t-buildtxindex <TICK_FILES> <INDEX_FILE>\n");
+    printf("\t\tIndex the transaction digests of the tick archive or directory of tick data files <TICK_FILES> on all cores and write them, sorted, with a Bloom filter per %d ticks, to <INDEX_FILE>. Files other than tick data files written by -gettickdata, with transactions that match their digests, are skipped. Use -lookuptxindex to find the ticks of tx hashes. See -threads.\n", TICK_ARCHIVE_SEGMENT_TICKS);
+    printf("\t-lookuptxindex <INDEX_FILE> <TX_HASH | TX_HASH_FILE>\n");
+    printf("\t\tPrint the tick and position in the tick data of <TX_HASH>, or of each tx hash in the file <TX_HASH_FILE> (one per line), using an index built by -buildtxindex.\n");
     printf("\t-sendcustomtransaction <TARGET_IDENTITY> <TX_TYPE> <AMOUNT> <EXTRA_BYTE_SIZE> <EXTRA_BYTE_IN_HEX>\n");
     printf("\t\tPerform a custom transaction (IPO, querying smart contract), valid seed and node ip/port are required.\n");
     printf("\t-dumpspectrumfile <SPECTRUM_BINARY_FILE> <OUTPUT_CSV_FILE>\n");
@@ -141,6 +180,8 @@ void print_help()
     printf("\n[NODE COMMANDS]\n");
     printf("\t-getcurrenttick\n");
     printf("\t\tShow current tick information of a node\n");
+    printf("\t-getnodelatency <NUMBER_OF_PROBES>\n");
+    printf("\t\tMeasure the round-trip time of the node (or of all nodes given with -nodeset) and show the smoothed RTT, its variation and the derived response timeout, fastest node first.\n");
     printf("\t-sendspecialcommand <COMMAND_IN_NUMBER> \n");
     printf("\t\tPerform a special command to node, valid seed and node ip/port are required.\t\n");
     printf("\t-togglemainaux <MODE_0> <Mode_1> \n");
@@ -664,6 +705,15 @@ void readConfigFile(const char* path)
                 g_nodePort = std::atoi(v[1].c_str());
             }
         }
+        if (v[0] == "node_set")
+        {
+            if (g_nodeSetList == nullptr)
+            {
+                // override when node set is not given as parameter
+                g_nodeSetList = (char*) malloc(v[1].size() + 1);
+                memcpy(g_nodeSetList, v[1].c_str(), v[1].size() + 1);
+            }
+        }
         if (v[0] == "schedule_tick_offset")
         {
             if (g_offsetScheduledTick == DEFAULT_SCHEDULED_TICK_OFFSET)
@@ -753,6 +803,117 @@ void parseArgument(int argc, char** argv)
             i+=2;
             continue;
         }
+        if (strcmp(argv[i], "-fastconnect") == 0)
+        {
+            g_fastConnect = true;
+            ++i;
+            continue;
+        }
+        if (strcmp(argv[i], "-nodeset") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_nodeSetList = argv[i + 1];
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-hedge") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_hedgePercentile = int(charToNumber(argv[i + 1]));
+            if (g_hedgePercentile <= 0 || g_hedgePercentile > 100)
+            {
+                LOG("Hedge percentile must be in range 1-100\n");
+                exit(1);
+            }
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-cachekeys") == 0)
+        {
+            g_cacheComputorKeys = true;
+            ++i;
+            continue;
+        }
+        if (strcmp(argv[i], "-threads") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_numThreads = (unsigned int)charToNumber(argv[i + 1]);
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-inflight") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_ticksInFlight = (unsigned int)charToNumber(argv[i + 1]);
+            if (g_ticksInFlight == 0)
+            {
+                LOG("Number of ticks in flight must be at least 1\n");
+                exit(1);
+            }
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-combtable") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(2)
+            g_combWidth = (unsigned int)charToNumber(argv[i + 1]);
+            g_combTables = (unsigned int)charToNumber(argv[i + 2]);
+            if (g_combWidth < 2 || g_combWidth > 10 || g_combTables < 1 || g_combTables > 10)
+            {
+                LOG("Comb width must be in range 2-10 and number of tables in range 1-10\n");
+                exit(1);
+            }
+            i += 3;
+            continue;
+        }
+        if (strcmp(argv[i], "-cpu") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            int level;
+            if (strcmp(argv[i + 1], "scalar") == 0)
+                level = CPU_LEVEL_SCALAR;
+            else if (strcmp(argv[i + 1], "avx2") == 0)
+                level = CPU_LEVEL_AVX2;
+            else if (strcmp(argv[i + 1], "avx512") == 0)
+                level = CPU_LEVEL_AVX512;
+            else
+            {
+                LOG("Unknown CPU variant %s, expected scalar, avx2 or avx512\n", argv[i + 1]);
+                exit(1);
+            }
+            if (setCpuLevel(level) != level)
+            {
+                LOG("The CPU doesn't support %s, using %s\n", argv[i + 1], getCpuLevelName(getCpuLevel()));
+            }
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-record") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_recordFile = argv[i + 1];
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-replay") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_replayFile = argv[i + 1];
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "-replayspeed") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_replaySpeed = atof(argv[i + 1]);
+            if (g_replaySpeed < 0)
+            {
+                LOG("Replay speed must not be negative\n");
+                exit(1);
+            }
+            i += 2;
+            continue;
+        }
 
         /***************************
          ***** WALLET COMMANDS *****
@@ -765,6 +926,16 @@ void parseArgument(int argc, char** argv)
             CHECK_OVER_PARAMETERS
             break;
         }
+        if (strcmp(argv[i], "-derivekeys") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(2)
+            g_cmd = DERIVE_KEYS;
+            g_requestedFileName = argv[i + 1];
+            g_requestedFileName2 = argv[i + 2];
+            i += 3;
+            CHECK_OVER_PARAMETERS
+            break;
+        }
         if (strcmp(argv[i], "-getbalance") == 0)
         {
             CHECK_NUMBER_OF_PARAMETERS(1)
@@ -851,6 +1022,26 @@ void parseArgument(int argc, char** argv)
             CHECK_OVER_PARAMETERS
             break;
         }
+        if (strcmp(argv[i], "-gettickrangetoarchive") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(3)
+            g_cmd = GET_TICK_RANGE_TO_ARCHIVE;
+            g_requestedTickNumber = uint32_t(charToNumber(argv[i + 1]));
+            g_requestedLastTickNumber = uint32_t(charToNumber(argv[i + 2]));
+            g_requestedFileName = argv[i + 3];
+            i += 4;
+            CHECK_OVER_PARAMETERS
+            break;
+        }
+        if (strcmp(argv[i], "-followticks") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_cmd = FOLLOW_TICKS;
+            g_requestedTickNumber = uint32_t(charToNumber(argv[i + 1]));
+            i += 2;
+            CHECK_OVER_PARAMETERS
+            break;
+        }
         if (strcmp(argv[i], "-getquorumtick") == 0)
         {
             CHECK_NUMBER_OF_PARAMETERS(2)
@@ -935,6 +1126,26 @@ void parseArgument(int argc, char** argv)
             CHECK_OVER_PARAMETERS
             break;
         }
+        if (strcmp(argv[i], "-buildtxindex") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(2)
+            g_cmd = BUILD_TX_INDEX;
+            g_requestedFileName = argv[i+1];
+            g_requestedFileName2 = argv[i+2];
+            i+=3;
+            CHECK_OVER_PARAMETERS
+            break;
+        }
+        if (strcmp(argv[i], "-lookuptxindex") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(2)
+            g_cmd = LOOKUP_TX_INDEX;
+            g_requestedFileName = argv[i+1];
+            g_requestedFileName2 = argv[i+2];
+            i+=3;
+            CHECK_OVER_PARAMETERS
+            break;
+        }
         if (strcmp(argv[i], "-readtickdata") == 0)
         {
             CHECK_NUMBER_OF_PARAMETERS(2)
@@ -1077,6 +1288,15 @@ void parseArgument(int argc, char** argv)
             CHECK_OVER_PARAMETERS
             break;
         }
+        if (strcmp(argv[i], "-getnodelatency") == 0)
+        {
+            CHECK_NUMBER_OF_PARAMETERS(1)
+            g_cmd = GET_NODE_LATENCY;
+            g_nodeLatencyProbes = int(charToNumber(argv[i+1]));
+            i+=2;
+            CHECK_OVER_PARAMETERS
+            break;
+        }
         if (strcmp(argv[i], "-sendspecialcommand") == 0)
         {
             CHECK_NUMBER_OF_PARAMETERS(1)
@@ -3103,4 +3323,28 @@ void parseArgument(int argc, char** argv)
     {
         readConfigFile(g_configFile);
     }
+    if (g_nodeSetList != nullptr)
+    {
+        if (!parseNodeSet(g_nodeSetList, g_nodePort, g_nodeSet))
+        {
+            LOG("Invalid node set %s\n", g_nodeSetList);
+            exit(1);
+        }
+        // commands that don't support node sets use the first node
+        g_nodeIp = (char*)g_nodeSet[0].ip.c_str();
+        g_nodePort = g_nodeSet[0].port;
+    }
+    if (g_recordFile != nullptr && g_replayFile != nullptr)
+    {
+        LOG("-record and -replay cannot be used together\n");
+        exit(1);
+    }
+    if (g_recordFile != nullptr && !startWireRecording(g_recordFile))
+    {
+        exit(1);
+    }
+    if (g_replayFile != nullptr && !startWireReplay(g_replayFile, g_replaySpeed))
+    {
+        exit(1);
+    }
 }
@@ -0,0 +1,47 @@
+# Combine the object files built with -mavx2 into one object file (OUTPUT) whose copies of inline functions,
+# template instantiations and vtables are local symbols outside of COMDAT groups. The linker then keeps these copies
+# for the code in OBJECTS only, and never picks one of them for code built for baseline x86-64 that uses the same
+# inline function. The functions defined in OBJECTS stay global.
+#
+# cmake -DLINKER=<ld> -DNM=<nm> -DOBJCOPY=<objcopy> -DOUTPUT=<out.o> -P localize_inline_copies.cmake -- <a.o> <b.o> ...
+
+set(objects "")
+set(inObjects FALSE)
+math(EXPR lastArg "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${lastArg})
+	if(inObjects)
+		list(APPEND objects "${CMAKE_ARGV${i}}")
+	elseif(CMAKE_ARGV${i} STREQUAL "--")
+		set(inObjects TRUE)
+	endif()
+endforeach()
+
+execute_process(COMMAND ${LINKER} -r -o ${OUTPUT}.combined ${objects} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${LINKER} -r failed")
+endif()
+
+execute_process(COMMAND ${NM} --defined-only ${OUTPUT}.combined OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${NM} failed")
+endif()
+
+# weak functions (W) and weak vtables (V _ZTV / _ZTT). Other weak data (typeinfo, inline variables, static locals of
+# inline functions) must stay shared with the rest of the program.
+string(REPLACE "\n" ";" symbols "${symbols}")
+set(localSymbols "")
+foreach(line IN LISTS symbols)
+	if(line MATCHES "^[0-9a-fA-F]* W (.+)$")
+		string(APPEND localSymbols "${CMAKE_MATCH_1}\n")
+	elseif(line MATCHES "^[0-9a-fA-F]* V (_ZT[VT].+)$")
+		string(APPEND localSymbols "${CMAKE_MATCH_1}\n")
+	endif()
+endforeach()
+file(WRITE ${OUTPUT}.localize "${localSymbols}")
+
+execute_process(COMMAND ${OBJCOPY} --localize-symbols=${OUTPUT}.localize --remove-section=.group
+		${OUTPUT}.combined ${OUTPUT} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${OBJCOPY} failed")
+endif()
+file(REMOVE ${OUTPUT}.combined ${OUTPUT}.localize)
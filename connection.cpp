@@ -8,14 +8,20 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <poll.h>
 #endif
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <stdexcept>
+#include <thread>
 
 #include "connection.h"
 #include "logger.h"
+#include "node_rtt.h"
 #include "structs.h"
+#include "wire_capture.h"
 
 // includes for template instantiations
 #include "quottery.h"
@@ -30,6 +36,10 @@
 #include "qbond.h"
 #include "escrow.h"
 
+bool g_fastConnect = false;
+
+// dejavus of retired requests remembered per connection, see QubicConnection::retireRequests()
+#define MAX_RETIRED_DEJAVUS 64
 
 #ifdef _MSC_VER
 
@@ -54,6 +64,8 @@ static int connect(const char* nodeIp, int nodePort)
         return -1;
     if (!setTimeout(serverSocket, SO_SNDTIMEO, DEFAULT_TIMEOUT_MSEC))
         return -1;
+    BOOL keepAlive = TRUE;
+    setsockopt(serverSocket, SOL_SOCKET, SO_KEEPALIVE, (const char*)&keepAlive, sizeof keepAlive);
     sockaddr_in addr;
     memset((char*)&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
@@ -73,6 +85,17 @@ static int connect(const char* nodeIp, int nodePort)
     return serverSocket;
 }
 
+// Wait until data can be read from the socket. Return 1 if readable, 0 on timeout, -1 on error.
+static int waitReadable(int serverSocket, int timeoutMillisec)
+{
+    WSAPOLLFD pfd;
+    pfd.fd = serverSocket;
+    pfd.events = POLLRDNORM;
+    pfd.revents = 0;
+    int res = WSAPoll(&pfd, 1, timeoutMillisec);
+    return (res > 0) ? 1 : res;
+}
+
 #else
 
 static bool setTimeout(int serverSocket, int optName, unsigned long milliseconds)
@@ -92,6 +115,8 @@ static int connect(const char* nodeIp, int nodePort)
         return -1;
     if (!setTimeout(serverSocket, SO_SNDTIMEO, DEFAULT_TIMEOUT_MSEC))
         return -1;
+    int keepAlive = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_KEEPALIVE, (const char*)&keepAlive, sizeof keepAlive);
     sockaddr_in addr;
     memset((char*)&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
@@ -106,11 +131,23 @@ static int connect(const char* nodeIp, int nodePort)
     if (connect(serverSocket, (const sockaddr *)&addr, sizeof(addr)) < 0) 
     {
         LOG("Failed to connect %s\n", nodeIp);
+        close(serverSocket);
         return -1;
     }
     return serverSocket;
 }
 
+// Wait until data can be read from the socket. Return 1 if readable, 0 on timeout, -1 on error.
+static int waitReadable(int serverSocket, int timeoutMillisec)
+{
+    struct pollfd pfd;
+    pfd.fd = serverSocket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int res = poll(&pfd, 1, timeoutMillisec);
+    return (res > 0) ? 1 : res;
+}
+
 #endif
 
 QubicConnection::QubicConnection(const char* nodeIp, int nodePort, unsigned long timeoutMillisec)
@@ -118,26 +155,119 @@ QubicConnection::QubicConnection(const char* nodeIp, int nodePort, unsigned long
 	memset(mNodeIp, 0, 32);
 	memcpy(mNodeIp, nodeIp, strlen(nodeIp));
 	mNodePort = nodePort;
-	mSocket = connect(nodeIp, nodePort);
-    if (mSocket < 0)
+    mBroken = false;
+    mCheckRequestComputors = false;
+    mTimeoutMillisec = DEFAULT_TIMEOUT_MSEC;
+    mAdaptiveTimeout = (timeoutMillisec == ADAPTIVE_TIMEOUT_MSEC);
+    mRecvTimeoutMillisec = DEFAULT_TIMEOUT_MSEC;
+    mAwaitingResponse = false;
+    mResponsePending = false;
+    mRecording = false;
+    mCaptureId = 0;
+    mSocket = -1;
+    if (!open())
         throw std::logic_error("Unable to establish connection.");
+    handshake(timeoutMillisec);
+}
 
+bool QubicConnection::open()
+{
+    if (isWireReplaying())
+    {
+        mSocket = -1;
+        mReplay = openReplayConnection(mNodeIp, mNodePort);
+        if (!mReplay)
+        {
+            LOG("No recorded connection to %s:%d left in the capture file\n", mNodeIp, mNodePort);
+            return false;
+        }
+        return true;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    mSocket = connect(mNodeIp, mNodePort);
+    if (mSocket < 0)
+        return false;
+    // establishing the TCP connection takes one round trip
+    recordNodeRtt(mNodeIp, mNodePort, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count(), false);
+    mRecording = isWireRecording();
+    if (mRecording)
+        mCaptureId = recordWireConnection(mNodeIp, mNodePort);
+    return true;
+}
+
+void QubicConnection::handshake(unsigned long timeoutMillisec)
+{
+    mCheckRequestComputors = false;
     // receive handshake - exchange peer packets
     mHandshakeData.resize(sizeof(ExchangePublicPeers));
     uint8_t* data = mHandshakeData.data();
     *((ExchangePublicPeers*)data) = receivePacketWithHeaderAs<ExchangePublicPeers>();
 
+    if (g_fastConnect)
+    {
+        mCheckRequestComputors = true;
+        setTimeout(timeoutMillisec);
+        return;
+    }
+
     // If node has no ComputorList or a self-generated ComputorList it will requestComputor upon tcp initialization
     // Ignore this message if it is here
     // This waits for timeout if RequestComputors is not sent. Temporarily reduce timeout to reduce waiting time.
-    setTimeout(mSocket, SO_RCVTIMEO, DEFAULT_TIMEOUT_MSEC / 5);
+    ::setTimeout(mSocket, SO_RCVTIMEO, DEFAULT_TIMEOUT_MSEC / 5);
     try
     {
         *((RequestComputors*)data) = receivePacketWithHeaderAs<RequestComputors>();
     }
     catch(std::logic_error) {}
-    setTimeout(mSocket, SO_RCVTIMEO, timeoutMillisec);
-    setTimeout(mSocket, SO_SNDTIMEO, timeoutMillisec);
+    // not receiving the optional RequestComputors is no reason to drop the connection
+    mBroken = false;
+    setTimeout(timeoutMillisec);
+}
+
+void QubicConnection::setTimeout(unsigned long timeoutMillisec)
+{
+    mAdaptiveTimeout = (timeoutMillisec == ADAPTIVE_TIMEOUT_MSEC);
+    mTimeoutMillisec = mAdaptiveTimeout ? DEFAULT_TIMEOUT_MSEC : timeoutMillisec;
+    mRecvTimeoutMillisec = mTimeoutMillisec;
+    ::setTimeout(mSocket, SO_RCVTIMEO, mTimeoutMillisec);
+    ::setTimeout(mSocket, SO_SNDTIMEO, mTimeoutMillisec);
+}
+
+bool QubicConnection::isReusable()
+{
+    if (mBroken || mResponsePending)
+        return false;
+    if (mReplay)
+    {
+        // data left unread during the recording hasn't been captured
+        return true;
+    }
+    // the RequestComputors that may follow a fast connect is part of the handshake
+    if (mCheckRequestComputors && waitReadable(mSocket, 0) > 0)
+        consumeRequestComputors();
+    // readable without a read means that data is left or that the node closed the connection
+    return waitReadable(mSocket, 0) == 0;
+}
+
+void QubicConnection::retireRequests()
+{
+    mRetiredDejavus.insert(mRetiredDejavus.end(), mSentDejavus.begin(), mSentDejavus.end());
+    mSentDejavus.clear();
+    if (mRetiredDejavus.size() > MAX_RETIRED_DEJAVUS)
+        mRetiredDejavus.erase(mRetiredDejavus.begin(), mRetiredDejavus.end() - MAX_RETIRED_DEJAVUS);
+}
+
+bool QubicConnection::isRetired(const RequestResponseHeader& header) const
+{
+    if (header.isDejavuZero())
+        return false;
+    for (unsigned int dejavu : mRetiredDejavus)
+    {
+        // a dejavu reused by a newer request belongs to that request
+        if (dejavu == header.dejavu())
+            return std::find(mSentDejavus.begin(), mSentDejavus.end(), dejavu) == mSentDejavus.end();
+    }
+    return false;
 }
 
 void QubicConnection::getHandshakeData(std::vector<uint8_t>& buffer)
@@ -147,12 +277,22 @@ void QubicConnection::getHandshakeData(std::vector<uint8_t>& buffer)
 
 QubicConnection::~QubicConnection()
 {
-	close(mSocket);
+    if (mSocket >= 0)
+        close(mSocket);
 }
 
 // Receive the requested number of bytes (sz) or less if sz bytes have not been received after timeout. Return number of received bytes.
 int QubicConnection::receiveData(uint8_t* buffer, int sz)
 {
+    if (mReplay)
+    {
+        int replaySz = mReplay->receive(buffer, sz);
+        if (replaySz < sz)
+            mBroken = true;
+        return replaySz;
+    }
+    if (mCheckRequestComputors)
+        consumeRequestComputors();
     int totalRecvSz = 0;
     while (sz)
     {
@@ -170,14 +310,50 @@ int QubicConnection::receiveData(uint8_t* buffer, int sz)
         if (recvSz <= 0)
         {
             // timeout, closed connection, or other error
+            mBroken = true;
+            if (mRecording)
+                recordWireData(mCaptureId, WIRE_CAPTURE_RECEIVED, nullptr, 0);
             break;
         }
+        if (mRecording)
+            recordWireData(mCaptureId, WIRE_CAPTURE_RECEIVED, buffer + totalRecvSz, recvSz);
+        mResponsePending = false;
+        if (mAwaitingResponse)
+        {
+            mAwaitingResponse = false;
+            recordNodeRtt(mNodeIp, mNodePort, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mSendTime).count());
+        }
         totalRecvSz += recvSz;
         sz -= recvSz;
     }
     return totalRecvSz;
 }
 
+void QubicConnection::consumeRequestComputors()
+{
+    // If the node sends RequestComputors, it does so right after ExchangePublicPeers, so it is the first packet.
+    // Wait until a complete header can be peeked and drop it if it is RequestComputors. Timeouts and errors are left
+    // to the actual read.
+    mCheckRequestComputors = false;
+    RequestResponseHeader header;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(mTimeoutMillisec);
+    while (true)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 || waitReadable(mSocket, int(remaining.count())) <= 0)
+            return;
+        int peekSz = recv(mSocket, (char*)&header, sizeof(RequestResponseHeader), MSG_PEEK);
+        if (peekSz <= 0)
+            return;
+        if (peekSz == sizeof(RequestResponseHeader))
+            break;
+        // the socket stays readable until the rest of the header arrives, so don't spin
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (header.type() == REQUEST_COMPUTORS && header.size() == sizeof(RequestResponseHeader))
+        recv(mSocket, (char*)&header, sizeof(RequestResponseHeader), 0);
+}
+
 int QubicConnection::receiveAllDataOrThrowException(uint8_t* buffer, int sz)
 {
     int recvSz = receiveData(buffer, sz);
@@ -190,9 +366,19 @@ int QubicConnection::receiveAllDataOrThrowException(uint8_t* buffer, int sz)
 
 void QubicConnection::resolveConnection()
 {
-    mSocket = connect(mNodeIp, mNodePort);
-    if (mSocket < 0)
+    if (mSocket >= 0)
+        close(mSocket);
+    mBroken = false;
+    mAwaitingResponse = false;
+    mResponsePending = false;
+    mSentDejavus.clear();
+    mRetiredDejavus.clear();
+    if (!open())
+    {
+        mBroken = true;
         throw std::logic_error("Unable to establish connection.");
+    }
+    handshake(mAdaptiveTimeout ? ADAPTIVE_TIMEOUT_MSEC : mTimeoutMillisec);
 }
 
 // Receive the next qubic packet with a RequestResponseHeader that matches T
@@ -204,60 +390,124 @@ T QubicConnection::receivePacketWithHeaderAs()
     return result;
 }
 
-// Receive the next qubic packet with a RequestResponseHeader that matches T
-template <typename T>
-void QubicConnection::receivePacketWithHeaderAs(T& result)
+void QubicConnection::skipData(int sz)
+{
+    uint8_t buffer[4096];
+    while (sz > 0)
+    {
+        int chunkSz = (sz < int(sizeof(buffer))) ? sz : int(sizeof(buffer));
+        receiveAllDataOrThrowException(buffer, chunkSz);
+        sz -= chunkSz;
+    }
+}
+
+int QubicConnection::receiveHeaderOfType(uint8_t type)
 {
-    // first receive the header
     RequestResponseHeader header;
-    int recvByte = -1, packetSize = -1, remainingSize = -1;
     while (true)
     {
-        recvByte = receiveData((uint8_t*)&header, sizeof(RequestResponseHeader));
+        int recvByte = receiveData((uint8_t*)&header, sizeof(RequestResponseHeader));
         if (recvByte != sizeof(RequestResponseHeader))
         {
             throw std::logic_error("No connection.");
         }
+        if (header.size() < sizeof(RequestResponseHeader) || header.size() > 0xFFFFFF)
+        {
+            mBroken = true;
+            throw std::logic_error("Received invalid packet.");
+        }
+        int remainingSize = header.size() - sizeof(RequestResponseHeader);
+        if (isRetired(header))
+        {
+            skipData(remainingSize);
+            continue;
+        }
         if (header.type() == END_RESPOND)
         {
             throw EndResponseReceived();
         }
-        if (header.type() != T::type())
+        if (header.type() != type)
         {
             // skip this packet and keep receiving
-            packetSize = header.size();
-            remainingSize = packetSize - sizeof(RequestResponseHeader);
-            receiveAllDataOrThrowException(mBuffer, remainingSize);
+            skipData(remainingSize);
             continue;
         }
-        break;
+        return remainingSize;
     }
-    
-    packetSize = header.size();
-    remainingSize = packetSize - sizeof(RequestResponseHeader);
+}
 
-    memset(&result, 0, sizeof(T));
-    if (remainingSize)
+bool QubicConnection::receiveResponse(const PacketHandler& onPacket)
+{
+    RequestResponseHeader header;
+    std::vector<uint8_t> payload;
+    while (true)
     {
-        memset(mBuffer, 0, sizeof(T));
-        receiveAllDataOrThrowException(mBuffer, remainingSize);
-        result = *((T*)mBuffer);
+        if (receiveData((uint8_t*)&header, sizeof(RequestResponseHeader)) != sizeof(RequestResponseHeader))
+        {
+            return false;
+        }
+        if (header.size() < sizeof(RequestResponseHeader) || header.size() > 0xFFFFFF)
+        {
+            mBroken = true;
+            return false;
+        }
+        int payloadSize = header.size() - sizeof(RequestResponseHeader);
+        if (isRetired(header))
+        {
+            payload.resize(payloadSize);
+            if (receiveData(payload.data(), payloadSize) != payloadSize)
+            {
+                return false;
+            }
+            continue;
+        }
+        if (header.type() == END_RESPOND)
+        {
+            return true;
+        }
+        payload.resize(payloadSize);
+        if (receiveData(payload.data(), payloadSize) != payloadSize)
+        {
+            return false;
+        }
+        if (onPacket(header, payload.data()))
+        {
+            return true;
+        }
     }
 }
 
+uint8_t* QubicConnection::receivePacketWithHeaderInto(uint8_t type, std::vector<uint8_t>& storage, size_t minSize)
+{
+    int remainingSize = receiveHeaderOfType(type);
+    storage.resize((size_t(remainingSize) > minSize) ? remainingSize : minSize);
+    receiveAllDataOrThrowException(storage.data(), remainingSize);
+    memset(storage.data() + remainingSize, 0, storage.size() - remainingSize);
+    return storage.data();
+}
+
+// Receive the next qubic packet with a RequestResponseHeader that matches T
+template <typename T>
+void QubicConnection::receivePacketWithHeaderAs(T& result)
+{
+    int remainingSize = receiveHeaderOfType(T::type());
+    int resultSize = (remainingSize < int(sizeof(T))) ? remainingSize : int(sizeof(T));
+    receiveAllDataOrThrowException((uint8_t*)&result, resultSize);
+    memset((uint8_t*)&result + resultSize, 0, sizeof(T) - resultSize);
+    skipData(remainingSize - resultSize);
+}
+
 // same as receivePacketWithHeaderAs but without the header
 template <typename T>
 T QubicConnection::receivePacketAs()
 {
     int packetSize = sizeof(T);
     T result;
-    memset(&result, 0, sizeof(T));
-    int recvByte = receiveData(mBuffer, packetSize);
+    int recvByte = receiveData((uint8_t*)&result, packetSize);
     if (recvByte != packetSize)
     {
         throw std::logic_error("Unexpected data size.");
     }
-    result = *((T*)mBuffer);
     return result;
 }
 
@@ -269,14 +519,17 @@ std::vector<T> QubicConnection::getLatestVectorPacketAs()
     {
         try
         {
-            results.push_back(receivePacketWithHeaderAs<T>());
+            results.emplace_back();
+            receivePacketWithHeaderAs<T>(results.back());
         }
         catch (EndResponseReceived)
         {
+            results.pop_back();
             break;
         }
         catch (std::logic_error& e)
         {
+            results.pop_back();
             LOG("%s\n", e.what());
             break;
         }
@@ -296,18 +549,46 @@ int QubicConnection::sendData(uint8_t* buffer, int sz)
         if (!std::freopen("/dev/null", "w", stdout)) {}
         if (!std::freopen("/dev/null", "w", stderr)) {}
         return 0;
+    } else if (mReplay) {
+        mReplay->sent();
+        return sz;
     } else {
+        uint8_t* data = buffer;
         int size = sz;
         int numberOfBytes;
         while (size)
         {
             if ((numberOfBytes = send(mSocket, (char*)buffer, size, 0)) <= 0)
             {
+                mBroken = true;
                 return 0;
             }
             buffer += numberOfBytes;
             size -= numberOfBytes;
         }
+        if (mRecording)
+            recordWireData(mCaptureId, WIRE_CAPTURE_SENT, data, sz);
+        if (mAdaptiveTimeout)
+        {
+            // wait for the response as long as the node's round-trip time suggests
+            unsigned long recvTimeout = getNodeTimeoutMsec(mNodeIp, mNodePort);
+            if (recvTimeout != mRecvTimeoutMillisec)
+            {
+                ::setTimeout(mSocket, SO_RCVTIMEO, recvTimeout);
+                mRecvTimeoutMillisec = recvTimeout;
+            }
+        }
+        mAwaitingResponse = true;
+        mSendTime = std::chrono::steady_clock::now();
+        // the node doesn't answer requests with zero dejavu
+        const RequestResponseHeader* header = (const RequestResponseHeader*)data;
+        if (sz >= int(sizeof(RequestResponseHeader)) && !header->isDejavuZero())
+        {
+            mResponsePending = true;
+            mSentDejavus.push_back(header->dejavu());
+            if (mSentDejavus.size() > MAX_RETIRED_DEJAVUS)
+                mSentDejavus.erase(mSentDejavus.begin());
+        }
         return sz - size;
     }
 }
@@ -421,5 +702,9 @@ template GetPollsByCreator_output QubicConnection::receivePacketWithHeaderAs<Get
 template GetCurrentPollId_output QubicConnection::receivePacketWithHeaderAs<GetCurrentPollId_output>();
 template GetPollInfo_output QubicConnection::receivePacketWithHeaderAs<GetPollInfo_output>();
 
+template void QubicConnection::receivePacketWithHeaderAs<TickData>(TickData&);
+template void QubicConnection::receivePacketWithHeaderAs<RespondTxStatus>(RespondTxStatus&);
+template void QubicConnection::receivePacketWithHeaderAs<BroadcastComputors>(BroadcastComputors&);
+
 // REVENUE
 template void QubicConnection::receivePacketWithHeaderAs<RevenueData>(RevenueData&);
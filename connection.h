@@ -1,23 +1,60 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
 #include <stdexcept>
 
 #define DEFAULT_TIMEOUT_MSEC 1000
+// Timeout argument: wait for responses as long as the round-trip time measured for the node suggests, at least
+// DEFAULT_TIMEOUT_MSEC (see node_rtt.h)
+#define ADAPTIVE_TIMEOUT_MSEC 0
 
-// Not thread safe
+struct RequestResponseHeader;
+class ReplayConnection;
+
+// Called for every packet of a response. payload points to header.size() - sizeof(RequestResponseHeader) bytes.
+// Return true if the response is complete.
+typedef std::function<bool(const RequestResponseHeader& header, const uint8_t* payload)> PacketHandler;
+
+// If true, connections are ready as soon as ExchangePublicPeers has been received. The optional RequestComputors
+// that may follow is dropped on the first read instead of waiting for it during the handshake.
+extern bool g_fastConnect;
+
+// Not thread safe. Use make_qc() / QubicConnectionPool to get a connection per thread.
 class QubicConnection
 {
 public:
-	QubicConnection(const char* nodeIp, int nodePort, unsigned long timeoutMillisec = DEFAULT_TIMEOUT_MSEC);
+	QubicConnection(const char* nodeIp, int nodePort, unsigned long timeoutMillisec = ADAPTIVE_TIMEOUT_MSEC);
 	~QubicConnection();
 
-    // Establish connection to mNodePort on node mNodeIp. 
+    // Close the current socket, establish connection to mNodePort on node mNodeIp again and redo the handshake.
     // May throw std::logic_error.
     void resolveConnection();
 
+    // Set receive and send timeout of the socket. With ADAPTIVE_TIMEOUT_MSEC, the time waiting for a response adapts
+    // to the round-trip time measured for the node (see node_rtt.h).
+    void setTimeout(unsigned long timeoutMillisec);
+
+    // True if the connection can be handed to another user without blocking: it isn't broken, every request sent that
+    // expects a response has been answered, and no data is waiting in the socket (the rest of a response the user
+    // didn't read, or the node closed the connection).
+    bool isReusable();
+
+    // Mark the requests sent so far as finished. Packets answering them that arrive later (such as an END_RESPOND
+    // following a response read as a single packet) are skipped by the receive functions instead of being taken as
+    // the response to a later request.
+    void retireRequests();
+
+    // True if a send or receive failed before (timeout, closed connection, or error). The stream may be out of sync
+    // then, so the connection must not be reused before calling resolveConnection().
+    bool isBroken() const { return mBroken; }
+
+    const char* nodeIp() const { return mNodeIp; }
+    int nodePort() const { return mNodePort; }
+
     // Receive at most sz bytes and write them to buffer. Return the actual number of received bytes.
     // Should only return less than sz bytes on timeout, closed connection, or error.
 	int receiveData(uint8_t* buffer, int sz);
@@ -36,28 +73,78 @@ public:
     template <typename T> T receivePacketWithHeaderAs();
 
     // Same as receivePacketWithHeaderAs() but with pre-allocated T. Use this for large T to prevent stack overflow.
+    // The payload is received directly into result. Bytes beyond the payload size are zeroed.
     template <typename T> void receivePacketWithHeaderAs(T& result);
 
+    // Receive the payload of the next packet of the given type into storage, which is resized to the payload size
+    // but at least minSize bytes (zeroing the bytes not received). Packets of other types are skipped without
+    // buffering them. Reuse storage across calls to avoid allocations. Return pointer to the payload in storage.
+    // May throw std::logic_error or EndResponseReceived.
+    uint8_t* receivePacketWithHeaderInto(uint8_t type, std::vector<uint8_t>& storage, size_t minSize = 0);
+
+    // View the next packet of type T in place in storage, see receivePacketWithHeaderInto().
+    template <typename T> T* receivePacketWithHeaderInto(std::vector<uint8_t>& storage)
+    {
+        return (T*)receivePacketWithHeaderInto(T::type(), storage, sizeof(T));
+    }
+
     // Receive data of type T without a header. 
     // May throw std::logic_error.
     template <typename T> T receivePacketAs();
 
     // Receive vector data of Ts where each T is preceeded by a header.
     template <typename T> std::vector<T> getLatestVectorPacketAs();
+
+    // Receive the packets of a response and pass them to onPacket until it returns true or END_RESPOND arrives
+    // (END_RESPOND is not passed to onPacket). Packets are parsed as they arrive, so this doesn't wait for the
+    // socket timeout. Return false on timeout, closed connection, or an invalid packet.
+    bool receiveResponse(const PacketHandler& onPacket);
 private:
+    // Connect the socket, or take the next recorded connection to the node when replaying (see wire_capture.h).
+    // Return false on failure.
+    bool open();
+
+    // Receive ExchangePublicPeers (and the optional RequestComputors) that the node sends after connecting.
+    void handshake(unsigned long timeoutMillisec);
+
+    // Drop the optional RequestComputors if it is the next packet (fast connect, see g_fastConnect).
+    void consumeRequestComputors();
+
+    // Receive headers until one of the given type arrives, skipping the other packets. Return its payload size.
+    // May throw std::logic_error or EndResponseReceived.
+    int receiveHeaderOfType(uint8_t type);
+
+    // Receive sz bytes and drop them. Throws std::logic_error if sz bytes cannot be read.
+    void skipData(int sz);
+
+    // True if the packet answers a request retired before, see retireRequests().
+    bool isRetired(const RequestResponseHeader& header) const;
+
 	char mNodeIp[32];
 	int mNodePort;
 	int mSocket;
-    uint8_t mBuffer[0xFFFFFF];
+    bool mBroken;
+    bool mCheckRequestComputors;
+    unsigned long mTimeoutMillisec; // DEFAULT_TIMEOUT_MSEC if adaptive
+    bool mAdaptiveTimeout;
+    unsigned long mRecvTimeoutMillisec; // currently set on the socket
+    bool mAwaitingResponse; // data has been sent, RTT is measured on the next receive
+    bool mResponsePending; // a request with non-zero dejavu has been sent and no data has been received since
+    std::vector<unsigned int> mSentDejavus; // of the requests sent since the last retireRequests()
+    std::vector<unsigned int> mRetiredDejavus; // the most recent ones, see retireRequests()
+    std::chrono::steady_clock::time_point mSendTime;
     std::vector<uint8_t> mHandshakeData; // storing handshake data after open a connection
+    bool mRecording; // traffic is written to the capture file (-record)
+    unsigned int mCaptureId; // connection id in the capture file
+    std::unique_ptr<ReplayConnection> mReplay; // replaces the socket with -replay
 };
 
 typedef std::shared_ptr<QubicConnection> QCPtr;
 
-static QCPtr make_qc(const char* nodeIp, int nodePort, unsigned long timeoutMsec = DEFAULT_TIMEOUT_MSEC)
-{
-    return std::make_shared<QubicConnection>(nodeIp, nodePort, timeoutMsec);
-}
+// Get a handshaken connection to nodeIp:nodePort from the process-wide QubicConnectionPool (see connection_pool.h).
+// The connection goes back to the pool when the last QCPtr referencing it is destroyed.
+// May throw std::logic_error.
+QCPtr make_qc(const char* nodeIp, int nodePort, unsigned long timeoutMsec = ADAPTIVE_TIMEOUT_MSEC);
 
 class EndResponseReceived : public std::runtime_error
 {
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <stdexcept>
+
+#include "connection_pool.h"
+
+static std::string nodeKey(const char* nodeIp, int nodePort)
+{
+    return std::string(nodeIp) + ":" + std::to_string(nodePort);
+}
+
+QCPtr make_qc(const char* nodeIp, int nodePort, unsigned long timeoutMsec)
+{
+    return QubicConnectionPool::instance().acquire(nodeIp, nodePort, timeoutMsec);
+}
+
+QubicConnectionPool& QubicConnectionPool::instance()
+{
+    // Never destroyed, so connections released during static destruction and the detached background thread
+    // never see a dead pool.
+    static QubicConnectionPool* pool = new QubicConnectionPool();
+    return *pool;
+}
+
+QubicConnectionPool::QubicConnectionPool()
+{
+    mMaxIdlePerNode = DEFAULT_POOL_MAX_IDLE_PER_NODE;
+    mBackgroundThreadStarted = false;
+}
+
+QCPtr QubicConnectionPool::acquire(const char* nodeIp, int nodePort, unsigned long timeoutMillisec)
+{
+    const std::string key = nodeKey(nodeIp, nodePort);
+    std::unique_ptr<QubicConnection> qc;
+    while (true)
+    {
+        std::vector<IdleConnection> expired;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            takeExpired(expired);
+            auto it = mIdle.find(key);
+            if (it == mIdle.end() || it->second.empty())
+            {
+                break;
+            }
+            qc = std::move(it->second.back().qc);
+            it->second.pop_back();
+        }
+        // data arriving while idle belongs to an old request; such a connection and a closed one are dropped and
+        // replaced below
+        if (qc->isReusable())
+        {
+            break;
+        }
+        qc.reset();
+    }
+
+    if (qc)
+    {
+        qc->setTimeout(timeoutMillisec);
+    }
+    else
+    {
+        qc = std::make_unique<QubicConnection>(nodeIp, nodePort, timeoutMillisec);
+    }
+    return QCPtr(qc.release(), [this](QubicConnection* p) { release(p); });
+}
+
+void QubicConnectionPool::release(QubicConnection* p)
+{
+    // closed when leaving the function, after mMutex is unlocked, unless it is kept
+    std::unique_ptr<QubicConnection> qc(p);
+    std::vector<IdleConnection> expired;
+    // the stream is out of sync if the caller stopped reading in the middle of a response, acquire() opens a new one
+    if (!qc->isReusable())
+    {
+        return;
+    }
+    qc->retireRequests();
+    std::lock_guard<std::mutex> lock(mMutex);
+    takeExpired(expired);
+    addIdle(qc);
+}
+
+void QubicConnectionPool::warmUp(const char* nodeIp, int nodePort, size_t count)
+{
+    size_t idleCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mIdle.find(nodeKey(nodeIp, nodePort));
+        if (it != mIdle.end())
+        {
+            idleCount = it->second.size();
+        }
+    }
+    for (size_t i = idleCount; i < count && i < mMaxIdlePerNode; i++)
+    {
+        pushTask({ nodeIp, nodePort });
+    }
+}
+
+void QubicConnectionPool::setMaxIdlePerNode(size_t maxIdle)
+{
+    std::vector<IdleConnection> surplus;
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMaxIdlePerNode = maxIdle;
+    for (auto& entry : mIdle)
+    {
+        if (entry.second.size() > mMaxIdlePerNode)
+        {
+            auto end = entry.second.end() - mMaxIdlePerNode;
+            std::move(entry.second.begin(), end, std::back_inserter(surplus));
+            entry.second.erase(entry.second.begin(), end);
+        }
+    }
+}
+
+void QubicConnectionPool::clear()
+{
+    std::map<std::string, std::vector<IdleConnection>> idle;
+    std::lock_guard<std::mutex> lock(mMutex);
+    idle.swap(mIdle);
+}
+
+bool QubicConnectionPool::addIdle(std::unique_ptr<QubicConnection>& qc)
+{
+    auto& idle = mIdle[nodeKey(qc->nodeIp(), qc->nodePort())];
+    if (idle.size() >= mMaxIdlePerNode)
+    {
+        return false;
+    }
+    idle.push_back({ std::move(qc), std::chrono::steady_clock::now() });
+    return true;
+}
+
+void QubicConnectionPool::takeExpired(std::vector<IdleConnection>& expired)
+{
+    const auto oldest = std::chrono::steady_clock::now() - std::chrono::milliseconds(DEFAULT_POOL_MAX_IDLE_MSEC);
+    for (auto& entry : mIdle)
+    {
+        auto& idle = entry.second;
+        auto firstKept = idle.begin();
+        while (firstKept != idle.end() && firstKept->since < oldest)
+        {
+            ++firstKept;
+        }
+        std::move(idle.begin(), firstKept, std::back_inserter(expired));
+        idle.erase(idle.begin(), firstKept);
+    }
+}
+
+void QubicConnectionPool::pushTask(BackgroundTask&& task)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTasks.push_back(std::move(task));
+    if (!mBackgroundThreadStarted)
+    {
+        mBackgroundThreadStarted = true;
+        std::thread(&QubicConnectionPool::backgroundLoop, this).detach();
+    }
+    mTaskCondition.notify_one();
+}
+
+void QubicConnectionPool::backgroundLoop()
+{
+    while (true)
+    {
+        BackgroundTask task;
+        std::unique_ptr<QubicConnection> qc;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskCondition.wait(lock, [this] { return !mTasks.empty(); });
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+
+        // A node that refuses the connection is not retried here; the next acquire() reports the error to the caller.
+        try
+        {
+            qc = std::make_unique<QubicConnection>(task.nodeIp.c_str(), task.nodePort);
+        }
+        catch (std::logic_error&)
+        {
+            continue;
+        }
+
+        // a surplus connection is closed after mMutex is unlocked
+        std::lock_guard<std::mutex> lock(mMutex);
+        addIdle(qc);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "connection.h"
+
+#define DEFAULT_POOL_MAX_IDLE_PER_NODE 16
+// idle connections older than this are closed instead of being handed out, nodes drop silent peers anyway
+#define DEFAULT_POOL_MAX_IDLE_MSEC 30000
+
+// Process-wide pool of handshaken keep-alive connections, keyed by node ip:port. Thread safe.
+// acquire() hands out a connection for exclusive use of the caller. It is returned to the pool when the last QCPtr
+// referencing it is destroyed. A connection is only kept if the caller read the response to each of its requests and
+// nothing is left in the socket; otherwise, or if it failed while in use, its socket is closed and the next acquire()
+// opens a new one. Sockets are never closed while the pool is locked.
+class QubicConnectionPool
+{
+public:
+    static QubicConnectionPool& instance();
+
+    // Get an idle connection to nodeIp:nodePort or open a new one.
+    // May throw std::logic_error.
+    QCPtr acquire(const char* nodeIp, int nodePort, unsigned long timeoutMillisec = ADAPTIVE_TIMEOUT_MSEC);
+
+    // Open connections to nodeIp:nodePort in the background until count connections are idle, so that following
+    // acquire() calls don't need to wait for connect and handshake.
+    void warmUp(const char* nodeIp, int nodePort, size_t count);
+
+    // Set the maximum number of idle connections kept per node. Surplus connections are closed on release.
+    void setMaxIdlePerNode(size_t maxIdle);
+
+    // Close all idle connections.
+    void clear();
+
+private:
+    QubicConnectionPool();
+
+    struct IdleConnection
+    {
+        std::unique_ptr<QubicConnection> qc;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct BackgroundTask
+    {
+        std::string nodeIp;
+        int nodePort;
+    };
+
+    void release(QubicConnection* qc);
+    void pushTask(BackgroundTask&& task);
+    void backgroundLoop();
+    // Keep qc as idle connection if there is room. Must be called with mMutex locked.
+    bool addIdle(std::unique_ptr<QubicConnection>& qc);
+    // Move the connections idle for longer than DEFAULT_POOL_MAX_IDLE_MSEC to expired, to be closed once mMutex is
+    // unlocked. Must be called with mMutex locked.
+    void takeExpired(std::vector<IdleConnection>& expired);
+
+    std::mutex mMutex;
+    std::condition_variable mTaskCondition;
+    std::map<std::string, std::vector<IdleConnection>> mIdle; // most recently released last
+    std::deque<BackgroundTask> mTasks;
+    size_t mMaxIdlePerNode;
+    bool mBackgroundThreadStarted;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+// Kernel variants, selected at runtime from CPUID (see getCpuLevel()). The binary is built for baseline x86-64; the
+// AVX2 and AVX-512 kernels are compiled with function-level target attributes and only called if the CPU has them.
+#define CPU_LEVEL_SCALAR 0
+#define CPU_LEVEL_AVX2 1
+#define CPU_LEVEL_AVX512 2
+
+#if !defined(__aarch64__)
+#define CPU_X86_KERNELS
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CPU_TARGET_AVX2
+#define CPU_TARGET_AVX512
+#else
+#define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+// Return the best kernel variant supported by the CPU and the OS.
+inline int detectCpuLevel()
+{
+#if !defined(CPU_X86_KERNELS)
+    return CPU_LEVEL_SCALAR;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return CPU_LEVEL_SCALAR;
+    }
+    __cpuid(info, 1);
+    // the OS must save the YMM (and ZMM) registers
+    if (!((info[2] >> 27) & 1) || !((info[2] >> 28) & 1))
+    {
+        return CPU_LEVEL_SCALAR;
+    }
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if (((info[1] >> 16) & 1) && (xcr0 & 0xE6) == 0xE6)
+    {
+        return CPU_LEVEL_AVX512;
+    }
+    if (((info[1] >> 5) & 1) && (xcr0 & 0x6) == 0x6)
+    {
+        return CPU_LEVEL_AVX2;
+    }
+    return CPU_LEVEL_SCALAR;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return CPU_LEVEL_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return CPU_LEVEL_AVX2;
+    }
+    return CPU_LEVEL_SCALAR;
+#endif
+}
+
+// Kernel variant in use, shared by all translation units. Detected on first use unless set with setCpuLevel().
+inline int &cpuLevel()
+{
+    static int level = detectCpuLevel();
+    return level;
+}
+
+inline int getCpuLevel()
+{
+    return cpuLevel();
+}
+
+// Force a kernel variant, e.g. for benchmarking. A variant the CPU doesn't support is lowered to the best supported
+// one. Return the variant in use. Call this at startup, before hashing on other threads.
+inline int setCpuLevel(int level)
+{
+    const int supported = detectCpuLevel();
+    cpuLevel() = (level < supported) ? level : supported;
+    return cpuLevel();
+}
+
+inline const char *getCpuLevelName(int level)
+{
+    switch (level)
+    {
+    case CPU_LEVEL_AVX2:
+        return "avx2";
+    case CPU_LEVEL_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,507 @@
+// qubic-crypto-bench: measures the throughput of the cryptographic primitives of qubic-cli (K12 hashing, signing,
+// verification, key derivation, identity conversion, Merkle proofs) and prints one CSV or JSON line per case, so
+// the results of client versions and machines can be compared by scripts. Diagnostics go to stderr. Run with -h for
+// usage.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpu_features.h"
+#include "k12_and_key_utils.h"
+#include "key_utils.h"
+
+struct BenchConfig
+{
+    std::vector<std::string> ops = { "k12", "sign", "verify", "pubkey", "identity", "merkle" };
+    std::vector<int> cpuLevels;               // empty = the best level the CPU supports
+    std::vector<unsigned int> threads;        // empty = 1 and one per hardware thread
+    std::vector<unsigned int> batches = { 1, 64, 1024 };
+    std::vector<unsigned int> sizes = { 32, 96, 1024, 8192, 65536, 1048576 };
+    std::vector<unsigned int> depths = { 8, 16, 24, 32 };
+    double minSeconds = 0.3;
+    bool json = false;
+};
+
+// One measured case, printed as one line
+struct BenchResult
+{
+    const char* op;
+    unsigned int bytes; // message size, 0 if not applicable
+    unsigned int depth; // Merkle tree depth, 0 if not applicable
+    unsigned int batch;
+    unsigned int threads;
+    uint64_t items;
+    double seconds;
+};
+
+static BenchConfig config;
+
+static void printUsage()
+{
+    printf("./qubic-crypto-bench [options]\n");
+    printf("\t-ops <LIST>\n\t\tComma-separated operations to measure (default: k12,sign,verify,pubkey,identity,merkle)\n");
+    printf("\t-cpu <LIST>\n\t\tComma-separated kernel variants scalar, avx2, avx512 (default: the best variant the CPU supports)\n");
+    printf("\t-threads <LIST>\n\t\tComma-separated thread counts (default: 1 and one per hardware thread)\n");
+    printf("\t-batch <LIST>\n\t\tComma-separated batch sizes, 1 measures the single-item functions (default: 1,64,1024)\n");
+    printf("\t-sizes <LIST>\n\t\tComma-separated message sizes in bytes for k12 (default: 32,96,1024,8192,65536,1048576)\n");
+    printf("\t-depths <LIST>\n\t\tComma-separated tree depths for merkle (default: 8,16,24,32)\n");
+    printf("\t-time <MILLISECONDS>\n\t\tMinimum duration of each case (default: 300)\n");
+    printf("\t-json\n\t\tPrint one JSON object per line instead of CSV\n");
+    printf("Columns: op, cpu, bytes, depth, batch, threads, items, seconds, ns_per_op, ops_per_sec, mb_per_sec. ns_per_op is\n");
+    printf("the wall time per item, so it drops with more threads. mb_per_sec is only set for hashing.\n");
+}
+
+static bool parseList(const char* value, std::vector<std::string>& list)
+{
+    list.clear();
+    std::stringstream ss(value);
+    std::string entry;
+    while (std::getline(ss, entry, ','))
+    {
+        if (!entry.empty())
+            list.push_back(entry);
+    }
+    return !list.empty();
+}
+
+static bool parseNumberList(const char* value, std::vector<unsigned int>& list)
+{
+    std::vector<std::string> entries;
+    if (!parseList(value, entries))
+        return false;
+    list.clear();
+    for (const auto& entry : entries)
+    {
+        char* end = nullptr;
+        unsigned long number = strtoul(entry.c_str(), &end, 10);
+        if (*end != 0 || number == 0)
+            return false;
+        list.push_back((unsigned int)number);
+    }
+    return true;
+}
+
+static bool parseArguments(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-json")
+        {
+            config.json = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        const char* value = argv[++i];
+        if (arg == "-ops")
+        {
+            if (!parseList(value, config.ops))
+                return false;
+        }
+        else if (arg == "-cpu")
+        {
+            std::vector<std::string> names;
+            if (!parseList(value, names))
+                return false;
+            for (const auto& name : names)
+            {
+                int level;
+                if (name == "scalar")
+                    level = CPU_LEVEL_SCALAR;
+                else if (name == "avx2")
+                    level = CPU_LEVEL_AVX2;
+                else if (name == "avx512")
+                    level = CPU_LEVEL_AVX512;
+                else
+                    return false;
+                config.cpuLevels.push_back(level);
+            }
+        }
+        else if (arg == "-threads")
+        {
+            if (!parseNumberList(value, config.threads))
+                return false;
+        }
+        else if (arg == "-batch")
+        {
+            if (!parseNumberList(value, config.batches))
+                return false;
+        }
+        else if (arg == "-sizes")
+        {
+            if (!parseNumberList(value, config.sizes))
+                return false;
+        }
+        else if (arg == "-depths")
+        {
+            if (!parseNumberList(value, config.depths))
+                return false;
+        }
+        else if (arg == "-time")
+            config.minSeconds = strtoul(value, nullptr, 10) / 1000.0;
+        else
+            return false;
+    }
+    return true;
+}
+
+static bool selected(const char* op)
+{
+    return std::find(config.ops.begin(), config.ops.end(), op) != config.ops.end();
+}
+
+static void printResult(const BenchResult& result)
+{
+    const double nsPerOp = result.seconds * 1e9 / double(result.items);
+    const double opsPerSec = double(result.items) / result.seconds;
+    const double mbPerSec = (strncmp(result.op, "k12", 3) == 0) ? opsPerSec * result.bytes / 1e6 : 0.0;
+    const char* cpu = getCpuLevelName(getCpuLevel());
+    if (config.json)
+    {
+        printf("{\"op\":\"%s\",\"cpu\":\"%s\",\"bytes\":%u,\"depth\":%u,\"batch\":%u,\"threads\":%u,\"items\":%llu,"
+               "\"seconds\":%.6f,\"ns_per_op\":%.1f,\"ops_per_sec\":%.1f,\"mb_per_sec\":%.1f}\n",
+               result.op, cpu, result.bytes, result.depth, result.batch, result.threads,
+               (unsigned long long)result.items, result.seconds, nsPerOp, opsPerSec, mbPerSec);
+    }
+    else
+    {
+        printf("%s,%s,%u,%u,%u,%u,%llu,%.6f,%.1f,%.1f,%.1f\n", result.op, cpu, result.bytes, result.depth, result.batch,
+               result.threads, (unsigned long long)result.items, result.seconds, nsPerOp, opsPerSec, mbPerSec);
+    }
+    fflush(stdout);
+}
+
+// Call work(thread) on numThreads threads until config.minSeconds have passed. work returns the number of items it
+// processed. The batch functions with their own threads are measured with numThreads = 1.
+template <typename Work>
+static void measure(BenchResult result, unsigned int numThreads, const Work& work)
+{
+    // warm up caches and tables
+    work(0);
+
+    std::atomic<uint64_t> items(0);
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto minDuration = std::chrono::duration<double>(config.minSeconds);
+    auto worker = [&](unsigned int thread)
+    {
+        uint64_t done = 0;
+        do
+        {
+            done += work(thread);
+        } while (std::chrono::steady_clock::now() - startTime < minDuration);
+        items += done;
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numThreads; t++)
+        threads.emplace_back(worker, t);
+    worker(0);
+    for (auto& thread : threads)
+        thread.join();
+
+    result.items = items;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    printResult(result);
+}
+
+// Inputs of the benchmarks, generated once with a fixed seed
+struct BenchData
+{
+    std::vector<std::array<uint8_t, 32>> subseeds;
+    std::vector<std::array<uint8_t, 32>> privateKeys;
+    std::vector<std::array<uint8_t, 32>> publicKeys;
+    std::vector<std::array<uint8_t, 32>> digests;
+    std::vector<std::array<uint8_t, 64>> signatures;
+    std::vector<std::array<char, 61>> identities;
+    std::vector<const uint8_t*> privateKeyPtrs, publicKeyPtrs, digestPtrs, signaturePtrs;
+    std::vector<const char*> identityPtrs;
+};
+
+static void generateData(BenchData& data, size_t count)
+{
+    std::mt19937_64 rng(42);
+    data.subseeds.resize(count);
+    data.privateKeys.resize(count);
+    data.publicKeys.resize(count);
+    data.digests.resize(count);
+    data.signatures.resize(count);
+    data.identities.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (auto& b : data.subseeds[i])
+            b = uint8_t(rng());
+        for (auto& b : data.digests[i])
+            b = uint8_t(rng());
+        getPrivateKeyFromSubSeed(data.subseeds[i].data(), data.privateKeys[i].data());
+        getPublicKeyFromPrivateKey(data.privateKeys[i].data(), data.publicKeys[i].data());
+        sign(data.subseeds[i].data(), data.publicKeys[i].data(), data.digests[i].data(), data.signatures[i].data());
+        getIdentityFromPublicKey(data.publicKeys[i].data(), data.identities[i].data(), false);
+        data.privateKeyPtrs.push_back(data.privateKeys[i].data());
+        data.publicKeyPtrs.push_back(data.publicKeys[i].data());
+        data.digestPtrs.push_back(data.digests[i].data());
+        data.signaturePtrs.push_back(data.signatures[i].data());
+        data.identityPtrs.push_back(data.identities[i].data());
+    }
+}
+
+static void benchK12(unsigned int numThreads)
+{
+    for (unsigned int size : config.sizes)
+    {
+        for (unsigned int batch : config.batches)
+        {
+            if (batch == 1)
+            {
+                // independent messages, one per thread
+                std::vector<std::vector<uint8_t>> messages(numThreads, std::vector<uint8_t>(size, 0x5A));
+                measure({ "k12", size, 0, 1, numThreads }, numThreads, [&](unsigned int thread)
+                {
+                    uint8_t digest[32];
+                    KangarooTwelve(messages[thread].data(), size, digest, 32);
+                    return uint64_t(1);
+                });
+                if (numThreads > 1 && size >= 2 * K12_chunkSize)
+                {
+                    // one message, leaves hashed on all threads
+                    measure({ "k12_parallel", size, 0, 1, numThreads }, 1, [&](unsigned int)
+                    {
+                        uint8_t digest[32];
+                        KangarooTwelveParallel(messages[0].data(), size, digest, 32, numThreads);
+                        return uint64_t(1);
+                    });
+                }
+                continue;
+            }
+            if (size >= K12_chunkSize || uint64_t(size) * batch > (256u << 20))
+                continue;
+            std::vector<uint8_t> messages(size_t(size) * batch, 0x5A);
+            std::vector<uint8_t> digests(size_t(32) * batch);
+            std::vector<const uint8_t*> inputs(batch);
+            std::vector<unsigned int> inputByteLens(batch, size);
+            std::vector<uint8_t*> outputs(batch);
+            for (unsigned int i = 0; i < batch; i++)
+            {
+                inputs[i] = messages.data() + size_t(size) * i;
+                outputs[i] = digests.data() + 32 * i;
+            }
+            measure({ "k12_batch", size, 0, batch, numThreads }, 1, [&](unsigned int)
+            {
+                KangarooTwelveBatch(inputs.data(), inputByteLens.data(), outputs.data(), 32, batch, numThreads);
+                return uint64_t(batch);
+            });
+        }
+    }
+}
+
+static void benchSign(const BenchData& data, unsigned int numThreads)
+{
+    for (unsigned int batch : config.batches)
+    {
+        if (batch == 1)
+        {
+            measure({ "sign", 32, 0, 1, numThreads }, numThreads, [&](unsigned int thread)
+            {
+                uint8_t signature[64];
+                sign(data.subseeds[thread].data(), data.publicKeys[thread].data(), data.digests[thread].data(), signature);
+                return uint64_t(1);
+            });
+            continue;
+        }
+        std::vector<std::array<uint8_t, 64>> signatures(batch);
+        std::vector<uint8_t*> signaturePtrs(batch);
+        for (unsigned int i = 0; i < batch; i++)
+            signaturePtrs[i] = signatures[i].data();
+        measure({ "sign_batch", 32, 0, batch, numThreads }, 1, [&](unsigned int)
+        {
+            signBatch(data.subseeds[0].data(), data.publicKeys[0].data(), data.digestPtrs.data(), signaturePtrs.data(),
+                      batch, numThreads);
+            return uint64_t(batch);
+        });
+    }
+}
+
+static void benchVerify(const BenchData& data, unsigned int numThreads)
+{
+    for (unsigned int batch : config.batches)
+    {
+        if (batch == 1)
+        {
+            measure({ "verify", 32, 0, 1, numThreads }, numThreads, [&](unsigned int thread)
+            {
+                if (!verify(data.publicKeys[thread].data(), data.digests[thread].data(), data.signatures[thread].data()))
+                    fprintf(stderr, "Signature verification failed\n");
+                return uint64_t(1);
+            });
+            continue;
+        }
+        // every signature has its own key
+        std::vector<uint8_t> results((batch + 7) / 8);
+        measure({ "verify_batch", 32, 0, batch, numThreads }, 1, [&](unsigned int)
+        {
+            verifyBatch(data.publicKeyPtrs.data(), data.digestPtrs.data(), data.signaturePtrs.data(), batch,
+                        results.data(), numThreads);
+            return uint64_t(batch);
+        });
+    }
+}
+
+static void benchPublicKey(const BenchData& data, unsigned int numThreads)
+{
+    for (unsigned int batch : config.batches)
+    {
+        if (batch == 1)
+        {
+            measure({ "pubkey", 32, 0, 1, numThreads }, numThreads, [&](unsigned int thread)
+            {
+                uint8_t publicKey[32];
+                getPublicKeyFromPrivateKey(data.privateKeys[thread].data(), publicKey);
+                return uint64_t(1);
+            });
+            continue;
+        }
+        std::vector<std::array<uint8_t, 32>> publicKeys(batch);
+        std::vector<uint8_t*> publicKeyPtrs(batch);
+        for (unsigned int i = 0; i < batch; i++)
+            publicKeyPtrs[i] = publicKeys[i].data();
+        measure({ "pubkey_batch", 32, 0, batch, numThreads }, 1, [&](unsigned int)
+        {
+            getPublicKeysBatch(data.privateKeyPtrs.data(), publicKeyPtrs.data(), batch, numThreads);
+            return uint64_t(batch);
+        });
+    }
+}
+
+static void benchIdentity(const BenchData& data, unsigned int numThreads)
+{
+    for (unsigned int batch : config.batches)
+    {
+        if (batch == 1)
+        {
+            measure({ "identity_encode", 32, 0, 1, numThreads }, numThreads, [&](unsigned int thread)
+            {
+                char identity[61];
+                getIdentityFromPublicKey(data.publicKeys[thread].data(), identity, false);
+                return uint64_t(1);
+            });
+            measure({ "identity_decode", 60, 0, 1, numThreads }, numThreads, [&](unsigned int thread)
+            {
+                uint8_t publicKey[32];
+                getPublicKeyFromIdentity(data.identities[thread].data(), publicKey);
+                if (!checkSumIdentity(data.identities[thread].data()))
+                    fprintf(stderr, "Identity checksum failed\n");
+                return uint64_t(1);
+            });
+            continue;
+        }
+        // the batch functions are single-threaded, so each thread converts its own batch
+        std::vector<std::vector<std::array<char, 61>>> identities(numThreads, std::vector<std::array<char, 61>>(batch));
+        std::vector<std::vector<std::array<uint8_t, 32>>> publicKeys(numThreads, std::vector<std::array<uint8_t, 32>>(batch));
+        std::vector<std::vector<char*>> identityPtrs(numThreads, std::vector<char*>(batch));
+        std::vector<std::vector<uint8_t*>> publicKeyPtrs(numThreads, std::vector<uint8_t*>(batch));
+        std::vector<std::vector<uint8_t>> results(numThreads, std::vector<uint8_t>((batch + 7) / 8));
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            for (unsigned int i = 0; i < batch; i++)
+            {
+                identityPtrs[t][i] = identities[t][i].data();
+                publicKeyPtrs[t][i] = publicKeys[t][i].data();
+            }
+        }
+        measure({ "identity_encode_batch", 32, 0, batch, numThreads }, numThreads, [&](unsigned int thread)
+        {
+            getIdentitiesFromPublicKeys(data.publicKeyPtrs.data(), identityPtrs[thread].data(), batch, false);
+            return uint64_t(batch);
+        });
+        measure({ "identity_decode_batch", 60, 0, batch, numThreads }, numThreads, [&](unsigned int thread)
+        {
+            getPublicKeysFromIdentities(data.identityPtrs.data(), publicKeyPtrs[thread].data(), batch,
+                                        results[thread].data());
+            return uint64_t(batch);
+        });
+    }
+}
+
+static void benchMerkle(unsigned int numThreads)
+{
+    for (unsigned int depth : config.depths)
+    {
+        std::vector<std::array<uint8_t, 32>> siblings(depth);
+        for (unsigned int i = 0; i < depth; i++)
+            memset(siblings[i].data(), int(i), 32);
+        uint8_t input[32];
+        memset(input, 0x5A, sizeof(input));
+        measure({ "merkle_root", 32, depth, 1, numThreads }, numThreads, [&](unsigned int thread)
+        {
+            uint8_t root[32];
+            getDigestFromSiblings<32>(depth, input, sizeof(input), thread, (const uint8_t(*)[32])siblings.data(), root);
+            return uint64_t(1);
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "-help") == 0))
+    {
+        printUsage();
+        return 0;
+    }
+    if (!parseArguments(argc, argv))
+    {
+        printUsage();
+        return 1;
+    }
+#ifndef __OPTIMIZE__
+    fprintf(stderr, "WARNING: built without optimization, configure with -DCMAKE_BUILD_TYPE=Release for representative numbers\n");
+#endif
+
+    if (config.threads.empty())
+    {
+        config.threads.push_back(1);
+        if (std::thread::hardware_concurrency() > 1)
+            config.threads.push_back(std::thread::hardware_concurrency());
+    }
+    if (config.cpuLevels.empty())
+        config.cpuLevels.push_back(getCpuLevel());
+    unsigned int maxItems = *std::max_element(config.batches.begin(), config.batches.end());
+    maxItems = std::max(maxItems, *std::max_element(config.threads.begin(), config.threads.end()));
+    BenchData data;
+    generateData(data, maxItems);
+
+    if (!config.json)
+        printf("op,cpu,bytes,depth,batch,threads,items,seconds,ns_per_op,ops_per_sec,mb_per_sec\n");
+    for (int level : config.cpuLevels)
+    {
+        if (setCpuLevel(level) != level)
+        {
+            fprintf(stderr, "The CPU doesn't support %s, skipping it\n", getCpuLevelName(level));
+            continue;
+        }
+        for (unsigned int numThreads : config.threads)
+        {
+            if (selected("k12"))
+                benchK12(numThreads);
+            if (selected("sign"))
+                benchSign(data, numThreads);
+            if (selected("verify"))
+                benchVerify(data, numThreads);
+            if (selected("pubkey"))
+                benchPublicKey(data, numThreads);
+            if (selected("identity"))
+                benchIdentity(data, numThreads);
+            if (selected("merkle"))
+                benchMerkle(numThreads);
+        }
+    }
+    return 0;
+}
@@ -46,8 +46,6 @@ void escrowCreateDeal(const char* nodeIp, int nodePort, const char* seed,
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -56,9 +54,8 @@ void escrowCreateDeal(const char* nodeIp, int nodePort, const char* seed,
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = ESCROW_CONTRACT_INDEX;
@@ -83,7 +80,7 @@ void escrowCreateDeal(const char* nodeIp, int nodePort, const char* seed,
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -208,12 +205,9 @@ int64_t escrowGetSharesFeesForDeal(const char* nodeIp, int nodePort, const char*
 EscrowGetDeals_output escrowGetDealsOutput(const char* nodeIp, int nodePort, const char* seed, const int64_t proposedOffset, const int64_t publicOffset)
 {
     EscrowGetDeals_input input;
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     memset(input.owner, 0, 32);
     memcpy(input.owner, sourcePublicKey, 32); 
     input.proposedOffset = proposedOffset;
@@ -290,8 +284,6 @@ void escrowOperateDeal(const char* nodeIp, int nodePort, const char* seed, const
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -300,9 +292,8 @@ void escrowOperateDeal(const char* nodeIp, int nodePort, const char* seed, const
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = ESCROW_CONTRACT_INDEX;
@@ -327,7 +318,7 @@ void escrowOperateDeal(const char* nodeIp, int nodePort, const char* seed, const
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -360,8 +351,6 @@ void escrowTransferRights(const char* nodeIp, int nodePort, const char* seed, co
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -370,9 +359,8 @@ void escrowTransferRights(const char* nodeIp, int nodePort, const char* seed, co
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = ESCROW_CONTRACT_INDEX;
@@ -397,7 +385,7 @@ void escrowTransferRights(const char* nodeIp, int nodePort, const char* seed, co
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -417,13 +405,10 @@ void escrowTransferRights(const char* nodeIp, int nodePort, const char* seed, co
 void escrowGetFreeAsset(const char* nodeIp, int nodePort, const char* seed, const char* assetName, const char* issuer)
 {
     EscrowGetFreeAsset_input input;
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t pk[32] = { 0 };
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, pk);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(pk, signer.publicKey(), 32);
     getPublicKeyFromIdentity(issuer, sourcePublicKey);
 
     memset(input.owner, 0, 32);
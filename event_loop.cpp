@@ -0,0 +1,735 @@
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#include <Winsock2.h>
+#include <Ws2tcpip.h>
+#define close(x) closesocket(x)
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#endif
+#include <algorithm>
+#include <cstring>
+
+#include "event_loop.h"
+#include "logger.h"
+#include "node_rtt.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// largest packet size that fits into the 3 size bytes of RequestResponseHeader
+#define MAX_PACKET_SIZE 0xFFFFFF
+
+#ifdef _MSC_VER
+
+static bool wouldBlock()
+{
+    int err = WSAGetLastError();
+    return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+}
+
+static bool setNonBlocking(int sock)
+{
+    u_long mode = 1;
+    return ioctlsocket(sock, FIONBIO, &mode) == 0;
+}
+
+#else
+
+static bool wouldBlock()
+{
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EINTR;
+}
+
+static bool setNonBlocking(int sock)
+{
+    int flags = fcntl(sock, F_GETFL, 0);
+    return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+#endif
+
+// Open a non-blocking socket and start connecting to nodeIp:nodePort. Return -1 on error.
+static int openNonBlockingSocket(const char* nodeIp, int nodePort)
+{
+    sockaddr_in addr;
+    memset((char*)&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(nodePort);
+    if (inet_pton(AF_INET, nodeIp, &addr.sin_addr) <= 0)
+    {
+        LOG("Error translating command line ip address to usable one.");
+        return -1;
+    }
+
+    int serverSocket = int(socket(AF_INET, SOCK_STREAM, 0));
+    if (serverSocket < 0)
+        return -1;
+    int keepAlive = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_KEEPALIVE, (const char*)&keepAlive, sizeof keepAlive);
+    if (!setNonBlocking(serverSocket)
+        || (connect(serverSocket, (const sockaddr*)&addr, sizeof(addr)) < 0 && !wouldBlock()))
+    {
+        LOG("Failed to connect %s\n", nodeIp);
+        close(serverSocket);
+        return -1;
+    }
+    return serverSocket;
+}
+
+static std::exception_ptr connectionError()
+{
+    return std::make_exception_ptr(std::logic_error("Unable to establish connection."));
+}
+
+static std::exception_ptr noConnectionError()
+{
+    return std::make_exception_ptr(std::logic_error("No connection."));
+}
+
+AsyncQubicConnection::AsyncQubicConnection(QubicEventLoop* loop, const char* nodeIp, int nodePort,
+                                           unsigned long connectTimeoutMillisec)
+{
+    mLoop = loop;
+    memset(mNodeIp, 0, sizeof(mNodeIp));
+    strncpy(mNodeIp, nodeIp, sizeof(mNodeIp) - 1);
+    mNodePort = nodePort;
+    mConnectTimeoutMillisec = connectTimeoutMillisec;
+    mSocket = -1;
+    mGeneration = 0;
+    mState = CLOSED;
+    mWantWrite = false;
+    mMaxInFlight = 1;
+    mDeadline = std::chrono::steady_clock::time_point::max();
+    mLastActivity = std::chrono::steady_clock::now();
+    mInOffset = 0;
+    mOutOffset = 0;
+}
+
+void AsyncQubicConnection::request(std::vector<uint8_t> packet, PacketHandler onPacket, CompletionHandler onComplete,
+                                   unsigned long timeoutMillisec)
+{
+    auto self = shared_from_this();
+    auto pending = std::make_shared<PendingRequest>();
+    pending->packet = std::move(packet);
+    pending->onPacket = std::move(onPacket);
+    pending->onComplete = std::move(onComplete);
+    pending->timeoutMillisec = timeoutMillisec;
+    pending->dejavu = 0;
+    pending->answered = false;
+    mLoop->post([self, pending]() { self->mLoop->submit(self, std::move(*pending)); });
+}
+
+void AsyncQubicConnection::setMaxInFlight(unsigned int maxInFlight)
+{
+    auto self = shared_from_this();
+    mLoop->post([self, maxInFlight]()
+        {
+            self->mMaxInFlight = (maxInFlight) ? maxInFlight : 1;
+            self->mLoop->sendRequests(self.get());
+        });
+}
+
+QubicEventLoop::QubicEventLoop()
+{
+    mStopping = false;
+    mPollFd = -1;
+    mWakeUpFd[0] = mWakeUpFd[1] = -1;
+#ifdef _MSC_VER
+    WSADATA wsa_data;
+    WSAStartup(MAKEWORD(2, 0), &wsa_data);
+#elif defined(__linux__)
+    mPollFd = epoll_create1(EPOLL_CLOEXEC);
+    mWakeUpFd[0] = mWakeUpFd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mPollFd < 0 || mWakeUpFd[0] < 0)
+        throw std::logic_error("Unable to create event loop.");
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = mWakeUpFd[0];
+    epoll_ctl(mPollFd, EPOLL_CTL_ADD, mWakeUpFd[0], &ev);
+#else
+    if (pipe(mWakeUpFd) != 0 || !setNonBlocking(mWakeUpFd[0]) || !setNonBlocking(mWakeUpFd[1]))
+        throw std::logic_error("Unable to create event loop.");
+#endif
+    mThread = std::thread(&QubicEventLoop::run, this);
+}
+
+QubicEventLoop::~QubicEventLoop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    wakeUp();
+    mThread.join();
+#ifndef _MSC_VER
+    if (mPollFd >= 0)
+        close(mPollFd);
+    if (mWakeUpFd[0] >= 0)
+        close(mWakeUpFd[0]);
+    if (mWakeUpFd[1] >= 0 && mWakeUpFd[1] != mWakeUpFd[0])
+        close(mWakeUpFd[1]);
+#endif
+}
+
+AsyncQCPtr QubicEventLoop::connect(const char* nodeIp, int nodePort, unsigned long connectTimeoutMillisec)
+{
+    return AsyncQCPtr(new AsyncQubicConnection(this, nodeIp, nodePort, connectTimeoutMillisec));
+}
+
+void QubicEventLoop::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPostedTasks.push_back(std::move(task));
+    }
+    wakeUp();
+}
+
+void QubicEventLoop::wakeUp()
+{
+#if defined(__linux__)
+    uint64_t one = 1;
+    if (write(mWakeUpFd[1], &one, sizeof(one))) {}
+#elif !defined(_MSC_VER)
+    uint8_t one = 1;
+    if (write(mWakeUpFd[1], &one, sizeof(one))) {}
+#endif
+    // Windows: the loop polls at least every 10 ms (see run())
+}
+
+void QubicEventLoop::runPostedTasks()
+{
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        tasks.swap(mPostedTasks);
+    }
+    for (auto& task : tasks)
+    {
+        task();
+    }
+}
+
+void QubicEventLoop::run()
+{
+    while (true)
+    {
+        runPostedTasks();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopping)
+                break;
+        }
+        handleTimeouts();
+        mClosedSockets.clear();
+        int timeoutMillisec = pollTimeoutMillisec();
+
+#ifdef __linux__
+        epoll_event events[64];
+        int n = epoll_wait(mPollFd, events, 64, timeoutMillisec);
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.fd == mWakeUpFd[0])
+            {
+                uint64_t value;
+                if (read(mWakeUpFd[0], &value, sizeof(value))) {}
+                continue;
+            }
+            handleEvents(events[i].data.fd, (events[i].events & EPOLLIN) != 0, (events[i].events & EPOLLOUT) != 0,
+                         (events[i].events & (EPOLLERR | EPOLLHUP)) != 0);
+        }
+#else
+        std::vector<pollfd> fds;
+#ifdef _MSC_VER
+        if (timeoutMillisec < 0 || timeoutMillisec > 10)
+            timeoutMillisec = 10;
+#else
+        fds.push_back({ mWakeUpFd[0], POLLIN, 0 });
+#endif
+        for (const auto& entry : mOpenConnections)
+        {
+            short events = POLLIN;
+            if (entry.second->mWantWrite)
+                events |= POLLOUT;
+            fds.push_back({ decltype(pollfd::fd)(entry.first), events, 0 });
+        }
+        if (fds.empty())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMillisec));
+            continue;
+        }
+#ifdef _MSC_VER
+        int n = WSAPoll(fds.data(), ULONG(fds.size()), timeoutMillisec);
+#else
+        int n = poll(fds.data(), fds.size(), timeoutMillisec);
+#endif
+        for (size_t i = 0; n > 0 && i < fds.size(); i++)
+        {
+            if (!fds[i].revents)
+                continue;
+#ifndef _MSC_VER
+            if (fds[i].fd == mWakeUpFd[0])
+            {
+                uint8_t buffer[64];
+                while (read(mWakeUpFd[0], buffer, sizeof(buffer)) > 0) {}
+                continue;
+            }
+#endif
+            handleEvents(int(fds[i].fd), (fds[i].revents & POLLIN) != 0, (fds[i].revents & POLLOUT) != 0,
+                         (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0);
+        }
+#endif
+    }
+    shutdown();
+}
+
+void QubicEventLoop::shutdown()
+{
+    // requests posted before the destructor was called are failed by submit()
+    runPostedTasks();
+    std::vector<AsyncQCPtr> conns;
+    for (const auto& entry : mOpenConnections)
+        conns.push_back(entry.second);
+    auto error = std::make_exception_ptr(std::logic_error("Event loop stopped."));
+    for (auto& conn : conns)
+    {
+        closeSocket(conn.get());
+        conn->mState = AsyncQubicConnection::CLOSED;
+        completeAll(conn->mInFlight, error);
+        completeAll(conn->mRequests, error);
+    }
+}
+
+int QubicEventLoop::pollTimeoutMillisec()
+{
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    for (const auto& entry : mOpenConnections)
+    {
+        const AsyncQubicConnection* conn = entry.second.get();
+        deadline = std::min(deadline, conn->mDeadline);
+        for (const auto& request : conn->mInFlight)
+            deadline = std::min(deadline, request.deadline);
+        if (conn->mRequests.empty() && conn->mInFlight.empty())
+            deadline = std::min(deadline, conn->mLastActivity + std::chrono::milliseconds(ASYNC_IDLE_TIMEOUT_MSEC));
+    }
+    if (deadline == std::chrono::steady_clock::time_point::max())
+        return -1;
+    auto now = std::chrono::steady_clock::now();
+    if (deadline <= now)
+        return 0;
+    // round up, so we don't wake up right before the deadline
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+}
+
+void QubicEventLoop::handleTimeouts()
+{
+    auto now = std::chrono::steady_clock::now();
+    std::vector<AsyncQCPtr> conns;
+    for (const auto& entry : mOpenConnections)
+        conns.push_back(entry.second);
+    for (auto& conn : conns)
+    {
+        if (conn->mDeadline <= now)
+        {
+            fail(conn.get(), connectionError());
+            continue;
+        }
+        if (conn->mMaxInFlight == 1)
+        {
+            // the stream is out of sync if the response arrives late, so start over with a new connection
+            if (!conn->mInFlight.empty() && conn->mInFlight.front().deadline <= now)
+                fail(conn.get(), std::make_exception_ptr(ConnectionTimeout()));
+        }
+        else
+        {
+            // late responses will be dropped because their dejavu is unknown
+            bool timedOut = false;
+            for (auto it = conn->mInFlight.begin(); it != conn->mInFlight.end();)
+            {
+                if (it->deadline <= now)
+                {
+                    complete(conn->mInFlight, it, std::make_exception_ptr(ConnectionTimeout()));
+                    it = conn->mInFlight.begin();
+                    timedOut = true;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            if (timedOut)
+                sendRequests(conn.get());
+        }
+        // idle, or only referenced by mOpenConnections and conns so that nobody can send requests anymore
+        if (conn->mSocket >= 0 && conn->mRequests.empty() && conn->mInFlight.empty()
+            && (conn.use_count() == 2 || conn->mLastActivity + std::chrono::milliseconds(ASYNC_IDLE_TIMEOUT_MSEC) <= now))
+        {
+            closeSocket(conn.get());
+            conn->mState = AsyncQubicConnection::CLOSED;
+        }
+    }
+}
+
+void QubicEventLoop::handleEvents(int socket, bool readable, bool writable, bool error)
+{
+    if (std::find(mClosedSockets.begin(), mClosedSockets.end(), socket) != mClosedSockets.end())
+        return;
+    auto it = mOpenConnections.find(socket);
+    if (it == mOpenConnections.end())
+        return;
+    AsyncQCPtr conn = it->second; // keep alive while handling the events
+    conn->mLastActivity = std::chrono::steady_clock::now();
+
+    if (conn->mState == AsyncQubicConnection::CONNECTING)
+    {
+        if (writable || error)
+            finishConnecting(conn.get());
+        return;
+    }
+    if (writable)
+    {
+        unsigned int generation = conn->mGeneration;
+        flush(conn.get());
+        if (conn->mGeneration != generation)
+            return;
+    }
+    if (readable)
+    {
+        receive(conn.get());
+    }
+    else if (error)
+    {
+        fail(conn.get(), noConnectionError());
+    }
+}
+
+void QubicEventLoop::submit(const AsyncQCPtr& conn, AsyncQubicConnection::PendingRequest&& request)
+{
+    bool stopping;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        stopping = mStopping;
+    }
+    if (stopping)
+    {
+        request.onComplete(std::make_exception_ptr(std::logic_error("Event loop stopped.")));
+        return;
+    }
+    conn->mRequests.push_back(std::move(request));
+    conn->mLastActivity = std::chrono::steady_clock::now();
+    if (conn->mState == AsyncQubicConnection::CLOSED)
+        startConnecting(conn.get());
+    else
+        sendRequests(conn.get());
+}
+
+void QubicEventLoop::startConnecting(AsyncQubicConnection* conn)
+{
+    conn->mSocket = openNonBlockingSocket(conn->mNodeIp, conn->mNodePort);
+    if (conn->mSocket < 0)
+    {
+        completeAll(conn->mRequests, connectionError());
+        return;
+    }
+    conn->mState = AsyncQubicConnection::CONNECTING;
+    conn->mDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(conn->mConnectTimeoutMillisec);
+    mOpenConnections[conn->mSocket] = conn->shared_from_this();
+#ifdef __linux__
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.fd = conn->mSocket;
+    epoll_ctl(mPollFd, EPOLL_CTL_ADD, conn->mSocket, &ev);
+#endif
+    conn->mWantWrite = true;
+}
+
+void QubicEventLoop::finishConnecting(AsyncQubicConnection* conn)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(conn->mSocket, SOL_SOCKET, SO_ERROR, (char*)&err, &len) != 0 || err != 0)
+    {
+        fail(conn, connectionError());
+        return;
+    }
+    // establishing the TCP connection takes one round trip
+    auto startTime = conn->mDeadline - std::chrono::milliseconds(conn->mConnectTimeoutMillisec);
+    recordNodeRtt(conn->mNodeIp, conn->mNodePort,
+                  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count(), false);
+    // the node sends ExchangePublicPeers first, requests are sent after receiving it (see processPackets())
+    conn->mState = AsyncQubicConnection::HANDSHAKING;
+    updateInterest(conn);
+}
+
+void QubicEventLoop::sendRequests(AsyncQubicConnection* conn)
+{
+    if (conn->mState != AsyncQubicConnection::READY)
+        return;
+    const bool pipelining = (conn->mMaxInFlight > 1);
+    bool queued = false;
+    while (!conn->mRequests.empty() && conn->mInFlight.size() < conn->mMaxInFlight)
+    {
+        AsyncQubicConnection::PendingRequest request = std::move(conn->mRequests.front());
+        conn->mRequests.pop_front();
+        auto header = (RequestResponseHeader*)request.packet.data();
+        if (pipelining && !header->isDejavuZero())
+        {
+            auto inFlight = [conn](unsigned int dejavu)
+            {
+                for (const auto& r : conn->mInFlight)
+                    if (r.dejavu == dejavu)
+                        return true;
+                return false;
+            };
+            while (inFlight(header->dejavu()))
+                header->randomizeDejavu();
+        }
+        request.dejavu = header->dejavu();
+        if (request.timeoutMillisec == ADAPTIVE_TIMEOUT_MSEC)
+            request.timeoutMillisec = getNodeTimeoutMsec(conn->mNodeIp, conn->mNodePort);
+        request.sentTime = std::chrono::steady_clock::now();
+        request.deadline = request.sentTime + std::chrono::milliseconds(request.timeoutMillisec);
+        conn->mOutBuffer.insert(conn->mOutBuffer.end(), request.packet.begin(), request.packet.end());
+        request.packet.clear();
+        queued = true;
+        if (pipelining && request.dejavu == 0)
+        {
+            // not answered by the node
+            conn->mInFlight.push_back(std::move(request));
+            complete(conn->mInFlight, conn->mInFlight.end() - 1, nullptr);
+            continue;
+        }
+        conn->mInFlight.push_back(std::move(request));
+    }
+    if (queued)
+        flush(conn);
+}
+
+void QubicEventLoop::flush(AsyncQubicConnection* conn)
+{
+    while (conn->mOutOffset < conn->mOutBuffer.size())
+    {
+        int sentSz = send(conn->mSocket, (const char*)conn->mOutBuffer.data() + conn->mOutOffset,
+                          int(conn->mOutBuffer.size() - conn->mOutOffset), MSG_NOSIGNAL);
+        if (sentSz < 0 && wouldBlock())
+            break;
+        if (sentSz <= 0)
+        {
+            fail(conn, noConnectionError());
+            return;
+        }
+        conn->mOutOffset += sentSz;
+    }
+    if (conn->mOutOffset == conn->mOutBuffer.size() || conn->mOutOffset >= 64 * 1024)
+    {
+        // drop sent data (when pipelining, the buffer may never run empty)
+        conn->mOutBuffer.erase(conn->mOutBuffer.begin(), conn->mOutBuffer.begin() + conn->mOutOffset);
+        conn->mOutOffset = 0;
+    }
+    updateInterest(conn);
+}
+
+void QubicEventLoop::receive(AsyncQubicConnection* conn)
+{
+    const size_t chunkSize = 64 * 1024;
+    while (true)
+    {
+        size_t oldSize = conn->mInBuffer.size();
+        conn->mInBuffer.resize(oldSize + chunkSize);
+        int recvSz = recv(conn->mSocket, (char*)conn->mInBuffer.data() + oldSize, int(chunkSize), 0);
+        conn->mInBuffer.resize(oldSize + (recvSz > 0 ? recvSz : 0));
+        if (recvSz < 0 && wouldBlock())
+            break;
+        if (recvSz <= 0)
+        {
+            // closed connection or error, but still process what has been received before
+            unsigned int generation = conn->mGeneration;
+            processPackets(conn);
+            if (conn->mGeneration == generation)
+                fail(conn, noConnectionError());
+            return;
+        }
+        if (!conn->mInFlight.empty())
+        {
+            // the node is still sending, so give the oldest request more time
+            auto& request = conn->mInFlight.front();
+            request.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(request.timeoutMillisec);
+        }
+        if (recvSz < int(chunkSize))
+            break;
+    }
+    processPackets(conn);
+}
+
+void QubicEventLoop::processPackets(AsyncQubicConnection* conn)
+{
+    const unsigned int generation = conn->mGeneration;
+    while (conn->mGeneration == generation)
+    {
+        size_t available = conn->mInBuffer.size() - conn->mInOffset;
+        if (available < sizeof(RequestResponseHeader))
+            break;
+        const uint8_t* packet = conn->mInBuffer.data() + conn->mInOffset;
+        RequestResponseHeader header = *(const RequestResponseHeader*)packet;
+        unsigned int packetSize = header.size();
+        if (packetSize < sizeof(RequestResponseHeader) || packetSize > MAX_PACKET_SIZE)
+        {
+            fail(conn, std::make_exception_ptr(std::logic_error("Received invalid packet.")));
+            return;
+        }
+        if (available < packetSize)
+            break;
+        conn->mInOffset += packetSize;
+
+        if (conn->mState == AsyncQubicConnection::HANDSHAKING)
+        {
+            if (header.type() == EXCHANGE_PUBLIC_PEERS)
+            {
+                conn->mState = AsyncQubicConnection::READY;
+                conn->mDeadline = std::chrono::steady_clock::time_point::max();
+                sendRequests(conn);
+            }
+            continue;
+        }
+
+        // Find the request this packet belongs to by its dejavu. A packet with zero dejavu can't be told apart from a
+        // response, so it is passed to the request in flight if there is only one, but not taken as its answer.
+        auto it = conn->mInFlight.begin();
+        while (it != conn->mInFlight.end() && it->dejavu != header.dejavu())
+            ++it;
+        const bool matched = it != conn->mInFlight.end();
+        if (!matched && header.isDejavuZero() && conn->mMaxInFlight == 1)
+            it = conn->mInFlight.begin();
+        if (it == conn->mInFlight.end())
+        {
+            // not requested, for example the rest of a response after timeout or after the request was done
+            continue;
+        }
+
+        if (matched && !it->answered)
+        {
+            it->answered = true;
+            // with pipelining, the response also waits for the requests sent before, so only sample sequential ones
+            if (conn->mMaxInFlight == 1)
+            {
+                recordNodeRtt(conn->mNodeIp, conn->mNodePort,
+                              std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - it->sentTime).count());
+            }
+        }
+
+        bool done;
+        std::exception_ptr error;
+        try
+        {
+            done = it->onPacket(header, packet + sizeof(RequestResponseHeader));
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+            done = true;
+        }
+        if (done)
+        {
+            complete(conn->mInFlight, it, error);
+            sendRequests(conn);
+        }
+        else if (matched)
+        {
+            it->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(it->timeoutMillisec);
+        }
+    }
+
+    if (conn->mGeneration == generation)
+    {
+        // drop processed packets
+        conn->mInBuffer.erase(conn->mInBuffer.begin(), conn->mInBuffer.begin() + conn->mInOffset);
+        conn->mInOffset = 0;
+    }
+}
+
+void QubicEventLoop::complete(std::deque<AsyncQubicConnection::PendingRequest>& requests,
+                              std::deque<AsyncQubicConnection::PendingRequest>::iterator it, std::exception_ptr error)
+{
+    AsyncQubicConnection::PendingRequest request = std::move(*it);
+    requests.erase(it);
+    try
+    {
+        request.onComplete(error);
+    }
+    catch (std::exception& e)
+    {
+        LOG("Uncaught exception in request completion handler: %s\n", e.what());
+    }
+}
+
+void QubicEventLoop::completeAll(std::deque<AsyncQubicConnection::PendingRequest>& requests, std::exception_ptr error)
+{
+    while (!requests.empty())
+        complete(requests, requests.begin(), error);
+}
+
+void QubicEventLoop::fail(AsyncQubicConnection* conn, std::exception_ptr error)
+{
+    bool established = (conn->mState == AsyncQubicConnection::READY);
+    closeSocket(conn);
+    conn->mState = AsyncQubicConnection::CLOSED;
+    completeAll(conn->mInFlight, error);
+    if (!established)
+    {
+        // connecting or handshake failed, retrying right away won't help
+        completeAll(conn->mRequests, error);
+        return;
+    }
+    if (!conn->mRequests.empty())
+        startConnecting(conn);
+}
+
+void QubicEventLoop::closeSocket(AsyncQubicConnection* conn)
+{
+    if (conn->mSocket < 0)
+        return;
+#ifdef __linux__
+    epoll_ctl(mPollFd, EPOLL_CTL_DEL, conn->mSocket, nullptr);
+#endif
+    close(conn->mSocket);
+    mClosedSockets.push_back(conn->mSocket);
+    int socket = conn->mSocket;
+    conn->mSocket = -1;
+    conn->mGeneration++;
+    conn->mInBuffer.clear();
+    conn->mInOffset = 0;
+    conn->mOutBuffer.clear();
+    conn->mOutOffset = 0;
+    conn->mWantWrite = false;
+    conn->mDeadline = std::chrono::steady_clock::time_point::max();
+    // conn may be destroyed here if the caller does not hold a reference
+    mOpenConnections.erase(socket);
+}
+
+void QubicEventLoop::updateInterest(AsyncQubicConnection* conn)
+{
+    bool wantWrite = (conn->mState == AsyncQubicConnection::CONNECTING) || (conn->mOutOffset < conn->mOutBuffer.size());
+    if (wantWrite == conn->mWantWrite)
+        return;
+    conn->mWantWrite = wantWrite;
+#ifdef __linux__
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | (wantWrite ? EPOLLOUT : 0);
+    ev.data.fd = conn->mSocket;
+    epoll_ctl(mPollFd, EPOLL_CTL_MOD, conn->mSocket, &ev);
+#endif
+}
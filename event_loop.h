@@ -0,0 +1,237 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "connection.h"
+#include "defines.h"
+#include "structs.h"
+
+// default number of requests in flight per connection when pipelining (see AsyncQubicConnection::setMaxInFlight())
+#define DEFAULT_PIPELINE_DEPTH 32
+// sockets without requests are closed after this time, the next request opens a new one
+#define ASYNC_IDLE_TIMEOUT_MSEC 30000
+
+class QubicEventLoop;
+
+// Called on the event loop thread exactly once per request: with nullptr after PacketHandler returned true, or with
+// the exception that ended the request (ConnectionTimeout, std::logic_error if the connection failed or the loop was
+// stopped).
+typedef std::function<void(std::exception_ptr error)> CompletionHandler;
+
+// Non-blocking connection to a node, driven by a QubicEventLoop. Thread safe.
+// Requests are sent in the order they were submitted. By default, each request is answered before the next one is
+// sent; see setMaxInFlight() for pipelining. Packets are passed to the request with their dejavu; others (such as
+// the rest of a response after the request was done) are dropped. Packets with zero dejavu (such as the optional
+// RequestComputors after the handshake) are only passed to a request if it is the only one in flight, and are not
+// taken as its answer. If the connection fails, it is reestablished for the requests still waiting. The socket is
+// closed after ASYNC_IDLE_TIMEOUT_MSEC without requests, or soon after the last AsyncQCPtr is gone.
+class AsyncQubicConnection : public std::enable_shared_from_this<AsyncQubicConnection>
+{
+public:
+    // Send packet (including its RequestResponseHeader) and pass each received packet to onPacket until it returns
+    // true. onPacket runs on the event loop thread. timeoutMillisec bounds the time waiting for the next bytes of the
+    // response. ADAPTIVE_TIMEOUT_MSEC is replaced by the timeout derived from the node's round-trip time (node_rtt.h).
+    void request(std::vector<uint8_t> packet, PacketHandler onPacket, CompletionHandler onComplete,
+                 unsigned long timeoutMillisec = ADAPTIVE_TIMEOUT_MSEC);
+
+    // Send packet and return the next packet of type T::type(), like QubicConnection::receivePacketWithHeaderAs().
+    // The future throws EndResponseReceived, ConnectionTimeout, or std::logic_error.
+    template <typename T>
+    std::future<T> requestPacketWithHeaderAs(const void* packet, size_t size,
+                                             unsigned long timeoutMillisec = ADAPTIVE_TIMEOUT_MSEC);
+
+    // Send packet and collect the T packets until END_RESPOND, like QubicConnection::getLatestVectorPacketAs().
+    // On timeout or connection failure, the packets received so far are returned.
+    template <typename T>
+    std::future<std::vector<T>> requestLatestVectorPacketAs(const void* packet, size_t size,
+                                                            unsigned long timeoutMillisec = ADAPTIVE_TIMEOUT_MSEC);
+
+    // Send up to maxInFlight requests back-to-back without waiting for their responses (1 = no pipelining).
+    // The response packets are routed to their request by the dejavu of the RequestResponseHeader, see above. A
+    // request with a dejavu already in flight gets a new random one.
+    // Requests with zero dejavu (such as broadcast transactions) are not answered by the node, so they complete when
+    // they have been queued for sending. A timeout only fails the request concerned.
+    void setMaxInFlight(unsigned int maxInFlight);
+
+    const char* nodeIp() const { return mNodeIp; }
+    int nodePort() const { return mNodePort; }
+
+private:
+    friend class QubicEventLoop;
+
+    enum State
+    {
+        CLOSED,
+        CONNECTING,
+        HANDSHAKING,
+        READY,
+    };
+
+    struct PendingRequest
+    {
+        std::vector<uint8_t> packet;
+        PacketHandler onPacket;
+        CompletionHandler onComplete;
+        unsigned long timeoutMillisec;
+        unsigned int dejavu;
+        std::chrono::steady_clock::time_point deadline; // when in flight
+        std::chrono::steady_clock::time_point sentTime; // when in flight
+        bool answered; // a packet of the response has been received
+    };
+
+    AsyncQubicConnection(QubicEventLoop* loop, const char* nodeIp, int nodePort, unsigned long connectTimeoutMillisec);
+
+    // Everything below is only accessed on the event loop thread.
+    QubicEventLoop* mLoop;
+    char mNodeIp[32];
+    int mNodePort;
+    unsigned long mConnectTimeoutMillisec;
+    int mSocket;
+    unsigned int mGeneration; // incremented when the socket is closed
+    State mState;
+    bool mWantWrite;
+    unsigned int mMaxInFlight;
+    std::chrono::steady_clock::time_point mDeadline; // for connecting and handshake
+    std::chrono::steady_clock::time_point mLastActivity; // of the socket or a request, for closing idle sockets
+    std::deque<PendingRequest> mRequests; // waiting to be sent
+    std::deque<PendingRequest> mInFlight; // sent, waiting for response
+    std::vector<uint8_t> mInBuffer;
+    size_t mInOffset;
+    std::vector<uint8_t> mOutBuffer;
+    size_t mOutOffset;
+};
+
+typedef std::shared_ptr<AsyncQubicConnection> AsyncQCPtr;
+
+// Single-threaded I/O engine that keeps many requests in flight across many node sockets, using epoll on Linux and
+// poll elsewhere. All handlers run on the loop's own thread, so they must not block; submitting follow-up requests
+// from a handler is fine.
+class QubicEventLoop
+{
+public:
+    QubicEventLoop();
+    // Fail all pending requests and stop the loop thread.
+    ~QubicEventLoop();
+
+    // Create a connection to nodeIp:nodePort. The socket is opened when the first request is submitted.
+    // connectTimeoutMillisec bounds connecting and receiving the handshake.
+    AsyncQCPtr connect(const char* nodeIp, int nodePort, unsigned long connectTimeoutMillisec = DEFAULT_TIMEOUT_MSEC);
+
+private:
+    friend class AsyncQubicConnection;
+
+    // Run task on the loop thread. Thread safe.
+    void post(std::function<void()> task);
+    void wakeUp();
+    void run();
+    void runPostedTasks();
+    // Time until the next deadline of a request, a connection attempt, or an idle socket. -1 if there is none.
+    int pollTimeoutMillisec();
+    void handleEvents(int socket, bool readable, bool writable, bool error);
+    void handleTimeouts();
+    void shutdown();
+
+    void submit(const AsyncQCPtr& conn, AsyncQubicConnection::PendingRequest&& request);
+    void startConnecting(AsyncQubicConnection* conn);
+    void finishConnecting(AsyncQubicConnection* conn);
+    void sendRequests(AsyncQubicConnection* conn);
+    void flush(AsyncQubicConnection* conn);
+    void receive(AsyncQubicConnection* conn);
+    void processPackets(AsyncQubicConnection* conn);
+    // Remove the request at it from requests and call its completion handler.
+    void complete(std::deque<AsyncQubicConnection::PendingRequest>& requests,
+                  std::deque<AsyncQubicConnection::PendingRequest>::iterator it, std::exception_ptr error);
+    void completeAll(std::deque<AsyncQubicConnection::PendingRequest>& requests, std::exception_ptr error);
+    // Close the socket, fail the requests in flight with error, and reconnect if more requests are waiting. If the
+    // connection could not be established at all, fail all waiting requests instead.
+    void fail(AsyncQubicConnection* conn, std::exception_ptr error);
+    void closeSocket(AsyncQubicConnection* conn);
+    void updateInterest(AsyncQubicConnection* conn);
+
+    std::mutex mMutex;
+    std::vector<std::function<void()>> mPostedTasks;
+    bool mStopping;
+    std::thread mThread;
+
+    // only accessed on the event loop thread
+    std::map<int, AsyncQCPtr> mOpenConnections; // by socket
+    std::vector<int> mClosedSockets; // closed during the current iteration, events for them are stale
+    int mPollFd;     // epoll instance (Linux)
+    int mWakeUpFd[2]; // eventfd or pipe used by wakeUp() (not used on Windows)
+};
+
+template <typename T>
+std::future<T> AsyncQubicConnection::requestPacketWithHeaderAs(const void* packet, size_t size,
+                                                               unsigned long timeoutMillisec)
+{
+    auto promise = std::make_shared<std::promise<T>>();
+    auto result = std::make_shared<T>();
+    memset(result.get(), 0, sizeof(T));
+    request(std::vector<uint8_t>((const uint8_t*)packet, (const uint8_t*)packet + size),
+        [result](const RequestResponseHeader& header, const uint8_t* payload)
+        {
+            if (header.type() == END_RESPOND)
+            {
+                throw EndResponseReceived();
+            }
+            if (header.type() != T::type())
+            {
+                // skip this packet and keep receiving
+                return false;
+            }
+            size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+            memcpy(result.get(), payload, (payloadSize < sizeof(T)) ? payloadSize : sizeof(T));
+            return true;
+        },
+        [promise, result](std::exception_ptr error)
+        {
+            if (error)
+                promise->set_exception(error);
+            else
+                promise->set_value(*result);
+        },
+        timeoutMillisec);
+    return promise->get_future();
+}
+
+template <typename T>
+std::future<std::vector<T>> AsyncQubicConnection::requestLatestVectorPacketAs(const void* packet, size_t size,
+                                                                              unsigned long timeoutMillisec)
+{
+    auto promise = std::make_shared<std::promise<std::vector<T>>>();
+    auto results = std::make_shared<std::vector<T>>();
+    request(std::vector<uint8_t>((const uint8_t*)packet, (const uint8_t*)packet + size),
+        [results](const RequestResponseHeader& header, const uint8_t* payload)
+        {
+            if (header.type() == END_RESPOND)
+            {
+                return true;
+            }
+            if (header.type() == T::type())
+            {
+                size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+                results->emplace_back();
+                memset(&results->back(), 0, sizeof(T));
+                memcpy(&results->back(), payload, (payloadSize < sizeof(T)) ? payloadSize : sizeof(T));
+            }
+            return false;
+        },
+        [promise, results](std::exception_ptr error)
+        {
+            // same as getLatestVectorPacketAs(): keep what has been received before the error
+            promise->set_value(std::move(*results));
+        },
+        timeoutMillisec);
+    return promise->get_future();
+}
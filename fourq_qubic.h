@@ -15,4 +15,22 @@ extern "C" {
 	void sign(const unsigned char* subSeed, const unsigned char* publicKey, const unsigned char* messageDigest, unsigned char* signature);
 	void signWithNonceK(const unsigned char* input, const unsigned char* publicKey, const unsigned char* messageDigest, unsigned char* signature);
 	bool verify(const unsigned char* publicKey, const unsigned char* messageDigest, const unsigned char* signature);
+
+	// Batch functions, to pay the cost of a call from another runtime once for many items. They work on buffers of the
+	// caller only, keep no state between calls, can be called from many threads at once, and don't throw.
+	// numThreads is the number of threads including the calling one (0 = all cores). There is no thread pool: each call
+	// starts numThreads - 1 threads and joins them before returning, which costs tens of microseconds per thread, so
+	// pass 1 for small batches or when calling from threads of your own. With 1, everything runs on the calling thread.
+	// If a thread can't be started, the items run on the threads started so far.
+
+	// Verify count signatures. Bit i % 8 of results[i / 8] is set if signature i is valid; results has (count + 7) / 8
+	// bytes. This is the only batch function allocating memory: about 2 KB per distinct public key (the key tables)
+	// and 200 bytes per signature. Return false with all bits cleared if the memory can't be allocated.
+	bool verifyBatch(const unsigned char* const* publicKeys, const unsigned char* const* messageDigests, const unsigned char* const* signatures, unsigned int count, unsigned char* results, unsigned int numThreads);
+	// Sign count 32-byte digests with the key of subSeed like sign(), writing 64 bytes to each of signatures.
+	void signBatch(const unsigned char* subSeed, const unsigned char* publicKey, const unsigned char* const* messageDigests, unsigned char* const* signatures, unsigned int count, unsigned int numThreads);
+	// Compute the 32-byte public keys of count 32-byte private keys like ecc_mul_fixed() and encode().
+	void getPublicKeysBatch(const unsigned char* const* privateKeys, unsigned char* const* publicKeys, unsigned int count, unsigned int numThreads);
+	// Hash count messages with KangarooTwelve, writing outputByteLen bytes to each of outputs.
+	void KangarooTwelveBatch(const unsigned char* const* inputs, const unsigned int* inputByteLens, unsigned char* const* outputs, unsigned int outputByteLen, unsigned int count, unsigned int numThreads);
 }
@@ -8,6 +8,9 @@ char* g_seed = (char*)DEFAULT_SEED;
 char* g_nodeIp = (char*)DEFAULT_NODE_IP;
 char* g_targetIdentity = nullptr;
 char* g_configFile = nullptr;
+char* g_nodeSetList = nullptr;
+char* g_recordFile = nullptr;
+char* g_replayFile = nullptr;
 char* g_requestedFileName = nullptr;
 char* g_requestedFileName2 = nullptr;
 char* g_requestedTxId  = nullptr;
@@ -34,6 +37,12 @@ int g_nodePort = DEFAULT_NODE_PORT;
 int g_txExtraDataSize = 0;
 int g_rawPacketSize = 0;
 int g_requestedSpecialCommand = -1;
+int g_nodeLatencyProbes = 0;
+double g_replaySpeed = 1.0;
+unsigned int g_numThreads = 0;
+unsigned int g_combWidth = 5;
+unsigned int g_combTables = 5;
+unsigned int g_ticksInFlight = 0;
 char* g_toggleMainAux0 = nullptr;
 char* g_toggleMainAux1 = nullptr;
 int g_setSolutionThresholdEpoch = -1;
@@ -58,6 +67,7 @@ uint64_t g_makeIPOBidPricePerShare = 0;
 
 // qx
 uint32_t g_requestedTickNumber = 0;
+uint32_t g_requestedLastTickNumber = 0;
 uint32_t g_offsetScheduledTick = DEFAULT_SCHEDULED_TICK_OFFSET;
 int g_waitUntilFinish = 0;
 uint8_t g_txExtraData[1024] = {0};
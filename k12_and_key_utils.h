@@ -6,9 +6,14 @@
 #else
 #include <immintrin.h>
 #endif
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "cpu_features.h"
 #include "key_utils.h"
 
 #define ROL64(a, offset) ((((unsigned long long)a) << offset) ^ (((unsigned long long)a) >> (64 - offset)))
@@ -453,8 +458,346 @@ static void KangarooTwelve_F_Absorb(KangarooTwelve_F *instance, const uint8_t *d
     }
 }
 
+#ifdef CPU_X86_KERNELS
+
+static const unsigned long long KeccakP1600_12rounds_RoundConstants[12] = {
+    KeccakF1600RoundConstant0, KeccakF1600RoundConstant1, KeccakF1600RoundConstant2, KeccakF1600RoundConstant3,
+    KeccakF1600RoundConstant4, KeccakF1600RoundConstant5, KeccakF1600RoundConstant6, KeccakF1600RoundConstant7,
+    KeccakF1600RoundConstant8, KeccakF1600RoundConstant9, KeccakF1600RoundConstant10, 0x8000000080008008ULL
+};
+
+#define ROL64x4(a, offset) _mm256_or_si256(_mm256_slli_epi64(a, offset), _mm256_srli_epi64(a, 64 - (offset)))
+
+#define chiPlane4(y)                                                                                           \
+    A[y + 0] = _mm256_xor_si256(B[y + 0], _mm256_andnot_si256(B[y + 1], B[y + 2]));                          \
+    A[y + 1] = _mm256_xor_si256(B[y + 1], _mm256_andnot_si256(B[y + 2], B[y + 3]));                          \
+    A[y + 2] = _mm256_xor_si256(B[y + 2], _mm256_andnot_si256(B[y + 3], B[y + 4]));                          \
+    A[y + 3] = _mm256_xor_si256(B[y + 3], _mm256_andnot_si256(B[y + 4], B[y + 0]));                          \
+    A[y + 4] = _mm256_xor_si256(B[y + 4], _mm256_andnot_si256(B[y + 0], B[y + 1]));
+
+// Keccak-p[1600,12] on 4 interleaved states. Lane i of state j is state[4 * i + j].
+CPU_TARGET_AVX2 static void KeccakP1600_Permute_12rounds_x4(unsigned long long *state)
+{
+    // rotating by 8 and 56 bits moves whole bytes
+    const __m256i rho8 = _mm256_setr_epi8(7, 0, 1, 2, 3, 4, 5, 6, 15, 8, 9, 10, 11, 12, 13, 14,
+                                          7, 0, 1, 2, 3, 4, 5, 6, 15, 8, 9, 10, 11, 12, 13, 14);
+    const __m256i rho56 = _mm256_setr_epi8(1, 2, 3, 4, 5, 6, 7, 0, 9, 10, 11, 12, 13, 14, 15, 8,
+                                           1, 2, 3, 4, 5, 6, 7, 0, 9, 10, 11, 12, 13, 14, 15, 8);
+    __m256i A[25], B[25], C[5], D[5];
+    for (int i = 0; i < 25; i++)
+    {
+        A[i] = _mm256_load_si256((const __m256i *)(state + 4 * i));
+    }
+    for (int round = 0; round < 12; round++)
+    {
+        // theta
+        C[0] = _mm256_xor_si256(_mm256_xor_si256(A[0], A[5]), _mm256_xor_si256(A[10], _mm256_xor_si256(A[15], A[20])));
+        C[1] = _mm256_xor_si256(_mm256_xor_si256(A[1], A[6]), _mm256_xor_si256(A[11], _mm256_xor_si256(A[16], A[21])));
+        C[2] = _mm256_xor_si256(_mm256_xor_si256(A[2], A[7]), _mm256_xor_si256(A[12], _mm256_xor_si256(A[17], A[22])));
+        C[3] = _mm256_xor_si256(_mm256_xor_si256(A[3], A[8]), _mm256_xor_si256(A[13], _mm256_xor_si256(A[18], A[23])));
+        C[4] = _mm256_xor_si256(_mm256_xor_si256(A[4], A[9]), _mm256_xor_si256(A[14], _mm256_xor_si256(A[19], A[24])));
+        D[0] = _mm256_xor_si256(C[4], ROL64x4(C[1], 1));
+        D[1] = _mm256_xor_si256(C[0], ROL64x4(C[2], 1));
+        D[2] = _mm256_xor_si256(C[1], ROL64x4(C[3], 1));
+        D[3] = _mm256_xor_si256(C[2], ROL64x4(C[4], 1));
+        D[4] = _mm256_xor_si256(C[3], ROL64x4(C[0], 1));
+
+        // theta applied, then rho and pi: B[y + 5 * ((2 * x + 3 * y) % 5)] = ROL64(A[x + 5 * y], r[x + 5 * y])
+        B[0] = _mm256_xor_si256(A[0], D[0]);
+        B[10] = ROL64x4(_mm256_xor_si256(A[1], D[1]), 1);
+        B[20] = ROL64x4(_mm256_xor_si256(A[2], D[2]), 62);
+        B[5] = ROL64x4(_mm256_xor_si256(A[3], D[3]), 28);
+        B[15] = ROL64x4(_mm256_xor_si256(A[4], D[4]), 27);
+        B[16] = ROL64x4(_mm256_xor_si256(A[5], D[0]), 36);
+        B[1] = ROL64x4(_mm256_xor_si256(A[6], D[1]), 44);
+        B[11] = ROL64x4(_mm256_xor_si256(A[7], D[2]), 6);
+        B[21] = ROL64x4(_mm256_xor_si256(A[8], D[3]), 55);
+        B[6] = ROL64x4(_mm256_xor_si256(A[9], D[4]), 20);
+        B[7] = ROL64x4(_mm256_xor_si256(A[10], D[0]), 3);
+        B[17] = ROL64x4(_mm256_xor_si256(A[11], D[1]), 10);
+        B[2] = ROL64x4(_mm256_xor_si256(A[12], D[2]), 43);
+        B[12] = ROL64x4(_mm256_xor_si256(A[13], D[3]), 25);
+        B[22] = ROL64x4(_mm256_xor_si256(A[14], D[4]), 39);
+        B[23] = ROL64x4(_mm256_xor_si256(A[15], D[0]), 41);
+        B[8] = ROL64x4(_mm256_xor_si256(A[16], D[1]), 45);
+        B[18] = ROL64x4(_mm256_xor_si256(A[17], D[2]), 15);
+        B[3] = ROL64x4(_mm256_xor_si256(A[18], D[3]), 21);
+        B[13] = _mm256_shuffle_epi8(_mm256_xor_si256(A[19], D[4]), rho8);
+        B[14] = ROL64x4(_mm256_xor_si256(A[20], D[0]), 18);
+        B[24] = ROL64x4(_mm256_xor_si256(A[21], D[1]), 2);
+        B[9] = ROL64x4(_mm256_xor_si256(A[22], D[2]), 61);
+        B[19] = _mm256_shuffle_epi8(_mm256_xor_si256(A[23], D[3]), rho56);
+        B[4] = ROL64x4(_mm256_xor_si256(A[24], D[4]), 14);
+
+        // chi
+        chiPlane4(0)
+        chiPlane4(5)
+        chiPlane4(10)
+        chiPlane4(15)
+        chiPlane4(20)
+
+        // iota
+        A[0] = _mm256_xor_si256(A[0], _mm256_set1_epi64x((long long)KeccakP1600_12rounds_RoundConstants[round]));
+    }
+    for (int i = 0; i < 25; i++)
+    {
+        _mm256_store_si256((__m256i *)(state + 4 * i), A[i]);
+    }
+}
+
+// ternary logic: a ^ b ^ c and a ^ (~b & c)
+#define XOR3x8(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0x96)
+#define chiPlane8(y)                                                  \
+    A[y + 0] = _mm512_ternarylogic_epi64(B[y + 0], B[y + 1], B[y + 2], 0xD2); \
+    A[y + 1] = _mm512_ternarylogic_epi64(B[y + 1], B[y + 2], B[y + 3], 0xD2); \
+    A[y + 2] = _mm512_ternarylogic_epi64(B[y + 2], B[y + 3], B[y + 4], 0xD2); \
+    A[y + 3] = _mm512_ternarylogic_epi64(B[y + 3], B[y + 4], B[y + 0], 0xD2); \
+    A[y + 4] = _mm512_ternarylogic_epi64(B[y + 4], B[y + 0], B[y + 1], 0xD2);
+
+// Keccak-p[1600,12] on 8 interleaved states. Lane i of state j is state[8 * i + j].
+CPU_TARGET_AVX512 static void KeccakP1600_Permute_12rounds_x8(unsigned long long *state)
+{
+    __m512i A[25], B[25], C[5], D[5];
+    for (int i = 0; i < 25; i++)
+    {
+        A[i] = _mm512_load_si512((const void *)(state + 8 * i));
+    }
+    for (int round = 0; round < 12; round++)
+    {
+        // theta
+        C[0] = XOR3x8(XOR3x8(A[0], A[5], A[10]), A[15], A[20]);
+        C[1] = XOR3x8(XOR3x8(A[1], A[6], A[11]), A[16], A[21]);
+        C[2] = XOR3x8(XOR3x8(A[2], A[7], A[12]), A[17], A[22]);
+        C[3] = XOR3x8(XOR3x8(A[3], A[8], A[13]), A[18], A[23]);
+        C[4] = XOR3x8(XOR3x8(A[4], A[9], A[14]), A[19], A[24]);
+        D[0] = _mm512_xor_si512(C[4], _mm512_rol_epi64(C[1], 1));
+        D[1] = _mm512_xor_si512(C[0], _mm512_rol_epi64(C[2], 1));
+        D[2] = _mm512_xor_si512(C[1], _mm512_rol_epi64(C[3], 1));
+        D[3] = _mm512_xor_si512(C[2], _mm512_rol_epi64(C[4], 1));
+        D[4] = _mm512_xor_si512(C[3], _mm512_rol_epi64(C[0], 1));
+
+        // theta applied, then rho and pi (see KeccakP1600_Permute_12rounds_x4())
+        B[0] = _mm512_xor_si512(A[0], D[0]);
+        B[10] = _mm512_rol_epi64(_mm512_xor_si512(A[1], D[1]), 1);
+        B[20] = _mm512_rol_epi64(_mm512_xor_si512(A[2], D[2]), 62);
+        B[5] = _mm512_rol_epi64(_mm512_xor_si512(A[3], D[3]), 28);
+        B[15] = _mm512_rol_epi64(_mm512_xor_si512(A[4], D[4]), 27);
+        B[16] = _mm512_rol_epi64(_mm512_xor_si512(A[5], D[0]), 36);
+        B[1] = _mm512_rol_epi64(_mm512_xor_si512(A[6], D[1]), 44);
+        B[11] = _mm512_rol_epi64(_mm512_xor_si512(A[7], D[2]), 6);
+        B[21] = _mm512_rol_epi64(_mm512_xor_si512(A[8], D[3]), 55);
+        B[6] = _mm512_rol_epi64(_mm512_xor_si512(A[9], D[4]), 20);
+        B[7] = _mm512_rol_epi64(_mm512_xor_si512(A[10], D[0]), 3);
+        B[17] = _mm512_rol_epi64(_mm512_xor_si512(A[11], D[1]), 10);
+        B[2] = _mm512_rol_epi64(_mm512_xor_si512(A[12], D[2]), 43);
+        B[12] = _mm512_rol_epi64(_mm512_xor_si512(A[13], D[3]), 25);
+        B[22] = _mm512_rol_epi64(_mm512_xor_si512(A[14], D[4]), 39);
+        B[23] = _mm512_rol_epi64(_mm512_xor_si512(A[15], D[0]), 41);
+        B[8] = _mm512_rol_epi64(_mm512_xor_si512(A[16], D[1]), 45);
+        B[18] = _mm512_rol_epi64(_mm512_xor_si512(A[17], D[2]), 15);
+        B[3] = _mm512_rol_epi64(_mm512_xor_si512(A[18], D[3]), 21);
+        B[13] = _mm512_rol_epi64(_mm512_xor_si512(A[19], D[4]), 8);
+        B[14] = _mm512_rol_epi64(_mm512_xor_si512(A[20], D[0]), 18);
+        B[24] = _mm512_rol_epi64(_mm512_xor_si512(A[21], D[1]), 2);
+        B[9] = _mm512_rol_epi64(_mm512_xor_si512(A[22], D[2]), 61);
+        B[19] = _mm512_rol_epi64(_mm512_xor_si512(A[23], D[3]), 56);
+        B[4] = _mm512_rol_epi64(_mm512_xor_si512(A[24], D[4]), 14);
+
+        // chi
+        chiPlane8(0)
+        chiPlane8(5)
+        chiPlane8(10)
+        chiPlane8(15)
+        chiPlane8(20)
+
+        // iota
+        A[0] = _mm512_xor_si512(A[0], _mm512_set1_epi64((long long)KeccakP1600_12rounds_RoundConstants[round]));
+    }
+    for (int i = 0; i < 25; i++)
+    {
+        _mm512_store_si512((void *)(state + 8 * i), A[i]);
+    }
+}
+
+// Hash up to N K12 nodes at once, using permute on N interleaved states: each node absorbs its input followed by
+// zeroBytes zero bytes, is padded with suffix ... 0x80, and outputs outputByteLen <= K12_rateInBytes bytes.
+// Inputs of different lengths are hashed together; the state of a node is taken out after its last block.
+template <unsigned int N>
+static void KangarooTwelve_xN(void (*permute)(unsigned long long *), const uint8_t *const *inputs,
+                              const unsigned int *inputByteLens, unsigned int zeroBytes, uint8_t suffix,
+                              uint8_t *const *outputs, unsigned int outputByteLen, unsigned int count)
+{
+    unsigned int numBlocks[N];
+    unsigned int maxBlocks = 0;
+    for (unsigned int j = 0; j < count; j++)
+    {
+        numBlocks[j] = (inputByteLens[j] + zeroBytes) / K12_rateInBytes + 1;
+        if (numBlocks[j] > maxBlocks)
+        {
+            maxBlocks = numBlocks[j];
+        }
+    }
+
+    alignas(64) unsigned long long state[25 * N];
+    memset(state, 0, sizeof(state));
+    // last blocks (with padding) and blocks of unused lanes are copied, the others are read from the input
+    uint8_t paddedBlocks[N][K12_rateInBytes];
+    const uint8_t *blocks[N];
+    for (unsigned int b = 0; b < maxBlocks; b++)
+    {
+        for (unsigned int j = 0; j < N; j++)
+        {
+            if (j < count && (b + 1) * K12_rateInBytes <= inputByteLens[j])
+            {
+                blocks[j] = inputs[j] + b * K12_rateInBytes;
+                continue;
+            }
+            blocks[j] = paddedBlocks[j];
+            memset(paddedBlocks[j], 0, K12_rateInBytes);
+            if (j >= count || b >= numBlocks[j])
+            {
+                continue;
+            }
+            const unsigned int offset = b * K12_rateInBytes;
+            if (offset < inputByteLens[j])
+            {
+                memcpy(paddedBlocks[j], inputs[j] + offset, inputByteLens[j] - offset);
+            }
+            if (b == numBlocks[j] - 1)
+            {
+                paddedBlocks[j][(inputByteLens[j] + zeroBytes) % K12_rateInBytes] ^= suffix;
+                paddedBlocks[j][K12_rateInBytes - 1] ^= 0x80;
+            }
+        }
+        for (unsigned int i = 0; i < K12_rateInBytes / 8; i++)
+        {
+            for (unsigned int j = 0; j < N; j++)
+            {
+                unsigned long long lane;
+                memcpy(&lane, blocks[j] + 8 * i, 8);
+                state[N * i + j] ^= lane;
+            }
+        }
+        permute(state);
+        for (unsigned int j = 0; j < count; j++)
+        {
+            if (b == numBlocks[j] - 1)
+            {
+                for (unsigned int i = 0; i < outputByteLen / 8; i++)
+                {
+                    memcpy(outputs[j] + 8 * i, &state[N * i + j], 8);
+                }
+                if (outputByteLen & 7)
+                {
+                    memcpy(outputs[j] + (outputByteLen & ~7u), &state[N * (outputByteLen / 8) + j], outputByteLen & 7);
+                }
+            }
+        }
+    }
+}
+
+#endif
+
+#define K12_chainingValueSize 32
+
+// Compute the chaining values of the leaves firstLeaf .. lastLeaf - 1 of the K12 tree over input || 0x00 (empty
+// customization). Leaf i covers the bytes from (i + 1) * K12_chunkSize of it. With AVX2 (AVX-512), 4 (8) leaves are
+// hashed at a time.
+static void KangarooTwelve_Leaves(const uint8_t *input, unsigned long long inputByteLen, unsigned long long firstLeaf,
+                                  unsigned long long lastLeaf, uint8_t *chainingValues)
+{
+    const unsigned long long numLeaves = inputByteLen / K12_chunkSize;
+    // the last leaf is shorter and ends with the zero byte, it is hashed separately
+    const unsigned long long lastFullLeaf = (lastLeaf < numLeaves) ? lastLeaf : numLeaves - 1;
+    unsigned long long leaf = firstLeaf;
+#ifdef CPU_X86_KERNELS
+    const int level = getCpuLevel();
+    const unsigned int parallelism = (level == CPU_LEVEL_AVX512) ? 8 : ((level == CPU_LEVEL_AVX2) ? 4 : 1);
+    while (parallelism > 1 && leaf + 1 < lastFullLeaf)
+    {
+        const uint8_t *leafInputs[8];
+        unsigned int leafInputByteLens[8];
+        uint8_t *leafOutputs[8];
+        unsigned int count = 0;
+        for (; count < parallelism && leaf < lastFullLeaf; count++, leaf++)
+        {
+            leafInputs[count] = input + (leaf + 1) * K12_chunkSize;
+            leafInputByteLens[count] = K12_chunkSize;
+            leafOutputs[count] = chainingValues + leaf * K12_chainingValueSize;
+        }
+        if (level == CPU_LEVEL_AVX512)
+        {
+            KangarooTwelve_xN<8>(KeccakP1600_Permute_12rounds_x8, leafInputs, leafInputByteLens, 0, K12_suffixLeaf, leafOutputs, K12_chainingValueSize, count);
+        }
+        else
+        {
+            KangarooTwelve_xN<4>(KeccakP1600_Permute_12rounds_x4, leafInputs, leafInputByteLens, 0, K12_suffixLeaf, leafOutputs, K12_chainingValueSize, count);
+        }
+    }
+#endif
+    for (; leaf < lastLeaf; leaf++)
+    {
+        const unsigned long long offset = (leaf + 1) * K12_chunkSize;
+        const unsigned long long remaining = inputByteLen - offset;
+        KangarooTwelve_F node;
+        memset(&node, 0, sizeof(KangarooTwelve_F));
+        KangarooTwelve_F_Absorb(&node, input + offset, (remaining < K12_chunkSize) ? remaining : K12_chunkSize);
+        if (leaf == numLeaves - 1)
+        {
+            const uint8_t zero = 0;
+            KangarooTwelve_F_Absorb(&node, &zero, 1);
+        }
+        node.state[node.byteIOIndex] ^= K12_suffixLeaf;
+        node.state[K12_rateInBytes - 1] ^= 0x80;
+        KeccakP1600_Permute_12rounds(node.state);
+        memcpy(chainingValues + leaf * K12_chainingValueSize, node.state, K12_chainingValueSize);
+    }
+}
+
+// Absorb the first chunk and the chaining values of the leaves into the final node of the K12 tree and output the hash.
+static void KangarooTwelve_Final(const uint8_t *input, const uint8_t *chainingValues, unsigned long long numLeaves,
+                                 uint8_t *output, unsigned int outputByteLen)
+{
+    KangarooTwelve_F finalNode;
+    memset(&finalNode, 0, sizeof(KangarooTwelve_F));
+    KangarooTwelve_F_Absorb(&finalNode, input, K12_chunkSize);
+    const uint8_t chunkMarker[8] = { 0x03, 0, 0, 0, 0, 0, 0, 0 };
+    KangarooTwelve_F_Absorb(&finalNode, chunkMarker, sizeof(chunkMarker));
+    KangarooTwelve_F_Absorb(&finalNode, chainingValues, numLeaves * K12_chainingValueSize);
+
+    unsigned int n = 0;
+    for (unsigned long long v = numLeaves; v && (n < sizeof(unsigned long long)); ++n, v >>= 8)
+    {
+    }
+    uint8_t encbuf[sizeof(unsigned long long) + 1 + 2];
+    for (unsigned int i = 1; i <= n; ++i)
+    {
+        encbuf[i - 1] = (uint8_t)(numLeaves >> (8 * (n - i)));
+    }
+    encbuf[n] = (uint8_t)n;
+    encbuf[++n] = 0xFF;
+    encbuf[++n] = 0xFF;
+    KangarooTwelve_F_Absorb(&finalNode, encbuf, ++n);
+    finalNode.state[finalNode.byteIOIndex] ^= 0x06;
+    finalNode.state[K12_rateInBytes - 1] ^= 0x80;
+    KeccakP1600_Permute_12rounds(finalNode.state);
+    memcpy(output, finalNode.state, outputByteLen);
+}
+
 static void KangarooTwelve(const uint8_t *input, unsigned int inputByteLen, uint8_t *output, unsigned int outputByteLen)
 {
+#ifdef CPU_X86_KERNELS
+    // large inputs: hash the leaves with the SIMD kernels
+    if (inputByteLen >= 2 * K12_chunkSize && getCpuLevel() != CPU_LEVEL_SCALAR)
+    {
+        const unsigned long long numLeaves = inputByteLen / K12_chunkSize;
+        std::vector<uint8_t> chainingValues(numLeaves * K12_chainingValueSize);
+        KangarooTwelve_Leaves(input, inputByteLen, 0, numLeaves, chainingValues.data());
+        KangarooTwelve_Final(input, chainingValues.data(), numLeaves, output, outputByteLen);
+        return;
+    }
+#endif
+
     KangarooTwelve_F queueNode;
     KangarooTwelve_F finalNode;
     unsigned int blockNumber, queueAbsorbedLen;
@@ -590,6 +933,107 @@ static void KangarooTwelve(const uint8_t *input, unsigned int inputByteLen, uint
     KeccakP1600_Permute_12rounds(finalNode.state);
     memcpy(output, finalNode.state, outputByteLen);
 }
+
+
+// Compute outputs[i] = KangarooTwelve(inputs[i], inputByteLens[i]) for count independent messages. With AVX2 (AVX-512),
+// short messages are hashed 4 (8) at a time, which is much faster than calling KangarooTwelve() for each of them.
+// Messages of K12_chunkSize bytes or more use KangarooTwelve().
+static void KangarooTwelveMany(const uint8_t *const *inputs, const unsigned int *inputByteLens, uint8_t *const *outputs,
+                               unsigned int outputByteLen, unsigned int count)
+{
+#ifdef CPU_X86_KERNELS
+    const int level = getCpuLevel();
+    if (level != CPU_LEVEL_SCALAR && outputByteLen <= K12_rateInBytes)
+    {
+        const unsigned int parallelism = (level == CPU_LEVEL_AVX512) ? 8 : 4;
+        const uint8_t *batchInputs[8];
+        unsigned int batchInputByteLens[8];
+        uint8_t *batchOutputs[8];
+        unsigned int batchSize = 0;
+        for (unsigned int i = 0; i <= count; i++)
+        {
+            if (i < count)
+            {
+                if (inputByteLens[i] >= K12_chunkSize)
+                {
+                    KangarooTwelve(inputs[i], inputByteLens[i], outputs[i], outputByteLen);
+                    continue;
+                }
+                batchInputs[batchSize] = inputs[i];
+                batchInputByteLens[batchSize] = inputByteLens[i];
+                batchOutputs[batchSize] = outputs[i];
+                if (++batchSize < parallelism)
+                {
+                    continue;
+                }
+            }
+            if (batchSize == 1)
+            {
+                KangarooTwelve(batchInputs[0], batchInputByteLens[0], batchOutputs[0], outputByteLen);
+            }
+            else if (batchSize && level == CPU_LEVEL_AVX512)
+            {
+                KangarooTwelve_xN<8>(KeccakP1600_Permute_12rounds_x8, batchInputs, batchInputByteLens, 1, 0x07, batchOutputs, outputByteLen, batchSize);
+            }
+            else if (batchSize)
+            {
+                KangarooTwelve_xN<4>(KeccakP1600_Permute_12rounds_x4, batchInputs, batchInputByteLens, 1, 0x07, batchOutputs, outputByteLen, batchSize);
+            }
+            batchSize = 0;
+        }
+        return;
+    }
+#endif
+    for (unsigned int i = 0; i < count; i++)
+    {
+        KangarooTwelve(inputs[i], inputByteLens[i], outputs[i], outputByteLen);
+    }
+}
+
+// minimum number of leaf chunks per thread of KangarooTwelveParallel() (512 KiB), below that starting a thread costs
+// about as much as hashing the leaves
+#define K12_PARALLEL_MIN_LEAVES_PER_THREAD 64
+
+// Same as KangarooTwelve() for inputs of any size, hashing the leaf chunks of large inputs on up to numThreads threads
+// (including the calling thread) in addition to the SIMD kernels. Each thread gets at least
+// K12_PARALLEL_MIN_LEAVES_PER_THREAD leaves, so inputs below twice that size are hashed on the calling thread only and
+// callers can use this for inputs of any size.
+static void KangarooTwelveParallel(const uint8_t *input, unsigned long long inputByteLen, uint8_t *output,
+                                   unsigned int outputByteLen, unsigned int numThreads)
+{
+    const unsigned long long numLeaves = inputByteLen / K12_chunkSize;
+    const unsigned long long maxThreads = numLeaves / K12_PARALLEL_MIN_LEAVES_PER_THREAD;
+    if (numThreads > maxThreads)
+    {
+        numThreads = (unsigned int)maxThreads;
+    }
+    if (numThreads <= 1 && inputByteLen <= 0xFFFFFFFFULL)
+    {
+        KangarooTwelve(input, (unsigned int)inputByteLen, output, outputByteLen);
+        return;
+    }
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+    std::vector<uint8_t> chainingValues(numLeaves * K12_chainingValueSize);
+    // give each thread a multiple of 8 leaves, so the SIMD kernels run with all lanes
+    unsigned long long leavesPerThread = (numLeaves + numThreads - 1) / numThreads;
+    leavesPerThread = (leavesPerThread + 7) & ~7ULL;
+    std::vector<std::thread> threads;
+    unsigned long long firstLeaf = leavesPerThread;
+    for (; firstLeaf < numLeaves; firstLeaf += leavesPerThread)
+    {
+        const unsigned long long lastLeaf = (firstLeaf + leavesPerThread < numLeaves) ? firstLeaf + leavesPerThread : numLeaves;
+        threads.emplace_back(KangarooTwelve_Leaves, input, inputByteLen, firstLeaf, lastLeaf, chainingValues.data());
+    }
+    KangarooTwelve_Leaves(input, inputByteLen, 0, (leavesPerThread < numLeaves) ? leavesPerThread : numLeaves, chainingValues.data());
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    KangarooTwelve_Final(input, chainingValues.data(), numLeaves, output, outputByteLen);
+}
 #define CURVE_ORDER_0 0x2FB2540EC7768CE7
 #define CURVE_ORDER_1 0xDFBD004DFE0F7999
 #define CURVE_ORDER_2 0xF05397829CBC14E5
@@ -1682,6 +2126,202 @@ VOID_FUNC_DECL ecc_mul_fixed(unsigned long long* k, point_t Q)
     eccnorm(R, Q);
 }
 
+// Fixed-base comb with w-bit windows and v tables of 2^(w-1) points, generalizing FIXED_BASE_TABLE (w = 5, v = 5)
+// to tables built at runtime. Wider combs trade memory for fewer point additions: ecc_mul_fixed() takes 49 additions
+// and 9 doublings with 7.5 KiB, w = 8, v = 4 takes 31 additions and 7 doublings with 48 KiB.
+typedef struct FixedBaseComb
+{
+    unsigned int w, v, d, e;
+    std::vector<unsigned long long> table; // v * 2^(w-1) points in representation (x+y,y-x,2dt), 12 words each
+} FixedBaseComb;
+
+static void table_lookup_comb(const unsigned long long* table, point_precomp_t P, unsigned int digit, unsigned int sign)
+{ // Same as table_lookup_fixed_base() for a table of a FixedBaseComb
+    const point_precomp* entry = ((const point_precomp*)table) + digit;
+    if (sign)
+    {
+        copy32((uint8_t*)P->xy, (const uint8_t*)entry->yx);
+        copy32((uint8_t*)P->yx, (const uint8_t*)entry->xy);
+        P->t2[0][0] = ~entry->t2[0][0];
+        P->t2[0][1] = 0x7FFFFFFFFFFFFFFF - entry->t2[0][1];
+        P->t2[1][0] = ~entry->t2[1][0];
+        P->t2[1][1] = 0x7FFFFFFFFFFFFFFF - entry->t2[1][1];
+    }
+    else
+    {
+        copy32((uint8_t*)P->xy, (const uint8_t*)entry->xy);
+        copy32((uint8_t*)P->yx, (const uint8_t*)entry->yx);
+        copy32((uint8_t*)P->t2, (const uint8_t*)entry->t2);
+    }
+}
+
+static bool buildFixedBaseComb(unsigned int w, unsigned int v, FixedBaseComb& comb)
+{ // Compute the tables of a comb for the generator, table j entry u = 2^(j*e) * (1 + sum u_(k-1) * 2^(k*d)) * G
+    if (w < 2 || w > 10 || v < 1 || v > 10)
+    {
+        return false;
+    }
+    comb.w = w;
+    comb.v = v;
+    comb.e = (250 + w * v - 1) / (w * v);
+    comb.d = comb.e * v;
+    const unsigned int numPoints = 1 << (w - 1);
+    comb.table.assign(size_t(v) * numPoints * sizeof(point_precomp) / 8, 0);
+
+    // the generator is the first point of FIXED_BASE_TABLE
+    point_t G;
+    const point_precomp* g = (const point_precomp*)FIXED_BASE_TABLE;
+    fp2sub1271((felm_t*)g->xy, (felm_t*)g->yx, G->x);
+    fp2add1271((felm_t*)g->xy, (felm_t*)g->yx, G->y);
+    fp2div1271(G->x);
+    fp2div1271(G->y);
+
+    point_extproj_t base;
+    point_setup(G, base);
+    std::vector<point_extproj> points(numPoints);
+    for (unsigned int j = 0; j < v; j++)
+    {
+        if (j)
+        {
+            for (unsigned int i = 0; i < comb.e; i++)
+            {
+                eccdouble(base);
+            }
+        }
+        points[0] = *base;
+        point_extproj_t multiple;
+        *multiple = *base;
+        for (unsigned int k = 1; k < w; k++)
+        {
+            // multiple = 2^(k*d) * base
+            for (unsigned int i = 0; i < comb.d; i++)
+            {
+                eccdouble(multiple);
+            }
+            point_extproj_precomp_t addend;
+            R1_to_R2(multiple, addend);
+            const unsigned int half = 1 << (k - 1);
+            for (unsigned int u = half; u < 2 * half; u++)
+            {
+                point_extproj_t P;
+                *P = points[u - half];
+                eccadd(addend, P);
+                points[u] = *P;
+            }
+        }
+        for (unsigned int u = 0; u < numPoints; u++)
+        {
+            point_extproj_t P;
+            point_t A;
+            *P = points[u];
+            eccnorm(P, A);
+            point_precomp* entry = ((point_precomp*)comb.table.data()) + j * numPoints + u;
+            fp2add1271(A->x, A->y, entry->xy);
+            fp2sub1271(A->y, A->x, entry->yx);
+            fp2mul1271(A->x, A->y, entry->t2);
+            fp2add1271(entry->t2, entry->t2, entry->t2);
+            fp2mul1271(entry->t2, (felm_t*)&PARAMETER_d, entry->t2);
+            for (unsigned int c = 0; c < 2; c++)
+            {
+                mod1271(entry->xy[c]);
+                mod1271(entry->yx[c]);
+                mod1271(entry->t2[c]);
+            }
+        }
+    }
+    return true;
+}
+
+static void ecc_mul_fixed_comb(const FixedBaseComb& comb, const unsigned long long* k, point_t Q)
+{ // Fixed-base scalar multiplication Q = k*G like ecc_mul_fixed(), with the tables of comb
+    const unsigned int w = comb.w, v = comb.v, d = comb.d, e = comb.e;
+    const unsigned int numPoints = 1 << (w - 1);
+    unsigned int digits[350]; // l = w * d < 250 + w * v
+    unsigned long long scalar[4];
+
+    Montgomery_multiply_mod_order(k, Montgomery_Rprime, scalar);
+    Montgomery_multiply_mod_order(scalar, ONE, scalar);
+
+    // Converting scalar to odd using the prime subgroup order
+    if (!(scalar[0] & 1))
+    {
+        uint8_t carry = _addcarry_u64(0, scalar[0], CURVE_ORDER_0, &scalar[0]);
+        carry = _addcarry_u64(carry, scalar[1], CURVE_ORDER_1, &scalar[1]);
+        carry = _addcarry_u64(carry, scalar[2], CURVE_ORDER_2, &scalar[2]);
+        _addcarry_u64(carry, scalar[3], CURVE_ORDER_3, &scalar[3]);
+    }
+
+    // Modified LSB-set recoding, see ecc_mul_fixed()
+    for (unsigned int i = 0; i < d; i++)
+    {
+        scalar[0] = __shiftright128(scalar[0], scalar[1], 1);
+        scalar[1] = __shiftright128(scalar[1], scalar[2], 1);
+        scalar[2] = __shiftright128(scalar[2], scalar[3], 1);
+        scalar[3] >>= 1;
+        digits[i] = (i == d - 1) ? 0 : (unsigned int)((scalar[0] & 1) - 1);
+    }
+    for (unsigned int i = d; i < w * d; i++)
+    {
+        digits[i] = (unsigned int)(scalar[0] & 1);
+
+        scalar[0] = __shiftright128(scalar[0], scalar[1], 1);
+        scalar[1] = __shiftright128(scalar[1], scalar[2], 1);
+        scalar[2] = __shiftright128(scalar[2], scalar[3], 1);
+        scalar[3] >>= 1;
+
+        const unsigned long long temp = (0 - digits[i - (i / d) * d]) & digits[i];
+        scalar[0] += temp;
+        unsigned long long carry = scalar[0] ? 0 : (temp & 1);
+        scalar[1] += carry;
+        carry = scalar[1] ? 0 : (carry & 1);
+        scalar[2] += carry;
+        scalar[3] += (scalar[2] ? 0 : (carry & 1));
+    }
+
+    // the window of column c holds the digits of rows w-1 .. 1
+    auto window = [&](unsigned int c)
+    {
+        unsigned int digit = 0;
+        for (unsigned int row = w - 1; row >= 1; row--)
+        {
+            digit = (digit << 1) + digits[row * d + c];
+        }
+        return digit;
+    };
+
+    point_extproj_t R;
+    point_precomp_t S;
+
+    table_lookup_comb(comb.table.data() + (v - 1) * numPoints * 12, S, window(d - 1), digits[d - 1]);
+    // Conversion from representation (x+y,y-x,2dt) to (X,Y,Z,Ta,Tb)
+    fp2sub1271(S->xy, S->yx, R->x);
+    fp2add1271(S->xy, S->yx, R->y);
+    fp2div1271(R->x);
+    fp2div1271(R->y);
+    R->z[0][0] = 1; R->z[0][1] = 0; R->z[1][0] = 0; R->z[1][1] = 0;
+    copy32((uint8_t*)R->ta, (uint8_t*)&R->x);
+    copy32((uint8_t*)R->tb, (uint8_t*)&R->y);
+
+    for (unsigned int j = v - 1; j-- > 0;)
+    {
+        const unsigned int c = j * e + e - 1;
+        table_lookup_comb(comb.table.data() + j * numPoints * 12, S, window(c), digits[c]);
+        eccmadd(S, R);
+    }
+    for (unsigned int ii = e - 1; ii-- > 0;)
+    {
+        eccdouble(R);
+        for (unsigned int j = v; j-- > 0;)
+        {
+            const unsigned int c = j * e + ii;
+            table_lookup_comb(comb.table.data() + j * numPoints * 12, S, window(c), digits[c]);
+            eccmadd(S, R);
+        }
+    }
+
+    eccnorm(R, Q);
+}
+
 static void ecc_tau(point_extproj_t P)
 { // Apply tau mapping to a point, P = tau(P)
     f2elm_t t0, t1;
@@ -1928,16 +2568,9 @@ static void ecc_precomp_double(point_extproj_t P, point_extproj_precomp_t* Table
     R1_to_R2(Q, Table[3]);                  // Converting from (X,Y,Z,Ta,Tb) to (X+Y,Y-X,2Z,2dT)
 }
 
-static bool ecc_mul_double(unsigned long long* k, unsigned long long* l, point_t Q)
-{ // Double scalar multiplication R = k*G + l*Q, where the G is the generator
-    // Uses DOUBLE_SCALAR_TABLE, which contains multiples of G, Phi(G), Psi(G) and Phi(Psi(G))
-    // The function uses wNAF with interleaving.
-    char digits_k1[65], digits_k2[65], digits_k3[65], digits_k4[65];
-    char digits_l1[65], digits_l2[65], digits_l3[65], digits_l4[65];
-    point_precomp_t V;
-    point_extproj_t Q1, Q2, Q3, Q4, T;
-    point_extproj_precomp_t U, Q_table1[4], Q_table2[4], Q_table3[4], Q_table4[4];
-    unsigned long long k_scalars[4], l_scalars[4];
+static bool ecc_precomp_double_tables(point_t Q, point_extproj_precomp_t Q_tables[4][4])
+{ // Validate Q and compute the multiples of Q, Phi(Q), Psi(Q) and Psi(Phi(Q)) used by ecc_mul_double_tables()
+    point_extproj_t Q1, Q2, Q3, Q4;
 
     point_setup(Q, Q1);                                             // Convert to representation (X,Y,1,Ta,Tb)
 
@@ -1966,6 +2599,25 @@ static bool ecc_mul_double(unsigned long long* k, unsigned long long* l, point_t
     copy32((uint8_t*)Q4->tb, (uint8_t*)&Q2->tb);
     ecc_psi(Q4);
 
+    ecc_precomp_double(Q1, Q_tables[0]);
+    ecc_precomp_double(Q2, Q_tables[1]);
+    ecc_precomp_double(Q3, Q_tables[2]);
+    ecc_precomp_double(Q4, Q_tables[3]);
+
+    return true;
+}
+
+static void ecc_mul_double_tables(unsigned long long* k, unsigned long long* l, point_extproj_precomp_t Q_tables[4][4], point_t R)
+{ // Double scalar multiplication R = k*G + l*Q, where the G is the generator and Q_tables is computed by ecc_precomp_double_tables()
+    // Uses DOUBLE_SCALAR_TABLE, which contains multiples of G, Phi(G), Psi(G) and Phi(Psi(G))
+    // The function uses wNAF with interleaving.
+    char digits_k1[65], digits_k2[65], digits_k3[65], digits_k4[65];
+    char digits_l1[65], digits_l2[65], digits_l3[65], digits_l4[65];
+    point_precomp_t V;
+    point_extproj_t T;
+    point_extproj_precomp_t U;
+    unsigned long long k_scalars[4], l_scalars[4];
+
     decompose((unsigned long long*)k, k_scalars);                   // Scalar decomposition
     decompose((unsigned long long*)l, l_scalars);
     wNAF_recode(k_scalars[0], 8, digits_k1);                        // Scalar recoding
@@ -1976,10 +2628,6 @@ static bool ecc_mul_double(unsigned long long* k, unsigned long long* l, point_t
     wNAF_recode(l_scalars[1], 4, digits_l2);
     wNAF_recode(l_scalars[2], 4, digits_l3);
     wNAF_recode(l_scalars[3], 4, digits_l4);
-    ecc_precomp_double(Q1, Q_table1);
-    ecc_precomp_double(Q2, Q_table2);
-    ecc_precomp_double(Q3, Q_table3);
-    ecc_precomp_double(Q4, Q_table4);
 
     T->x[0][0] = 0; T->x[0][1] = 0; T->x[1][0] = 0; T->x[1][1] = 0; // Initialize T as the neutral point (0:1:1)
     T->y[0][0] = 1; T->y[0][1] = 0; T->y[1][0] = 0; T->y[1][1] = 0;
@@ -1991,42 +2639,42 @@ static bool ecc_mul_double(unsigned long long* k, unsigned long long* l, point_t
 
         if (digits_l1[i] < 0)
         {
-            eccneg_extproj_precomp(Q_table1[(-digits_l1[i]) >> 1], U);
+            eccneg_extproj_precomp(Q_tables[0][(-digits_l1[i]) >> 1], U);
             eccadd(U, T);
         }
         else if (digits_l1[i] > 0)
         {
-            eccadd(Q_table1[(digits_l1[i]) >> 1], T);
+            eccadd(Q_tables[0][(digits_l1[i]) >> 1], T);
         }
 
         if (digits_l2[i] < 0)
         {
-            eccneg_extproj_precomp(Q_table2[(-digits_l2[i]) >> 1], U);
+            eccneg_extproj_precomp(Q_tables[1][(-digits_l2[i]) >> 1], U);
             eccadd(U, T);
         }
         else if (digits_l2[i] > 0)
         {
-            eccadd(Q_table2[(digits_l2[i]) >> 1], T);
+            eccadd(Q_tables[1][(digits_l2[i]) >> 1], T);
         }
 
         if (digits_l3[i] < 0)
         {
-            eccneg_extproj_precomp(Q_table3[(-digits_l3[i]) >> 1], U);
+            eccneg_extproj_precomp(Q_tables[2][(-digits_l3[i]) >> 1], U);
             eccadd(U, T);
         }
         else if (digits_l3[i] > 0)
         {
-            eccadd(Q_table3[(digits_l3[i]) >> 1], T);
+            eccadd(Q_tables[2][(digits_l3[i]) >> 1], T);
         }
 
         if (digits_l4[i] < 0)
         {
-            eccneg_extproj_precomp(Q_table4[(-digits_l4[i]) >> 1], U);
+            eccneg_extproj_precomp(Q_tables[3][(-digits_l4[i]) >> 1], U);
             eccadd(U, T);
         }
         else if (digits_l4[i] > 0)
         {
-            eccadd(Q_table4[(digits_l4[i]) >> 1], T);
+            eccadd(Q_tables[3][(digits_l4[i]) >> 1], T);
         }
 
         if (digits_k1[i] < 0)
@@ -2070,7 +2718,18 @@ static bool ecc_mul_double(unsigned long long* k, unsigned long long* l, point_t
         }
     }
 
-    eccnorm(T, Q);
+    eccnorm(T, R);
+}
+
+static bool ecc_mul_double(unsigned long long* k, unsigned long long* l, point_t Q)
+{ // Double scalar multiplication R = k*G + l*Q, where the G is the generator
+    point_extproj_precomp_t Q_tables[4][4];
+
+    if (!ecc_precomp_double_tables(Q, Q_tables))
+    {
+        return false;
+    }
+    ecc_mul_double_tables(k, l, Q_tables, Q);
 
     return true;
 }
@@ -2295,6 +2954,22 @@ static bool decode(const uint8_t* Pencoded, point_t P)
     return true;
 }
 
+static void signResponse(const unsigned char* k, unsigned long long* r, unsigned char* h, unsigned char* signature)
+{ // Second half of the signature, s = r - h * k mod order, from the nonce hash r and the challenge hash h
+    Montgomery_multiply_mod_order(r, Montgomery_Rprime, r);
+    Montgomery_multiply_mod_order(r, ONE, r);
+    Montgomery_multiply_mod_order((unsigned long long*)h, Montgomery_Rprime, (unsigned long long*)h);
+    Montgomery_multiply_mod_order((unsigned long long*)h, ONE, (unsigned long long*)h);
+    Montgomery_multiply_mod_order((unsigned long long*)k, Montgomery_Rprime, (unsigned long long*)(signature + 32));
+    Montgomery_multiply_mod_order((unsigned long long*)h, Montgomery_Rprime, (unsigned long long*)h);
+    Montgomery_multiply_mod_order((unsigned long long*)(signature + 32), (unsigned long long*)h, (unsigned long long*)(signature + 32));
+    Montgomery_multiply_mod_order((unsigned long long*)(signature + 32), ONE, (unsigned long long*)(signature + 32));
+    if (_subborrow_u64(_subborrow_u64(_subborrow_u64(_subborrow_u64(0, r[0], ((unsigned long long*)signature)[4], &((unsigned long long*)signature)[4]), r[1], ((unsigned long long*)signature)[5], &((unsigned long long*)signature)[5]), r[2], ((unsigned long long*)signature)[6], &((unsigned long long*)signature)[6]), r[3], ((unsigned long long*)signature)[7], &((unsigned long long*)signature)[7]))
+    {
+        _addcarry_u64(_addcarry_u64(_addcarry_u64(_addcarry_u64(0, ((unsigned long long*)signature)[4], CURVE_ORDER_0, &((unsigned long long*)signature)[4]), ((unsigned long long*)signature)[5], CURVE_ORDER_1, &((unsigned long long*)signature)[5]), ((unsigned long long*)signature)[6], CURVE_ORDER_2, &((unsigned long long*)signature)[6]), ((unsigned long long*)signature)[7], CURVE_ORDER_3, &((unsigned long long*)signature)[7]);
+    }
+}
+
 VOID_FUNC_DECL signWithNonceK(const unsigned char* k, const unsigned char* publicKey, const unsigned char* messageDigest, unsigned char* signature)
 {
     // Requires correctly precalculated k as input!
@@ -2315,18 +2990,7 @@ VOID_FUNC_DECL signWithNonceK(const unsigned char* k, const unsigned char* publi
     copy32(temp + 32, (uint8_t*)publicKey);
 
     KangarooTwelve(temp, 32 + 64, h, 64);
-    Montgomery_multiply_mod_order(r, Montgomery_Rprime, r);
-    Montgomery_multiply_mod_order(r, ONE, r);
-    Montgomery_multiply_mod_order((unsigned long long*)h, Montgomery_Rprime, (unsigned long long*)h);
-    Montgomery_multiply_mod_order((unsigned long long*)h, ONE, (unsigned long long*)h);
-    Montgomery_multiply_mod_order((unsigned long long*)k, Montgomery_Rprime, (unsigned long long*)(signature + 32));
-    Montgomery_multiply_mod_order((unsigned long long*)h, Montgomery_Rprime, (unsigned long long*)h);
-    Montgomery_multiply_mod_order((unsigned long long*)(signature + 32), (unsigned long long*)h, (unsigned long long*)(signature + 32));
-    Montgomery_multiply_mod_order((unsigned long long*)(signature + 32), ONE, (unsigned long long*)(signature + 32));
-    if (_subborrow_u64(_subborrow_u64(_subborrow_u64(_subborrow_u64(0, r[0], ((unsigned long long*)signature)[4], &((unsigned long long*)signature)[4]), r[1], ((unsigned long long*)signature)[5], &((unsigned long long*)signature)[5]), r[2], ((unsigned long long*)signature)[6], &((unsigned long long*)signature)[6]), r[3], ((unsigned long long*)signature)[7], &((unsigned long long*)signature)[7]))
-    {
-        _addcarry_u64(_addcarry_u64(_addcarry_u64(_addcarry_u64(0, ((unsigned long long*)signature)[4], CURVE_ORDER_0, &((unsigned long long*)signature)[4]), ((unsigned long long*)signature)[5], CURVE_ORDER_1, &((unsigned long long*)signature)[5]), ((unsigned long long*)signature)[6], CURVE_ORDER_2, &((unsigned long long*)signature)[6]), ((unsigned long long*)signature)[7], CURVE_ORDER_3, &((unsigned long long*)signature)[7]);
-    }
+    signResponse(k, r, h, signature);
 }
 
 VOID_FUNC_DECL sign(const unsigned char* subseed, const unsigned char* publicKey, const unsigned char* messageDigest, unsigned char* signature) 
@@ -2371,28 +3035,273 @@ BOOL_FUNC_DECL verify(const unsigned char* publicKey, const unsigned char* messa
     return (memcmp(A, signature, 32) == 0);
 }
 
+typedef struct VerificationKey
+{ // Public key decoded and prepared for verifyWithKey(), so that the work depending only on the key is done once
+    unsigned char publicKey[32];
+    bool valid; // false if publicKey is not a valid encoded point
+    point_extproj_precomp_t tables[4][4];
+} VerificationKey;
+
+static void prepareVerificationKey(const unsigned char* publicKey, VerificationKey* key)
+{
+    point_t A;
+
+    memcpy(key->publicKey, publicKey, 32);
+    key->valid = !(publicKey[15] & 0x80) && decode(publicKey, A) && ecc_precomp_double_tables(A, key->tables);
+}
+
+static bool verifyWithHash(const VerificationKey* key, const unsigned char* h, const unsigned char* signature)
+{ // Same as verify(), given h = K12(R || A || messageDigest)
+    point_t A;
+
+    if (!key->valid || (signature[15] & 0x80) || (signature[62] & 0xC0) || signature[63])
+    {
+        return false;
+    }
+    ecc_mul_double_tables((unsigned long long*)(signature + 32), (unsigned long long*)h, (point_extproj_precomp_t(*)[4])key->tables, A);
+    encode(A, (unsigned char*)A);
+
+    return (memcmp(A, signature, 32) == 0);
+}
+
+static bool verifyWithKey(const VerificationKey* key, const unsigned char* messageDigest, const unsigned char* signature)
+{ // Same as verify() with a prepared public key
+    unsigned char temp[32 + 64];
+    unsigned char h[64];
+
+    memcpy(temp, signature, 32);
+    memcpy(temp + 32, key->publicKey, 32);
+    memcpy(temp + 64, messageDigest, 32);
+    KangarooTwelve(temp, 32 + 64, h, 64);
+
+    return verifyWithHash(key, h, signature);
+}
+
+// Run work(i) for i = 0 .. count - 1 on numThreads threads (including the calling thread, 0 = one per hardware thread).
+// With one thread, work runs on the calling thread only. If a thread can't be started, the items run on the threads
+// started so far, so this doesn't throw unless work does.
+template <typename Work>
+static void runOnThreads(unsigned int count, unsigned int numThreads, const Work& work)
+{
+    if (!numThreads)
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if (numThreads > count)
+    {
+        numThreads = count;
+    }
+    std::atomic<unsigned int> next(0);
+    auto worker = [&]()
+    {
+        for (unsigned int i = next++; i < count; i = next++)
+        {
+            work(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numThreads; t++)
+    {
+        try
+        {
+            threads.emplace_back(worker);
+        }
+        catch (...)
+        {
+            break;
+        }
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+static void verifyBatchWithKeys(const VerificationKey* const* keys, const unsigned char* const* messageDigests, const unsigned char* const* signatures, unsigned int count, unsigned char* results, unsigned int numThreads)
+{ // Same as verifyBatch() with prepared public keys
+    memset(results, 0, (count + 7) / 8);
+    if (!count)
+    {
+        return;
+    }
+
+    // h = K12(R || A || messageDigest) of all signatures at once
+    std::vector<unsigned char> hashInputs(count * (32 + 64));
+    std::vector<unsigned char> hashes(count * 64);
+    std::vector<const uint8_t*> inputs(count);
+    std::vector<unsigned int> inputByteLens(count, 32 + 64);
+    std::vector<uint8_t*> outputs(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned char* temp = hashInputs.data() + i * (32 + 64);
+        memcpy(temp, signatures[i], 32);
+        memcpy(temp + 32, keys[i]->publicKey, 32);
+        memcpy(temp + 64, messageDigests[i], 32);
+        inputs[i] = temp;
+        outputs[i] = hashes.data() + i * 64;
+    }
+    KangarooTwelveMany(inputs.data(), inputByteLens.data(), outputs.data(), 64, count);
+
+    std::vector<char> valid(count);
+    runOnThreads(count, numThreads, [&](unsigned int i)
+    {
+        valid[i] = verifyWithHash(keys[i], hashes.data() + i * 64, signatures[i]);
+    });
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (valid[i])
+        {
+            results[i / 8] |= 1 << (i % 8);
+        }
+    }
+}
+
+static void verifyBatchOrThrow(const unsigned char* const* publicKeys, const unsigned char* const* messageDigests, const unsigned char* const* signatures, unsigned int count, unsigned char* results, unsigned int numThreads)
+{ // Same as verifyBatch(), throwing std::bad_alloc if memory can't be allocated
+    // group equal public keys
+    std::vector<unsigned int> order(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [publicKeys](unsigned int a, unsigned int b) { return memcmp(publicKeys[a], publicKeys[b], 32) < 0; });
+    std::vector<unsigned int> keyOf(count);
+    std::vector<unsigned int> firstOfKey;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (i == 0 || memcmp(publicKeys[order[i]], publicKeys[order[i - 1]], 32))
+        {
+            firstOfKey.push_back(order[i]);
+        }
+        keyOf[order[i]] = (unsigned int)firstOfKey.size() - 1;
+    }
+    std::vector<VerificationKey> keys(firstOfKey.size());
+    runOnThreads((unsigned int)firstOfKey.size(), numThreads, [&](unsigned int k)
+    {
+        prepareVerificationKey(publicKeys[firstOfKey[k]], &keys[k]);
+    });
+
+    std::vector<const VerificationKey*> keyPtrs(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        keyPtrs[i] = &keys[keyOf[i]];
+    }
+    verifyBatchWithKeys(keyPtrs.data(), messageDigests, signatures, count, results, numThreads);
+}
+
+BOOL_FUNC_DECL verifyBatch(const unsigned char* const* publicKeys, const unsigned char* const* messageDigests, const unsigned char* const* signatures, unsigned int count, unsigned char* results, unsigned int numThreads)
+{
+    // Verify count signatures like verify(), setting bit i % 8 of results[i / 8] if signature i is valid.
+    // Each distinct public key is prepared once (see VerificationKey), the challenge hashes are computed together with
+    // KangarooTwelveMany, and the scalar multiplications run on numThreads threads (0 = one per hardware thread).
+    // Return false with all bits cleared if the memory for the keys and hashes can't be allocated, so that nothing
+    // is thrown through the C interface of the library.
+    try
+    {
+        verifyBatchOrThrow(publicKeys, messageDigests, signatures, count, results, numThreads);
+    }
+    catch (...)
+    {
+        memset(results, 0, (count + 7) / 8);
+        return false;
+    }
+    return true;
+}
+
+// number of items per group of the batch functions, hashed together with KangarooTwelveMany
+#define BATCH_GROUP_SIZE 16
+
+VOID_FUNC_DECL signBatch(const unsigned char* subseed, const unsigned char* publicKey, const unsigned char* const* messageDigests, unsigned char* const* signatures, unsigned int count, unsigned int numThreads)
+{
+    // Sign count message digests with one key like sign(). The nonce key is derived once, the nonce and challenge
+    // hashes of a group of digests are computed together with KangarooTwelveMany, and the groups run on numThreads
+    // threads (0 = one per hardware thread).
+    unsigned char k[64];
+    KangarooTwelve(subseed, 32, k, 64);
+    runOnThreads((count + BATCH_GROUP_SIZE - 1) / BATCH_GROUP_SIZE, numThreads, [&](unsigned int group)
+    {
+        const unsigned int first = group * BATCH_GROUP_SIZE;
+        const unsigned int n = (count - first < BATCH_GROUP_SIZE) ? count - first : BATCH_GROUP_SIZE;
+        unsigned char temp[BATCH_GROUP_SIZE][32 + 64];
+        unsigned long long r[BATCH_GROUP_SIZE][8];
+        unsigned char h[BATCH_GROUP_SIZE][64];
+        const uint8_t* inputs[BATCH_GROUP_SIZE];
+        unsigned int inputByteLens[BATCH_GROUP_SIZE];
+        uint8_t* outputs[BATCH_GROUP_SIZE];
+
+        // r = K12(k[32..63] || messageDigest)
+        for (unsigned int i = 0; i < n; i++)
+        {
+            copy32(temp[i] + 32, k + 32);
+            copy32(temp[i] + 64, messageDigests[first + i]);
+            inputs[i] = temp[i] + 32;
+            inputByteLens[i] = 32 + 32;
+            outputs[i] = (uint8_t*)r[i];
+        }
+        KangarooTwelveMany(inputs, inputByteLens, outputs, 64, n);
+
+        // h = K12(R || publicKey || messageDigest)
+        for (unsigned int i = 0; i < n; i++)
+        {
+            point_t R;
+            ecc_mul_fixed(r[i], R);
+            encode(R, signatures[first + i]);
+            copy32(temp[i], signatures[first + i]);
+            copy32(temp[i] + 32, publicKey);
+            inputs[i] = temp[i];
+            inputByteLens[i] = 32 + 64;
+            outputs[i] = h[i];
+        }
+        KangarooTwelveMany(inputs, inputByteLens, outputs, 64, n);
+
+        for (unsigned int i = 0; i < n; i++)
+        {
+            signResponse(k, r[i], h[i], signatures[first + i]);
+        }
+    });
+}
+
+VOID_FUNC_DECL getPublicKeysBatch(const unsigned char* const* privateKeys, unsigned char* const* publicKeys, unsigned int count, unsigned int numThreads)
+{
+    // Compute the 32-byte public keys of count private keys like ecc_mul_fixed() and encode() on numThreads threads
+    // (0 = one per hardware thread).
+    runOnThreads(count, numThreads, [&](unsigned int i)
+    {
+        unsigned long long k[4];
+        point_t P;
+        memcpy(k, privateKeys[i], 32);
+        ecc_mul_fixed(k, P);
+        encode(P, publicKeys[i]);
+    });
+}
+
+VOID_FUNC_DECL KangarooTwelveBatch(const unsigned char* const* inputs, const unsigned int* inputByteLens, unsigned char* const* outputs, unsigned int outputByteLen, unsigned int count, unsigned int numThreads)
+{
+    // Hash count messages with KangarooTwelve. Short messages are hashed 4 or 8 at a time with the SIMD kernels (see
+    // KangarooTwelveMany), groups of messages run on numThreads threads (0 = one per hardware thread).
+    runOnThreads((count + BATCH_GROUP_SIZE - 1) / BATCH_GROUP_SIZE, numThreads, [&](unsigned int group)
+    {
+        const unsigned int first = group * BATCH_GROUP_SIZE;
+        const unsigned int n = (count - first < BATCH_GROUP_SIZE) ? count - first : BATCH_GROUP_SIZE;
+        KangarooTwelveMany(inputs + first, inputByteLens + first, outputs + first, outputByteLen, n);
+    });
+}
+
+#ifndef BUILD_4Q_LIB
+// The seed helpers need key_utils.cpp, which is not part of the fourq-qubic library.
+
 /* Get 32 bytes of public key from 55-char seed
  * */
 static void getPublicKeyFromSeed(const char* seed, uint8_t* publicKey)
 {
-    uint8_t privateKey[32] = {0};
-    uint8_t subseed[32] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, publicKey);
+    memcpy(publicKey, getSigningContext(seed).publicKey(), 32);
 }
 
 /* Sign an array of bytes
  * */
 static void signData(const char* seed, const uint8_t* data, const size_t dataLength, uint8_t* signature)
 {
-    uint8_t privateKey[32] = {0};
-    uint8_t sourcePublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
-    uint8_t digest[32];
-    KangarooTwelve(data, uint32_t(dataLength), digest, 32);
-    sign(subseed, sourcePublicKey, digest, signature);
-}
\ No newline at end of file
+    getSigningContext(seed).signData(data, dataLength, signature);
+}
+#endif
\ No newline at end of file
@@ -1,4 +1,10 @@
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "k12_and_key_utils.h"
@@ -32,6 +38,127 @@ void getPublicKeyFromPrivateKey(const uint8_t* privateKey, uint8_t* publicKey)
     encode(P, publicKey);
 }
 
+SigningContext::SigningContext(const char* seed)
+{
+    memset(mSubseed, 0, sizeof(mSubseed));
+    mValid = getSubseedFromSeed((const uint8_t*)seed, mSubseed);
+    KangarooTwelve(mSubseed, 32, mNonceKey, 64);
+    getPublicKeyFromPrivateKey(mNonceKey, mPublicKey);
+}
+
+void SigningContext::sign(const uint8_t* messageDigest, uint8_t* signature) const
+{
+    signWithNonceK(mNonceKey, mPublicKey, messageDigest, signature);
+}
+
+void SigningContext::signData(const uint8_t* data, size_t dataLength, uint8_t* signature) const
+{
+    uint8_t digest[32];
+    KangarooTwelve(data, uint32_t(dataLength), digest, 32);
+    sign(digest, signature);
+}
+
+const SigningContext& getSigningContext(const char* seed)
+{
+    static std::mutex contextsMutex;
+    static std::map<std::string, std::unique_ptr<SigningContext>> contexts; // by seed
+    std::string key(seed, strnlen(seed, 55));
+    std::lock_guard<std::mutex> lock(contextsMutex);
+    std::unique_ptr<SigningContext>& context = contexts[key];
+    if (!context)
+        context.reset(new SigningContext(seed));
+    return *context;
+}
+
+#define SEED_BATCH_SIZE 64
+
+bool getPublicKeysFromSeeds(const char* const* seeds, uint8_t* const* publicKeys, size_t count, uint8_t* results,
+                            unsigned int numThreads, unsigned int combWidth, unsigned int combTables)
+{
+    const FixedBaseComb* comb = nullptr;
+    if (combWidth != 5 || combTables != 5)
+    {
+        static std::mutex combsMutex;
+        static std::map<std::pair<unsigned int, unsigned int>, std::unique_ptr<FixedBaseComb>> combs; // by (w, v)
+        std::lock_guard<std::mutex> lock(combsMutex);
+        std::unique_ptr<FixedBaseComb>& entry = combs[std::make_pair(combWidth, combTables)];
+        if (!entry)
+        {
+            std::unique_ptr<FixedBaseComb> newComb(new FixedBaseComb());
+            if (!buildFixedBaseComb(combWidth, combTables, *newComb))
+                return false;
+            entry = std::move(newComb);
+        }
+        comb = entry.get();
+    }
+    if (!numThreads)
+    {
+        numThreads = std::thread::hardware_concurrency();
+        if (!numThreads)
+            numThreads = 1;
+    }
+
+    memset(results, 0, (count + 7) / 8);
+    std::vector<uint8_t> valid(count);
+    const unsigned int numBatches = (unsigned int)((count + SEED_BATCH_SIZE - 1) / SEED_BATCH_SIZE);
+    runOnThreads(numBatches, numThreads, [&](unsigned int batch)
+    {
+        uint8_t seedBytes[SEED_BATCH_SIZE][55];
+        uint8_t subseeds[SEED_BATCH_SIZE][32];
+        uint8_t privateKeys[SEED_BATCH_SIZE][32];
+        const uint8_t* seedInputs[SEED_BATCH_SIZE];
+        const uint8_t* subseedInputs[SEED_BATCH_SIZE];
+        unsigned int seedByteLens[SEED_BATCH_SIZE];
+        unsigned int subseedByteLens[SEED_BATCH_SIZE];
+        uint8_t* subseedOutputs[SEED_BATCH_SIZE];
+        uint8_t* privateKeyOutputs[SEED_BATCH_SIZE];
+        size_t batchIndices[SEED_BATCH_SIZE];
+
+        const size_t first = size_t(batch) * SEED_BATCH_SIZE;
+        const size_t n = (count - first < SEED_BATCH_SIZE) ? count - first : SEED_BATCH_SIZE;
+        unsigned int numValid = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            const char* seed = seeds[first + k];
+            bool isValid = true;
+            for (int i = 0; i < 55 && isValid; i++)
+            {
+                isValid = (seed[i] >= 'a' && seed[i] <= 'z');
+                seedBytes[numValid][i] = uint8_t(seed[i] - 'a');
+            }
+            if (!isValid)
+                continue;
+            seedInputs[numValid] = seedBytes[numValid];
+            seedByteLens[numValid] = 55;
+            subseedOutputs[numValid] = subseeds[numValid];
+            subseedInputs[numValid] = subseeds[numValid];
+            subseedByteLens[numValid] = 32;
+            privateKeyOutputs[numValid] = privateKeys[numValid];
+            batchIndices[numValid] = first + k;
+            numValid++;
+        }
+
+        KangarooTwelveMany(seedInputs, seedByteLens, subseedOutputs, 32, numValid);
+        KangarooTwelveMany(subseedInputs, subseedByteLens, privateKeyOutputs, 32, numValid);
+        for (unsigned int v = 0; v < numValid; v++)
+        {
+            point_t P;
+            if (comb)
+                ecc_mul_fixed_comb(*comb, (const unsigned long long*)privateKeys[v], P);
+            else
+                ecc_mul_fixed((unsigned long long*)privateKeys[v], P);
+            encode(P, publicKeys[batchIndices[v]]);
+            valid[batchIndices[v]] = 1;
+        }
+    });
+    for (size_t i = 0; i < count; i++)
+    {
+        if (valid[i])
+            results[i / 8] |= uint8_t(1 << (i % 8));
+    }
+    return true;
+}
+
 void getIdentityFromPublicKey(const uint8_t* pubkey, char* dstIdentity, bool isLowerCase)
 {
     uint8_t publicKey[32] ;
@@ -58,12 +185,210 @@ void getIdentityFromPublicKey(const uint8_t* pubkey, char* dstIdentity, bool isL
     for (int i = 0; i < 60; i++) dstIdentity[i] = char(identity[i]);
 }
 
+// number of keys converted together by the batch functions
+#define IDENTITY_BATCH_SIZE 256
+// an identity fragment of 14 digits is split into chunks of 6, 6 and 2 digits, which fit 32 bits
+#define IDENTITY_CHUNK_BASE 308915776ULL // 26^6
+#define IDENTITY_CHUNKS_PER_KEY 12
+
+// Write the 6 base-26 digits of the chunks from first on: digits[j * count + i] is digit j of chunks[i]. x / 26 is
+// computed as (x * 0x4EC4EC4F) >> 35, which is exact for all 32-bit x. The vector kernels return the number of chunks
+// done, a multiple of their width.
+static void getChunkDigits(const uint32_t* chunks, uint32_t* digits, size_t first, size_t count)
+{
+    for (size_t i = first; i < count; i++)
+    {
+        uint32_t x = chunks[i];
+        for (int j = 0; j < 6; j++)
+        {
+            uint32_t q = uint32_t((uint64_t(x) * 0x4EC4EC4FULL) >> 35);
+            digits[j * count + i] = x - q * 26;
+            x = q;
+        }
+    }
+}
+
+#ifdef CPU_X86_KERNELS
+CPU_TARGET_AVX2 static size_t getChunkDigits_AVX2(const uint32_t* chunks, uint32_t* digits, size_t count)
+{
+    const __m256i magic = _mm256_set1_epi32(0x4EC4EC4F);
+    const __m256i base = _mm256_set1_epi32(26);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(chunks + i));
+        for (int j = 0; j < 6; j++)
+        {
+            __m256i qEven = _mm256_srli_epi64(_mm256_mul_epu32(x, magic), 35);
+            __m256i qOdd = _mm256_slli_epi64(_mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), magic), 35), 32);
+            __m256i q = _mm256_blend_epi32(qEven, qOdd, 0xAA);
+            _mm256_storeu_si256((__m256i*)(digits + j * count + i), _mm256_sub_epi32(x, _mm256_mullo_epi32(q, base)));
+            x = q;
+        }
+    }
+    return i;
+}
+
+CPU_TARGET_AVX512 static size_t getChunkDigits_AVX512(const uint32_t* chunks, uint32_t* digits, size_t count)
+{
+    const __m512i magic = _mm512_set1_epi32(0x4EC4EC4F);
+    const __m512i base = _mm512_set1_epi32(26);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i x = _mm512_loadu_si512((const void*)(chunks + i));
+        for (int j = 0; j < 6; j++)
+        {
+            __m512i qEven = _mm512_srli_epi64(_mm512_mul_epu32(x, magic), 35);
+            __m512i qOdd = _mm512_slli_epi64(_mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(x, 32), magic), 35), 32);
+            __m512i q = _mm512_mask_blend_epi32(0xAAAA, qEven, qOdd);
+            _mm512_storeu_si512((void*)(digits + j * count + i), _mm512_sub_epi32(x, _mm512_mullo_epi32(q, base)));
+            x = q;
+        }
+    }
+    return i;
+}
+#endif
+
+void getIdentitiesFromPublicKeys(const uint8_t* const* publicKeys, char* const* identities, size_t count, bool isLowerCase)
+{
+    const char letterA = isLowerCase ? 'a' : 'A';
+    std::vector<uint32_t> chunks(IDENTITY_BATCH_SIZE * IDENTITY_CHUNKS_PER_KEY);
+    std::vector<uint32_t> digits(IDENTITY_BATCH_SIZE * IDENTITY_CHUNKS_PER_KEY * 6);
+    uint32_t checksums[IDENTITY_BATCH_SIZE];
+    uint8_t* checksumOutputs[IDENTITY_BATCH_SIZE];
+    unsigned int keyByteLens[IDENTITY_BATCH_SIZE];
+    for (size_t first = 0; first < count; first += IDENTITY_BATCH_SIZE)
+    {
+        const size_t n = (count - first < IDENTITY_BATCH_SIZE) ? count - first : IDENTITY_BATCH_SIZE;
+        const size_t numChunks = n * IDENTITY_CHUNKS_PER_KEY;
+        for (size_t k = 0; k < n; k++)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                uint64_t fragment;
+                memcpy(&fragment, publicKeys[first + k] + (i << 3), 8);
+                uint32_t* c = &chunks[k * IDENTITY_CHUNKS_PER_KEY + i * 3];
+                c[0] = uint32_t(fragment % IDENTITY_CHUNK_BASE);
+                fragment /= IDENTITY_CHUNK_BASE;
+                c[1] = uint32_t(fragment % IDENTITY_CHUNK_BASE);
+                c[2] = uint32_t(fragment / IDENTITY_CHUNK_BASE);
+            }
+            checksums[k] = 0;
+            checksumOutputs[k] = (uint8_t*)&checksums[k];
+            keyByteLens[k] = 32;
+        }
+
+        size_t done = 0;
+#ifdef CPU_X86_KERNELS
+        if (getCpuLevel() == CPU_LEVEL_AVX512)
+            done = getChunkDigits_AVX512(chunks.data(), digits.data(), numChunks);
+        else if (getCpuLevel() == CPU_LEVEL_AVX2)
+            done = getChunkDigits_AVX2(chunks.data(), digits.data(), numChunks);
+#endif
+        getChunkDigits(chunks.data(), digits.data(), done, numChunks);
+
+        KangarooTwelveMany(publicKeys + first, keyByteLens, checksumOutputs, 3, (unsigned int)n);
+        for (size_t k = 0; k < n; k++)
+        {
+            char* identity = identities[first + k];
+            for (int i = 0; i < 4; i++)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    const size_t chunk = k * IDENTITY_CHUNKS_PER_KEY + i * 3 + c;
+                    for (int j = 0; j < ((c < 2) ? 6 : 2); j++)
+                        identity[i * 14 + c * 6 + j] = char(letterA + digits[j * numChunks + chunk]);
+                }
+            }
+            uint32_t checksum = checksums[k] & 0x3FFFF;
+            for (int i = 0; i < 4; i++)
+            {
+                identity[56 + i] = char(letterA + checksum % 26);
+                checksum /= 26;
+            }
+            identity[60] = 0;
+        }
+    }
+}
+
+void getPublicKeysFromIdentities(const char* const* identities, uint8_t* const* publicKeys, size_t count, uint8_t* results)
+{
+    memset(results, 0, (count + 7) / 8);
+    uint8_t keys[IDENTITY_BATCH_SIZE][32];
+    const uint8_t* keyInputs[IDENTITY_BATCH_SIZE];
+    unsigned int keyByteLens[IDENTITY_BATCH_SIZE];
+    uint32_t checksums[IDENTITY_BATCH_SIZE];
+    uint8_t* checksumOutputs[IDENTITY_BATCH_SIZE];
+    size_t batchIndices[IDENTITY_BATCH_SIZE];
+    for (size_t first = 0; first < count; first += IDENTITY_BATCH_SIZE)
+    {
+        const size_t n = (count - first < IDENTITY_BATCH_SIZE) ? count - first : IDENTITY_BATCH_SIZE;
+        unsigned int numValid = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            const char* identity = identities[first + k];
+            bool valid = true;
+            for (int i = 0; i < 56 && valid; i++)
+                valid = (identity[i] >= 'A' && identity[i] <= 'Z');
+            if (!valid)
+                continue;
+            for (int i = 0; i < 4; i++)
+            {
+                uint32_t c[3] = { 0, 0, 0 };
+                for (int j = 13; j >= 0; j--)
+                    c[j / 6] = c[j / 6] * 26 + uint32_t(identity[i * 14 + j] - 'A');
+                // wraps around like getPublicKeyFromIdentity() for identities above 2^64
+                uint64_t fragment = c[0] + c[1] * IDENTITY_CHUNK_BASE + c[2] * IDENTITY_CHUNK_BASE * IDENTITY_CHUNK_BASE;
+                memcpy(keys[numValid] + (i << 3), &fragment, 8);
+            }
+            memcpy(publicKeys[first + k], keys[numValid], 32);
+            keyInputs[numValid] = keys[numValid];
+            keyByteLens[numValid] = 32;
+            checksums[numValid] = 0;
+            checksumOutputs[numValid] = (uint8_t*)&checksums[numValid];
+            batchIndices[numValid] = first + k;
+            numValid++;
+        }
+
+        KangarooTwelveMany(keyInputs, keyByteLens, checksumOutputs, 3, numValid);
+        for (unsigned int v = 0; v < numValid; v++)
+        {
+            const char* identity = identities[batchIndices[v]];
+            uint32_t checksum = checksums[v] & 0x3FFFF;
+            bool valid = true;
+            for (int i = 0; i < 4 && valid; i++)
+            {
+                valid = (identity[56 + i] == char('A' + checksum % 26));
+                checksum /= 26;
+            }
+            if (valid)
+                results[batchIndices[v] / 8] |= uint8_t(1 << (batchIndices[v] % 8));
+        }
+    }
+}
+
 void getTxHashFromDigest(const uint8_t* digest, char* txHash)
 {
     bool isLowerCase = true;
     getIdentityFromPublicKey(digest, txHash, isLowerCase);
 }
 
+bool getDigestFromTxHash(const char* txHash, uint8_t* digest)
+{
+    char identity[61] = { 0 };
+    for (int i = 0; i < 60; i++)
+    {
+        if (txHash[i] < 'a' || txHash[i] > 'z')
+            return false;
+        identity[i] = txHash[i] - 'a' + 'A';
+    }
+    if (!checkSumIdentity(identity))
+        return false;
+    getPublicKeyFromIdentity(identity, digest);
+    return true;
+}
+
 void getPublicKeyFromIdentity(const char* identity, uint8_t* publicKey)
 {
     unsigned char publicKeyBuffer[32];
@@ -1,13 +1,64 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 bool getSubseedFromSeed(const uint8_t* seed, uint8_t* subseed);
 void getPrivateKeyFromSubSeed(const uint8_t* seed, uint8_t* privateKey);
 void getPublicKeyFromPrivateKey(const uint8_t* privateKey, uint8_t* publicKey);
 void getIdentityFromPublicKey(const uint8_t* pubkey, char* identity, bool isLowerCase);
 void getTxHashFromDigest(const uint8_t* digest, char* txHash);
+// Inverse of getTxHashFromDigest(). Return false if txHash is not 60 lowercase letters with a valid checksum.
+bool getDigestFromTxHash(const char* txHash, uint8_t* digest);
 void getPublicKeyFromIdentity(const char* identity, uint8_t* publicKey);
 bool checkSumIdentity(const char* identity);
 
+// Batch versions of getIdentityFromPublicKey() and getPublicKeyFromIdentity() / checkSumIdentity() for many keys, such
+// as spectrum dumps. The base-26 digits are computed with SIMD reciprocal division where the CPU supports it (see
+// cpu_features.h) and the checksums with KangarooTwelveMany().
+// identities[i] receives the 60 characters of publicKeys[i] followed by a terminating zero.
+void getIdentitiesFromPublicKeys(const uint8_t* const* publicKeys, char* const* identities, size_t count, bool isLowerCase);
+// publicKeys[i] is written if the first 56 characters of identities[i] are A-Z like getPublicKeyFromIdentity(). Bit
+// i % 8 of results[i / 8] is set if in addition the checksum is correct like checkSumIdentity().
+void getPublicKeysFromIdentities(const char* const* identities, uint8_t* const* publicKeys, size_t count, uint8_t* results);
+
+// Keys derived from a seed once, for signing many messages. The keys don't change after construction, so sign() can
+// be called from many threads at once.
+class SigningContext
+{
+public:
+    explicit SigningContext(const char* seed);
+
+    // false if the seed is not 55 lowercase letters
+    bool valid() const { return mValid; }
+    const uint8_t* subseed() const { return mSubseed; }
+    const uint8_t* privateKey() const { return mNonceKey; }
+    const uint8_t* publicKey() const { return mPublicKey; }
+
+    // Sign the 32-byte messageDigest like sign(subseed(), publicKey(), messageDigest, signature).
+    void sign(const uint8_t* messageDigest, uint8_t* signature) const;
+    // Sign the K12 digest of data.
+    void signData(const uint8_t* data, size_t dataLength, uint8_t* signature) const;
+
+private:
+    bool mValid;
+    uint8_t mSubseed[32];
+    uint8_t mNonceKey[64]; // K12 of the subseed, the first 32 bytes are the private key
+    uint8_t mPublicKey[32];
+};
+
+// Return the signing context of seed. Each seed is derived once per process. Thread safe.
+const SigningContext& getSigningContext(const char* seed);
+
+// Derive the public keys of many seeds like getSubseedFromSeed(), getPrivateKeyFromSubSeed() and
+// getPublicKeyFromPrivateKey(), hashing with KangarooTwelveMany() and multiplying on numThreads threads (0 = one per
+// hardware thread). Bit i % 8 of results[i / 8] is set if seeds[i] is 55 lowercase letters, publicKeys[i] is only
+// written then. With combWidth and combTables other than 5, the public keys are computed with a fixed-base comb of
+// combTables tables of 2^(combWidth-1) points (see FixedBaseComb), built on first use. Return false if the comb
+// parameters are out of range (2 to 10 and 1 to 10).
+bool getPublicKeysFromSeeds(const char* const* seeds, uint8_t* const* publicKeys, size_t count, uint8_t* results,
+                            unsigned int numThreads, unsigned int combWidth = 5, unsigned int combTables = 5);
+
 // Compute the digest (root hash) from siblings of Merkle tree
 template <unsigned int hashByteLen>
 void getDigestFromSiblings(
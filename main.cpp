@@ -6,6 +6,9 @@
 #include "argparser.h"
 #include "wallet_utils.h"
 #include "node_utils.h"
+#include "tick_archive.h"
+#include "tick_follower.h"
+#include "tx_index.h"
 #include "asset_utils.h"
 #include "key_utils.h"
 #include "sanity_check.h"
@@ -37,10 +40,19 @@ int run(int argc, char* argv[])
             sanityCheckSeed(g_seed);
             printWalletInfo(g_seed);
             break;
+        case DERIVE_KEYS:
+            sanityFileExist(g_requestedFileName);
+            sanityCheckValidString(g_requestedFileName2);
+            deriveKeysFromSeedFile(g_requestedFileName, g_requestedFileName2, g_numThreads, g_combWidth, g_combTables);
+            break;
         case GET_CURRENT_TICK:
             sanityCheckNode(g_nodeIp, g_nodePort);
             printTickInfoFromNode(g_nodeIp, g_nodePort);
             break;
+        case GET_NODE_LATENCY:
+            sanityCheckNode(g_nodeIp, g_nodePort);
+            printNodeLatency(g_nodeIp, g_nodePort, g_nodeLatencyProbes);
+            break;
         case GET_SYSTEM_INFO:
             sanityCheckNode(g_nodeIp, g_nodePort);
             printSystemInfoFromNode(g_nodeIp, g_nodePort);
@@ -131,20 +143,37 @@ int run(int argc, char* argv[])
             sanityCheckNode(g_nodeIp, g_nodePort);
             getTickDataToFile(g_nodeIp, g_nodePort, g_requestedTickNumber, g_requestedFileName);
             break;
+        case GET_TICK_RANGE_TO_ARCHIVE:
+            sanityCheckNode(g_nodeIp, g_nodePort);
+            getTickRangeToArchive(g_nodeIp, g_nodePort, g_requestedTickNumber, g_requestedLastTickNumber,
+                                  g_requestedFileName, g_ticksInFlight);
+            break;
+        case FOLLOW_TICKS:
+            sanityCheckNode(g_nodeIp, g_nodePort);
+            followTicks(g_nodeIp, g_nodePort, g_requestedTickNumber, g_ticksInFlight);
+            break;
         case GET_QUORUM_TICK:
             sanityCheckNode(g_nodeIp, g_nodePort);
             getQuorumTick(g_nodeIp, g_nodePort, g_requestedTickNumber, g_requestedFileName);
             break;
         case READ_TICK_DATA:
-            sanityFileExist(g_requestedFileName);
+            sanityTickFileExist(g_requestedFileName);
             sanityFileExist(g_requestedFileName2);
             printTickDataFromFile(g_requestedFileName, g_requestedFileName2);
             break;
         case CHECK_TX_ON_FILE:
-            sanityFileExist(g_requestedFileName);
+            sanityTickFileExist(g_requestedFileName);
             sanityCheckTxHash(g_requestedTxId);
             checkTxOnFile(g_requestedTxId, g_requestedFileName);
             break;
+        case BUILD_TX_INDEX:
+            sanityFileExist(g_requestedFileName);
+            buildTxIndex(g_requestedFileName, g_requestedFileName2, g_numThreads);
+            break;
+        case LOOKUP_TX_INDEX:
+            sanityFileExist(g_requestedFileName);
+            lookupTxIndex(g_requestedFileName, g_requestedFileName2);
+            break;
         case PUBLISH_PROPOSAL:
             printf("On development. Come back later\n");
             break;
@@ -452,19 +481,23 @@ int run(int argc, char* argv[])
             getExecutionFeeMultiplier(g_nodeIp, g_nodePort, g_seed);
             break;
         case GET_ORACLE_QUERY:
+            sanityCheckCpuAvx2();
             sanityCheckNode(g_nodeIp, g_nodePort);
             processGetOracleQuery(g_nodeIp, g_nodePort, g_paramString1, g_paramString2);
             break;
         case GET_ORACLE_SUBSCRIPTION:
+            sanityCheckCpuAvx2();
             sanityCheckNode(g_nodeIp, g_nodePort);
             processGetOracleSubscription(g_nodeIp, g_nodePort, g_paramString1, g_paramString2);
             break;
         case SEND_ORACLE_QUERY_TX:
+            sanityCheckCpuAvx2();
             sanityCheckNode(g_nodeIp, g_nodePort);
             sanityCheckSeed(g_seed);
             makeOracleUserQueryTransaction(g_nodeIp, g_nodePort, g_seed, g_paramString1, g_paramString2, g_paramString3, g_offsetScheduledTick);
             break;
         case SEND_ORACLE_CONTRACT_TX:
+            sanityCheckCpuAvx2();
             sanityCheckNode(g_nodeIp, g_nodePort);
             sanityCheckSeed(g_seed);
             makePriceOracleContractTransaction(g_nodeIp, g_nodePort, g_seed, g_paramString1, g_contractIndex, g_paramString2, g_paramString3, g_offsetScheduledTick);
@@ -545,7 +578,8 @@ int run(int argc, char* argv[])
         case QUTIL_GET_BALANCES_MANY:
             sanityCheckNode(g_nodeIp, g_nodePort);
             sanityFileExist(g_qutil_getBalancesManyFile);
-            qutilGetBalancesMany(g_nodeIp, g_nodePort, g_qutil_getBalancesManyFile);
+            if (!qutilGetBalancesMany(g_nodeIp, g_nodePort, g_qutil_getBalancesManyFile))
+                return 1;
             break;
         case QUTIL_TRANSFER_SHARES_TO_MANY_V1:
             sanityCheckNode(g_nodeIp, g_nodePort);
@@ -0,0 +1,103 @@
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _MSC_VER
+
+bool MappedFile::open(const char* fileName)
+{
+    close();
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    mFile = file;
+    if (size.QuadPart == 0)
+        return true;
+    mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mMapping)
+    {
+        close();
+        return false;
+    }
+    mData = (const uint8_t*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mData)
+    {
+        close();
+        return false;
+    }
+    mSize = size_t(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mData)
+        UnmapViewOfFile(mData);
+    if (mMapping)
+        CloseHandle(mMapping);
+    if (mFile)
+        CloseHandle(mFile);
+    mData = nullptr;
+    mMapping = nullptr;
+    mFile = nullptr;
+    mSize = 0;
+}
+
+#else
+
+bool MappedFile::open(const char* fileName)
+{
+    close();
+    int fd = ::open(fileName, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size > 0)
+    {
+        void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+        mData = (const uint8_t*)data;
+        mSize = size_t(st.st_size);
+    }
+    // the mapping stays valid without the descriptor
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mData)
+        munmap((void*)mData, mSize);
+    mData = nullptr;
+    mSize = 0;
+}
+
+#endif
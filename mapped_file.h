@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file. The data stays valid until the object is closed or destroyed.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map fileName. Return false if it cannot be opened. An empty file is mapped with data() == nullptr.
+    bool open(const char* fileName);
+    void close();
+
+    const uint8_t* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+#ifdef _MSC_VER
+    void* mFile = nullptr;
+    void* mMapping = nullptr;
+#endif
+};
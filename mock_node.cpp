@@ -0,0 +1,614 @@
+// qubic-mock-node: serves the part of the node protocol used by qubic-cli from local fixture data, so the client can
+// be tested and benchmarked without a live node. Run with -h for usage.
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#include <Winsock2.h>
+#include <Ws2tcpip.h>
+#define close(x) closesocket(x)
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "structs.h"
+#include "k12_and_key_utils.h"
+#include "key_utils.h"
+#include "logger.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+struct MockNodeConfig
+{
+    std::string bindAddress = "127.0.0.1";
+    int port = DEFAULT_NODE_PORT;
+    unsigned short epoch = 100;
+    unsigned int initialTick = 10000000;
+    unsigned int tickDurationMsec = 1000;
+    unsigned int latencyMsec = 0;            // delay before each response
+    unsigned long long bandwidth = 0;        // bytes per second, 0 = unlimited
+    unsigned int splitBytes = 0;             // maximum bytes per send(), 0 = whole response at once
+    bool requestComputors = false;           // send RequestComputors after ExchangePublicPeers
+};
+
+// Tick data and its transactions (each including input and signature), as written by qubic-cli -gettickdata
+struct TickFixture
+{
+    TickData tickData;
+    std::vector<std::vector<uint8_t>> transactions;
+};
+
+static MockNodeConfig config;
+static std::chrono::steady_clock::time_point startTime;
+
+// fixture data, extended by broadcast transactions
+static std::mutex stateMutex;
+static std::map<unsigned int, std::unique_ptr<TickFixture>> ticks;
+static std::map<std::string, Entity> entities; // by public key
+static std::map<std::pair<unsigned int, unsigned short>, std::vector<uint8_t>> functionOutputs; // by contract, input type
+static std::vector<AssetRecord> assets;
+
+static void printUsage()
+{
+    printf("./qubic-mock-node [options]\n");
+    printf("\t-bind <IP>\n\t\tAddress to listen on, 0.0.0.0 for all interfaces (default: 127.0.0.1)\n");
+    printf("\t-port <PORT>\n\t\tPort to listen on (default: %d)\n", DEFAULT_NODE_PORT);
+    printf("\t-epoch <EPOCH>\n\t\tEpoch reported by the node (default: 100)\n");
+    printf("\t-tick <TICK>\n\t\tTick reported at start (default: 10000000)\n");
+    printf("\t-tickduration <MILLISECONDS>\n\t\tTime until the tick advances (default: 1000, 0 = never)\n");
+    printf("\t-tickdata <FILE>\n\t\tServe tick data and transactions from a file written by qubic-cli -gettickdata. May be repeated.\n");
+    printf("\t-entities <FILE>\n\t\tText file with lines <IDENTITY> <INCOMING_AMOUNT> <OUTGOING_AMOUNT> [<NUMBER_OF_INCOMING_TRANSFERS> <NUMBER_OF_OUTGOING_TRANSFERS>]\n");
+    printf("\t-functions <FILE>\n\t\tText file with lines <CONTRACT_INDEX> <INPUT_TYPE> <OUTPUT_IN_HEX>. Other functions respond with empty output (failure).\n");
+    printf("\t-assets <FILE>\n\t\tBinary file of AssetRecord structs (48 bytes each) served to RequestAssets\n");
+    printf("\t-latency <MILLISECONDS>\n\t\tDelay before each response (default: 0)\n");
+    printf("\t-bandwidth <BYTES_PER_SECOND>\n\t\tLimit the send rate (default: unlimited)\n");
+    printf("\t-split <BYTES>\n\t\tSend responses in pieces of at most BYTES bytes to exercise reassembly (default: no splitting)\n");
+    printf("\t-requestcomputors\n\t\tSend the optional RequestComputors after ExchangePublicPeers like a node without computor list\n");
+}
+
+static unsigned int currentTick()
+{
+    if (config.tickDurationMsec == 0)
+        return config.initialTick;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    return config.initialTick + (unsigned int)(elapsed.count() / config.tickDurationMsec);
+}
+
+static bool loadTickData(const char* fileName)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (f == nullptr)
+    {
+        LOG("Failed to open %s\n", fileName);
+        return false;
+    }
+    auto fixture = std::make_unique<TickFixture>();
+    if (fread(&fixture->tickData, 1, sizeof(TickData), f) != sizeof(TickData))
+    {
+        LOG("Failed to read TickData from %s\n", fileName);
+        fclose(f);
+        return false;
+    }
+    while (true)
+    {
+        Transaction tx;
+        if (fread(&tx, 1, sizeof(Transaction), f) != sizeof(Transaction))
+            break;
+        if (tx.inputSize > MAX_INPUT_SIZE)
+        {
+            LOG("Invalid transaction in %s\n", fileName);
+            break;
+        }
+        std::vector<uint8_t> data(sizeof(Transaction) + tx.inputSize + SIGNATURE_SIZE);
+        memcpy(data.data(), &tx, sizeof(Transaction));
+        if (fread(data.data() + sizeof(Transaction), 1, tx.inputSize + SIGNATURE_SIZE, f) != tx.inputSize + SIGNATURE_SIZE)
+        {
+            LOG("Truncated transaction in %s\n", fileName);
+            break;
+        }
+        fixture->transactions.push_back(std::move(data));
+    }
+    fclose(f);
+    LOG("Loaded tick %u with %zu transactions from %s\n", fixture->tickData.tick, fixture->transactions.size(), fileName);
+    unsigned int tick = fixture->tickData.tick;
+    ticks[tick] = std::move(fixture);
+    return true;
+}
+
+static bool loadEntities(const char* fileName)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        LOG("Failed to open %s\n", fileName);
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream ss(line);
+        std::string identity;
+        Entity entity;
+        memset(&entity, 0, sizeof(Entity));
+        if (!(ss >> identity) || identity[0] == '#')
+            continue;
+        if (identity.size() < 56 || !(ss >> entity.incomingAmount >> entity.outgoingAmount))
+        {
+            LOG("Invalid entity line: %s\n", line.c_str());
+            return false;
+        }
+        ss >> entity.numberOfIncomingTransfers >> entity.numberOfOutgoingTransfers;
+        getPublicKeyFromIdentity(identity.c_str(), entity.publicKey);
+        entities[std::string((const char*)entity.publicKey, 32)] = entity;
+    }
+    LOG("Loaded %zu entities from %s\n", entities.size(), fileName);
+    return true;
+}
+
+static bool loadFunctionOutputs(const char* fileName)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        LOG("Failed to open %s\n", fileName);
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream ss(line);
+        unsigned int contractIndex, inputType;
+        std::string hex;
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (!(ss >> contractIndex >> inputType >> hex) || hex.size() % 2 != 0)
+        {
+            LOG("Invalid function line: %s\n", line.c_str());
+            return false;
+        }
+        std::vector<uint8_t> output(hex.size() / 2);
+        hexToByte(hex.c_str(), output.data(), int(output.size()));
+        functionOutputs[{ contractIndex, (unsigned short)inputType }] = output;
+    }
+    LOG("Loaded %zu function outputs from %s\n", functionOutputs.size(), fileName);
+    return true;
+}
+
+static bool loadAssets(const char* fileName)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (f == nullptr)
+    {
+        LOG("Failed to open %s\n", fileName);
+        return false;
+    }
+    AssetRecord record;
+    while (fread(&record, 1, sizeof(AssetRecord), f) == sizeof(AssetRecord))
+        assets.push_back(record);
+    fclose(f);
+    LOG("Loaded %zu asset records from %s\n", assets.size(), fileName);
+    return true;
+}
+
+// Append packet with header to out.
+static void appendPacket(std::vector<uint8_t>& out, uint8_t type, unsigned int dejavu, const void* payload, size_t size)
+{
+    RequestResponseHeader header;
+    header.setSize((unsigned int)(sizeof(RequestResponseHeader) + size));
+    header.setType(type);
+    header.setDejavu(dejavu);
+    out.insert(out.end(), (const uint8_t*)&header, (const uint8_t*)&header + sizeof(RequestResponseHeader));
+    if (size)
+        out.insert(out.end(), (const uint8_t*)payload, (const uint8_t*)payload + size);
+}
+
+static bool sendShaped(int socket, const std::vector<uint8_t>& data)
+{
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        size_t chunkSize = data.size() - offset;
+        if (config.splitBytes && chunkSize > config.splitBytes)
+            chunkSize = config.splitBytes;
+        if (config.bandwidth)
+        {
+            // at most 10 ms worth of data at once
+            size_t maxChunkSize = (config.bandwidth >= 100) ? size_t(config.bandwidth / 100) : 1;
+            if (chunkSize > maxChunkSize)
+                chunkSize = maxChunkSize;
+        }
+        auto chunkStart = std::chrono::steady_clock::now();
+        size_t sent = 0;
+        while (sent < chunkSize)
+        {
+            // a client that disconnected before its responses have been sent must not terminate the mock
+            int n = send(socket, (const char*)data.data() + offset + sent, int(chunkSize - sent), MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            sent += n;
+        }
+        offset += chunkSize;
+        if (config.bandwidth)
+        {
+            auto chunkTime = std::chrono::microseconds(chunkSize * 1000000ULL / config.bandwidth);
+            std::this_thread::sleep_until(chunkStart + chunkTime);
+        }
+        else if (config.splitBytes && offset < data.size())
+        {
+            // give the pieces a chance to arrive separately
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    return true;
+}
+
+static void respondEntity(const RequestedEntity& request, unsigned int dejavu, std::vector<uint8_t>& out)
+{
+    RespondedEntity response;
+    memset(&response, 0, sizeof(RespondedEntity));
+    memcpy(response.entity.publicKey, request.publicKey, 32);
+    response.spectrumIndex = -1;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        auto it = entities.find(std::string((const char*)request.publicKey, 32));
+        if (it != entities.end())
+        {
+            response.entity = it->second;
+            response.spectrumIndex = int(std::distance(entities.begin(), it));
+        }
+    }
+    response.tick = currentTick();
+    appendPacket(out, RESPOND_ENTITY, dejavu, &response, sizeof(RespondedEntity));
+}
+
+static void respondTickData(const RequestTickData& request, unsigned int dejavu, std::vector<uint8_t>& out)
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto it = ticks.find(request.requestedTickData.tick);
+    if (it != ticks.end())
+        appendPacket(out, BROADCAST_FUTURE_TICK_DATA, dejavu, &it->second->tickData, sizeof(TickData));
+    else
+        appendPacket(out, END_RESPOND, dejavu, nullptr, 0);
+}
+
+static void respondTickTransactions(const RequestedTickTransactions& request, unsigned int dejavu, std::vector<uint8_t>& out)
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        auto it = ticks.find(request.tick);
+        if (it != ticks.end())
+        {
+            const auto& transactions = it->second->transactions;
+            for (size_t i = 0; i < transactions.size() && i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
+            {
+                // a set flag means the client already has the transaction
+                if (!(request.transactionFlags[i >> 3] & (1 << (i & 7))))
+                    appendPacket(out, BROADCAST_TRANSACTION, dejavu, transactions[i].data(), transactions[i].size());
+            }
+        }
+    }
+    appendPacket(out, END_RESPOND, dejavu, nullptr, 0);
+}
+
+static void respondContractFunction(const uint8_t* payload, size_t size, unsigned int dejavu, std::vector<uint8_t>& out)
+{
+    const std::vector<uint8_t>* output = nullptr;
+    if (size >= sizeof(RequestContractFunction))
+    {
+        auto request = (const RequestContractFunction*)payload;
+        std::lock_guard<std::mutex> lock(stateMutex);
+        auto it = functionOutputs.find({ request->contractIndex, request->inputType });
+        if (it != functionOutputs.end())
+            output = &it->second;
+    }
+    // empty output means the invocation failed
+    appendPacket(out, RespondContractFunction::type(), dejavu, output ? output->data() : nullptr, output ? output->size() : 0);
+}
+
+static void respondAssets(const RequestAssets& request, unsigned int dejavu, std::vector<uint8_t>& out)
+{
+    const bool withSiblings = (request.byFilter.flags & RequestAssets::getSiblings) != 0;
+    auto append = [&](const AssetRecord& record, unsigned int universeIndex)
+    {
+        RespondAssetsWithSiblings response;
+        memset(&response, 0, sizeof(response));
+        response.asset = record;
+        response.tick = currentTick();
+        response.universeIndex = universeIndex;
+        appendPacket(out, RespondAssets::type(), dejavu, &response,
+                     withSiblings ? sizeof(RespondAssetsWithSiblings) : sizeof(RespondAssets));
+    };
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (request.assetReqType == RequestAssets::requestByUniverseIdx)
+    {
+        if (request.byUniverseIdx.universeIdx < assets.size())
+            append(assets[request.byUniverseIdx.universeIdx], request.byUniverseIdx.universeIdx);
+    }
+    else
+    {
+        unsigned char recordType = ISSUANCE;
+        const unsigned char* publicKey = nullptr;
+        if (request.assetReqType == RequestAssets::requestIssuanceRecords)
+        {
+            if (!(request.byFilter.flags & RequestAssets::anyIssuer))
+                publicKey = request.byFilter.issuer;
+        }
+        else if (request.assetReqType == RequestAssets::requestOwnershipRecords)
+        {
+            recordType = OWNERSHIP;
+            if (!(request.byFilter.flags & RequestAssets::anyOwner))
+                publicKey = request.byFilter.owner;
+        }
+        else
+        {
+            recordType = POSSESSION;
+            if (!(request.byFilter.flags & RequestAssets::anyPossessor))
+                publicKey = request.byFilter.possessor;
+        }
+        for (size_t i = 0; i < assets.size(); i++)
+        {
+            const auto& record = assets[i].varStruct.issuance;
+            if (record.type == recordType && (!publicKey || memcmp(record.publicKey, publicKey, 32) == 0))
+                append(assets[i], (unsigned int)i);
+        }
+    }
+    appendPacket(out, END_RESPOND, dejavu, nullptr, 0);
+}
+
+static void addBroadcastTransaction(const uint8_t* payload, size_t size)
+{
+    if (size < sizeof(Transaction))
+        return;
+    auto tx = (const Transaction*)payload;
+    if (size != sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE)
+        return;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto& fixture = ticks[tx->tick];
+    if (!fixture)
+    {
+        fixture = std::make_unique<TickFixture>();
+        memset(&fixture->tickData, 0, sizeof(TickData));
+        fixture->tickData.epoch = config.epoch;
+        fixture->tickData.tick = tx->tick;
+    }
+    if (fixture->transactions.size() >= NUMBER_OF_TRANSACTIONS_PER_TICK)
+        return;
+    // tick data lists the digest of the transaction, so it can be checked with -checktxontick
+    KangarooTwelve(payload, (unsigned int)size, fixture->tickData.transactionDigests[fixture->transactions.size()], 32);
+    fixture->transactions.emplace_back(payload, payload + size);
+}
+
+// Build the response to one request packet. Return false if nothing is sent back.
+static bool handleRequest(const RequestResponseHeader& header, const uint8_t* payload, size_t size, std::vector<uint8_t>& out)
+{
+    const unsigned int dejavu = header.dejavu();
+    switch (header.type())
+    {
+    case REQUEST_CURRENT_TICK_INFO:
+    {
+        CurrentTickInfo info;
+        memset(&info, 0, sizeof(CurrentTickInfo));
+        info.tickDuration = (unsigned short)config.tickDurationMsec;
+        info.epoch = config.epoch;
+        info.tick = currentTick();
+        info.numberOfAlignedVotes = NUMBER_OF_COMPUTORS * 2 / 3 + 1;
+        info.initialTick = config.initialTick;
+        appendPacket(out, RESPOND_CURRENT_TICK_INFO, dejavu, &info, sizeof(CurrentTickInfo));
+        return true;
+    }
+    case REQUEST_ENTITY:
+        if (size < sizeof(RequestedEntity))
+            return false;
+        respondEntity(*(const RequestedEntity*)payload, dejavu, out);
+        return true;
+    case REQUEST_TICK_DATA:
+        if (size < sizeof(RequestTickData))
+            return false;
+        respondTickData(*(const RequestTickData*)payload, dejavu, out);
+        return true;
+    case REQUEST_TICK_TRANSACTIONS:
+        if (size < sizeof(RequestedTickTransactions))
+            return false;
+        respondTickTransactions(*(const RequestedTickTransactions*)payload, dejavu, out);
+        return true;
+    case RequestedQuorumTick::type:
+        // the mock has no votes
+        appendPacket(out, END_RESPOND, dejavu, nullptr, 0);
+        return true;
+    case RequestContractFunction::type():
+        respondContractFunction(payload, size, dejavu, out);
+        return true;
+    case RequestAssets::type():
+        if (size < sizeof(RequestAssets))
+            return false;
+        respondAssets(*(const RequestAssets*)payload, dejavu, out);
+        return true;
+    case BROADCAST_TRANSACTION:
+        addBroadcastTransaction(payload, size);
+        return false;
+    default:
+        // like a node, ignore what isn't supported
+        return false;
+    }
+}
+
+static void serveConnection(int socket)
+{
+    int noDelay = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+    std::vector<uint8_t> out;
+    ExchangePublicPeers peers;
+    memset(&peers, 0, sizeof(ExchangePublicPeers));
+    appendPacket(out, EXCHANGE_PUBLIC_PEERS, 0, &peers, sizeof(ExchangePublicPeers));
+    if (config.requestComputors)
+        appendPacket(out, REQUEST_COMPUTORS, 0, nullptr, 0);
+    if (!sendShaped(socket, out))
+    {
+        close(socket);
+        return;
+    }
+
+    std::vector<uint8_t> payload;
+    while (true)
+    {
+        RequestResponseHeader header;
+        size_t received = 0;
+        while (received < sizeof(RequestResponseHeader))
+        {
+            int n = recv(socket, (char*)&header + received, int(sizeof(RequestResponseHeader) - received), 0);
+            if (n <= 0)
+            {
+                close(socket);
+                return;
+            }
+            received += n;
+        }
+        if (header.size() < sizeof(RequestResponseHeader) || header.size() > 0xFFFFFF)
+        {
+            LOG("Received invalid packet, closing connection\n");
+            break;
+        }
+        payload.resize(header.size() - sizeof(RequestResponseHeader));
+        received = 0;
+        while (received < payload.size())
+        {
+            int n = recv(socket, (char*)payload.data() + received, int(payload.size() - received), 0);
+            if (n <= 0)
+            {
+                close(socket);
+                return;
+            }
+            received += n;
+        }
+
+        out.clear();
+        if (!handleRequest(header, payload.data(), payload.size(), out))
+            continue;
+        if (config.latencyMsec)
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.latencyMsec));
+        if (!sendShaped(socket, out))
+            break;
+    }
+    close(socket);
+}
+
+static bool parseArguments(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-requestcomputors")
+        {
+            config.requestComputors = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        const char* value = argv[++i];
+        if (arg == "-bind")
+            config.bindAddress = value;
+        else if (arg == "-port")
+            config.port = atoi(value);
+        else if (arg == "-epoch")
+            config.epoch = (unsigned short)atoi(value);
+        else if (arg == "-tick")
+            config.initialTick = (unsigned int)strtoul(value, nullptr, 10);
+        else if (arg == "-tickduration")
+            config.tickDurationMsec = (unsigned int)strtoul(value, nullptr, 10);
+        else if (arg == "-latency")
+            config.latencyMsec = (unsigned int)strtoul(value, nullptr, 10);
+        else if (arg == "-bandwidth")
+            config.bandwidth = strtoull(value, nullptr, 10);
+        else if (arg == "-split")
+            config.splitBytes = (unsigned int)strtoul(value, nullptr, 10);
+        else if (arg == "-tickdata")
+        {
+            if (!loadTickData(value))
+                return false;
+        }
+        else if (arg == "-entities")
+        {
+            if (!loadEntities(value))
+                return false;
+        }
+        else if (arg == "-functions")
+        {
+            if (!loadFunctionOutputs(value))
+                return false;
+        }
+        else if (arg == "-assets")
+        {
+            if (!loadAssets(value))
+                return false;
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "-help") == 0))
+    {
+        printUsage();
+        return 0;
+    }
+    if (!parseArguments(argc, argv))
+    {
+        printUsage();
+        return 1;
+    }
+
+#ifdef _MSC_VER
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 0), &wsaData);
+#endif
+    int listenSocket = int(socket(AF_INET, SOCK_STREAM, 0));
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, config.bindAddress.c_str(), &addr.sin_addr) <= 0)
+    {
+        LOG("Invalid bind address %s\n", config.bindAddress.c_str());
+        return 1;
+    }
+    if (bind(listenSocket, (const sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenSocket, 128) < 0)
+    {
+        LOG("Failed to listen on %s:%d\n", config.bindAddress.c_str(), config.port);
+        return 1;
+    }
+    startTime = std::chrono::steady_clock::now();
+    LOG("Mock node listening on %s:%d (epoch %u, tick %u)\n", config.bindAddress.c_str(), config.port, config.epoch,
+        config.initialTick);
+
+    while (true)
+    {
+        int socket = int(accept(listenSocket, nullptr, nullptr));
+        if (socket < 0)
+            continue;
+        std::thread(serveConnection, socket).detach();
+    }
+}
@@ -189,8 +189,6 @@ void msvaultRegisterVault(const char* nodeIp, int nodePort, const char* seed,
 
     auto qc = make_qc(nodeIp, nodePort);
     if (!qc) { LOG("Failed to connect to node.\n"); return; }
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -199,9 +197,8 @@ void msvaultRegisterVault(const char* nodeIp, int nodePort, const char* seed,
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*)destPublicKey)[0] = MSVAULT_CONTRACT_INDEX;
@@ -221,7 +218,7 @@ void msvaultRegisterVault(const char* nodeIp, int nodePort, const char* seed,
     packet.transaction.inputSize = sizeof(input);
     memcpy(&packet.inputData, &input, sizeof(input));
     KangarooTwelve((uint8_t*)&packet.transaction, sizeof(packet.transaction) + sizeof(input), digest, 32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -247,8 +244,6 @@ void msvaultDeposit(const char* nodeIp, int nodePort, const char* seed,
         LOG("Failed to connect to node.\n");
         return;
     }
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -257,9 +252,8 @@ void msvaultDeposit(const char* nodeIp, int nodePort, const char* seed,
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*)destPublicKey)[0] = MSVAULT_CONTRACT_INDEX;
@@ -283,7 +277,7 @@ void msvaultDeposit(const char* nodeIp, int nodePort, const char* seed,
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -320,8 +314,6 @@ void msvaultReleaseTo(const char* nodeIp, int nodePort, const char* seed,
         LOG("Failed to connect to node.\n");
         return;
     }
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -330,9 +322,8 @@ void msvaultReleaseTo(const char* nodeIp, int nodePort, const char* seed,
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*)destPublicKey)[0] = MSVAULT_CONTRACT_INDEX;
@@ -356,7 +347,7 @@ void msvaultReleaseTo(const char* nodeIp, int nodePort, const char* seed,
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -384,8 +375,6 @@ void msvaultResetRelease(const char* nodeIp, int nodePort, const char* seed,
         LOG("Failed to connect to node.\n");
         return;
     }
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -394,9 +383,8 @@ void msvaultResetRelease(const char* nodeIp, int nodePort, const char* seed,
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*)destPublicKey)[0] = MSVAULT_CONTRACT_INDEX;
@@ -420,7 +408,7 @@ void msvaultResetRelease(const char* nodeIp, int nodePort, const char* seed,
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -774,13 +762,10 @@ void msvaultDepositAsset(const char* nodeIp, int nodePort, const char* seed,
     memset(&input, 0, sizeof(input));
     input.vaultID = vaultID;
     input.amount = amount;
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     getPublicKeyFromIdentity(issuer, input.asset.issuer);
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     input.asset.assetName = assetNameFromString(assetName);
 
     uint8_t destPublicKey[32] = { 0 };
@@ -811,7 +796,7 @@ void msvaultDepositAsset(const char* nodeIp, int nodePort, const char* seed,
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -843,14 +828,11 @@ void msvaultReleaseAssetTo(const char* nodeIp, int nodePort, const char* seed,
     memset(&input, 0, sizeof(input));
     input.vaultID = vaultID;
     input.amount = amount;
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     getPublicKeyFromIdentity(issuer, input.asset.issuer);
     input.asset.assetName = assetNameFromString(assetName);
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(destination, input.destination);
 
     uint8_t destPublicKey[32] = { 0 };
@@ -880,7 +862,7 @@ void msvaultReleaseAssetTo(const char* nodeIp, int nodePort, const char* seed,
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -909,16 +891,13 @@ void msvaultResetAssetRelease(const char* nodeIp, int nodePort, const char* seed
     MsVaultResetAssetRelease_input input;
     input.vaultID = vaultID;
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
     uint8_t signature[64];
     char txHash[128] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     memset(destPublicKey, 0, 32);
     ((uint64_t*)destPublicKey)[0] = MSVAULT_CONTRACT_INDEX;
 
@@ -943,7 +922,7 @@ void msvaultResetAssetRelease(const char* nodeIp, int nodePort, const char* seed
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -1157,12 +1136,9 @@ void msvaultRevokeAssetManagementRights(const char* nodeIp, int nodePort, const
     input.asset.assetName = assetNameFromString(assetName);
     getPublicKeyFromIdentity(issuer, input.asset.issuer);
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -1193,7 +1169,7 @@ void msvaultRevokeAssetManagementRights(const char* nodeIp, int nodePort, const
                    sizeof(packet.transaction) + sizeof(input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
 
     packet.header.setSize(sizeof(packet));
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include "node_rtt.h"
+
+static std::mutex rttMutex;
+static std::map<std::string, NodeRtt> nodeRtts; // by ip:port
+
+static std::string nodeKey(const char* nodeIp, int nodePort)
+{
+    return std::string(nodeIp) + ":" + std::to_string(nodePort);
+}
+
+static unsigned long timeoutFromEstimate(double srtt, double rttvar)
+{
+    // RFC 6298: RTO = SRTT + max(G, 4 * RTTVAR) with clock granularity G of 1 ms
+    double timeout = srtt + std::max(1.0, 4.0 * rttvar);
+    timeout = std::min(std::max(timeout, double(MIN_ADAPTIVE_TIMEOUT_MSEC)), double(MAX_ADAPTIVE_TIMEOUT_MSEC));
+    return (unsigned long)std::ceil(timeout);
+}
+
+void recordNodeRtt(const char* nodeIp, int nodePort, double rttMillisec, bool isResponse)
+{
+    if (rttMillisec < 0)
+        return;
+    std::lock_guard<std::mutex> lock(rttMutex);
+    NodeRtt& rtt = nodeRtts[nodeKey(nodeIp, nodePort)];
+    if (rtt.samples == 0)
+    {
+        rtt.ip = nodeIp;
+        rtt.port = nodePort;
+        rtt.srttMillisec = rttMillisec;
+        rtt.rttvarMillisec = rttMillisec / 2;
+    }
+    else
+    {
+        // alpha = 1/8, beta = 1/4
+        rtt.rttvarMillisec = 0.75 * rtt.rttvarMillisec + 0.25 * std::fabs(rtt.srttMillisec - rttMillisec);
+        rtt.srttMillisec = 0.875 * rtt.srttMillisec + 0.125 * rttMillisec;
+    }
+    rtt.timeoutMillisec = timeoutFromEstimate(rtt.srttMillisec, rtt.rttvarMillisec);
+    rtt.samples++;
+    if (isResponse)
+        rtt.responseSamples++;
+}
+
+bool getNodeRtt(const char* nodeIp, int nodePort, NodeRtt& rtt)
+{
+    std::lock_guard<std::mutex> lock(rttMutex);
+    auto it = nodeRtts.find(nodeKey(nodeIp, nodePort));
+    if (it == nodeRtts.end())
+        return false;
+    rtt = it->second;
+    return true;
+}
+
+std::vector<NodeRtt> getAllNodeRtts()
+{
+    std::vector<NodeRtt> result;
+    {
+        std::lock_guard<std::mutex> lock(rttMutex);
+        for (const auto& entry : nodeRtts)
+            result.push_back(entry.second);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const NodeRtt& a, const NodeRtt& b) { return a.srttMillisec < b.srttMillisec; });
+    return result;
+}
+
+unsigned long getNodeTimeoutMsec(const char* nodeIp, int nodePort, unsigned long fallbackMillisec)
+{
+    NodeRtt rtt;
+    if (!getNodeRtt(nodeIp, nodePort, rtt))
+        return fallbackMillisec;
+    // a few samples (or only that of connecting) don't show how long the node takes to answer
+    if (rtt.responseSamples < MIN_ADAPTIVE_TIMEOUT_SAMPLES)
+        return std::max(rtt.timeoutMillisec, fallbackMillisec);
+    return rtt.timeoutMillisec;
+}
+
+unsigned long getNodeRetryDelayMsec(const char* nodeIp, int nodePort, int attempt)
+{
+    NodeRtt rtt;
+    unsigned long delay = MIN_RETRY_DELAY_MSEC;
+    if (getNodeRtt(nodeIp, nodePort, rtt))
+        delay = std::max(delay, (unsigned long)std::ceil(rtt.srttMillisec + 4.0 * rtt.rttvarMillisec));
+    for (int i = 1; i < attempt && delay < MAX_ADAPTIVE_TIMEOUT_MSEC; i++)
+        delay *= 2;
+    return std::min(delay, (unsigned long)MAX_ADAPTIVE_TIMEOUT_MSEC);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "connection.h"
+
+// Bounds of the timeout derived from the measured round-trip time. It only grows beyond the fixed default for slow
+// nodes: some responses take the node long to compute, and some reads end on the timeout.
+#define MIN_ADAPTIVE_TIMEOUT_MSEC DEFAULT_TIMEOUT_MSEC
+#define MAX_ADAPTIVE_TIMEOUT_MSEC 10000
+// responses needed before the timeout may drop below the caller's fallback
+#define MIN_ADAPTIVE_TIMEOUT_SAMPLES 8
+// shortest delay before a retry
+#define MIN_RETRY_DELAY_MSEC 250
+
+// Round-trip time estimate of a node, computed like the TCP retransmission timer (RFC 6298)
+struct NodeRtt
+{
+    std::string ip;
+    int port = 0;
+    double srttMillisec = 0;   // smoothed round-trip time
+    double rttvarMillisec = 0; // round-trip time variation
+    unsigned long timeoutMillisec = 0; // SRTT + 4 * RTTVAR, clamped to the adaptive timeout bounds
+    unsigned int samples = 0;
+    unsigned int responseSamples = 0; // samples of requests, not of connecting
+};
+
+// Add a round-trip time sample of the node: the time from sending a request to the first bytes of its response, or
+// with isResponse = false from starting to connect to the connection being established. Thread safe.
+void recordNodeRtt(const char* nodeIp, int nodePort, double rttMillisec, bool isResponse = true);
+
+// Get the estimate of the node. Return false if no sample has been recorded yet.
+bool getNodeRtt(const char* nodeIp, int nodePort, NodeRtt& rtt);
+
+// Get the estimates of all nodes that have samples, fastest first.
+std::vector<NodeRtt> getAllNodeRtts();
+
+// Time to wait for the response of the node. Not less than fallbackMillisec until MIN_ADAPTIVE_TIMEOUT_SAMPLES
+// responses have been measured.
+unsigned long getNodeTimeoutMsec(const char* nodeIp, int nodePort, unsigned long fallbackMillisec = DEFAULT_TIMEOUT_MSEC);
+
+// Delay before retrying a failed request to the node, doubled with every attempt (1, 2, ...) like the TCP
+// retransmission backoff.
+unsigned long getNodeRetryDelayMsec(const char* nodeIp, int nodePort, int attempt);
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "node_set.h"
+#include "event_loop.h"
+#include "logger.h"
+#include "node_rtt.h"
+
+// number of latency samples kept per node
+#define NODE_LATENCY_SAMPLES 64
+
+std::vector<NodeAddress> g_nodeSet;
+int g_hedgePercentile = 0;
+
+static std::atomic<uint32_t> highestTick(0);
+
+// Connections and statistics are shared by all node set requests of the process.
+static std::mutex nodeStatsMutex;
+static std::map<std::string, std::vector<double>> nodeLatencies; // by ip:port, most recent last
+static std::map<std::string, AsyncQCPtr> nodeConnections; // by ip:port
+
+static std::string nodeKey(const NodeAddress& node)
+{
+    return node.ip + ":" + std::to_string(node.port);
+}
+
+static QubicEventLoop& nodeSetLoop()
+{
+    static QubicEventLoop loop;
+    return loop;
+}
+
+static AsyncQCPtr nodeConnection(const NodeAddress& node)
+{
+    std::lock_guard<std::mutex> lock(nodeStatsMutex);
+    AsyncQCPtr& conn = nodeConnections[nodeKey(node)];
+    if (!conn)
+    {
+        conn = nodeSetLoop().connect(node.ip.c_str(), node.port);
+        // responses are routed by dejavu, so a late response doesn't block the next request
+        conn->setMaxInFlight(DEFAULT_PIPELINE_DEPTH);
+    }
+    return conn;
+}
+
+static void addLatencySample(const NodeAddress& node, double millisec)
+{
+    std::lock_guard<std::mutex> lock(nodeStatsMutex);
+    auto& samples = nodeLatencies[nodeKey(node)];
+    if (samples.size() >= NODE_LATENCY_SAMPLES)
+        samples.erase(samples.begin());
+    samples.push_back(millisec);
+    // requests of a node set are pipelined, so the event loop doesn't sample them
+    recordNodeRtt(node.ip.c_str(), node.port, millisec);
+}
+
+// Return the given percentile of the node's latency, or DEFAULT_HEDGE_DELAY_MSEC if too few samples are known.
+static double latencyPercentile(const NodeAddress& node, int percentile)
+{
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(nodeStatsMutex);
+        auto it = nodeLatencies.find(nodeKey(node));
+        if (it != nodeLatencies.end())
+            samples = it->second;
+    }
+    if (samples.size() < 4)
+        return DEFAULT_HEDGE_DELAY_MSEC;
+    std::sort(samples.begin(), samples.end());
+    size_t index = (samples.size() - 1) * size_t(percentile) / 100;
+    return samples[index];
+}
+
+bool parseNodeSet(const char* list, int defaultPort, std::vector<NodeAddress>& nodes)
+{
+    nodes.clear();
+    std::stringstream ss(list);
+    std::string entry;
+    while (std::getline(ss, entry, ','))
+    {
+        entry.erase(std::remove_if(entry.begin(), entry.end(), ::isspace), entry.end());
+        if (entry.empty())
+            continue;
+        NodeAddress node;
+        node.port = defaultPort;
+        size_t colon = entry.find(':');
+        node.ip = entry.substr(0, colon);
+        if (colon != std::string::npos)
+        {
+            char* end = nullptr;
+            long port = strtol(entry.c_str() + colon + 1, &end, 10);
+            if (*end != 0 || port <= 0 || port > 65535)
+                return false;
+            node.port = int(port);
+        }
+        if (node.ip.empty() || node.ip.size() >= 32)
+            return false;
+        nodes.push_back(node);
+    }
+    return !nodes.empty();
+}
+
+bool checkNodeSetTick(uint32_t tick)
+{
+    uint32_t highest = highestTick.load();
+    while (tick > highest && !highestTick.compare_exchange_weak(highest, tick)) {}
+    return uint64_t(tick) + MAX_NODE_SET_TICK_LAG >= uint64_t(highestTick.load());
+}
+
+namespace
+{
+// State of one nodeSetRequest(), shared with the handlers running on the event loop thread
+struct NodeSetRequestState
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    int started = 0;
+    int finished = 0;
+    bool done = false;
+    std::vector<uint8_t> payload;
+    int winner = -1;
+    // valid responses collected if they carry a tick, see nodeSetRequest()
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint32_t> ticks;
+    std::vector<int> nodes;
+};
+}
+
+bool nodeSetRequest(const void* packet, size_t size, uint8_t responseType, const ResponseValidator& isValid,
+                    std::vector<uint8_t>& payload, NodeAddress* winner, const ResponseTick& tickOf)
+{
+    const int numNodes = int(g_nodeSet.size());
+    if (numNodes == 0)
+        return false;
+
+    // fastest nodes first
+    std::vector<int> order(numNodes);
+    std::vector<double> delays(numNodes);
+    for (int i = 0; i < numNodes; i++)
+    {
+        order[i] = i;
+        delays[i] = latencyPercentile(g_nodeSet[i], (g_hedgePercentile) ? g_hedgePercentile : 50);
+    }
+    std::stable_sort(order.begin(), order.end(), [&delays](int a, int b) { return delays[a] < delays[b]; });
+
+    auto state = std::make_shared<NodeSetRequestState>();
+    ResponseValidator validator = isValid;
+    ResponseTick responseTick = tickOf;
+    const size_t quorum = std::min<size_t>(NODE_SET_TICK_QUORUM, numNodes);
+    auto startRequest = [&](int nodeIndex)
+    {
+        const NodeAddress node = g_nodeSet[nodeIndex];
+        std::vector<uint8_t> requestPacket((const uint8_t*)packet, (const uint8_t*)packet + size);
+        ((RequestResponseHeader*)requestPacket.data())->randomizeDejavu();
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->started++;
+        }
+        auto startTime = std::chrono::steady_clock::now();
+        nodeConnection(node)->request(std::move(requestPacket),
+            [state, validator, responseTick, quorum, responseType, nodeIndex, node, startTime](const RequestResponseHeader& header, const uint8_t* data)
+            {
+                if (header.type() == END_RESPOND)
+                    return true;
+                if (header.type() != responseType)
+                    return false;
+                std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - startTime;
+                addLatencySample(node, latency.count());
+                size_t dataSize = header.size() - sizeof(RequestResponseHeader);
+                // the validator also records ticks of late responses, so check before looking at the state
+                if (!validator || validator(data, dataSize))
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (state->done)
+                        return true;
+                    if (responseTick)
+                    {
+                        state->payloads.emplace_back(data, data + dataSize);
+                        state->ticks.push_back(responseTick(data, dataSize));
+                        state->nodes.push_back(nodeIndex);
+                        state->done = (state->ticks.size() >= quorum);
+                    }
+                    else
+                    {
+                        state->done = true;
+                        state->winner = nodeIndex;
+                        state->payload.assign(data, data + dataSize);
+                    }
+                }
+                return true;
+            },
+            [state](std::exception_ptr)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished++;
+                state->condition.notify_all();
+            });
+    };
+
+    int next = 0;
+    if (g_hedgePercentile == 0)
+    {
+        while (next < numNodes)
+            startRequest(order[next++]);
+    }
+    else
+    {
+        startRequest(order[next++]);
+    }
+    auto hedgeTime = std::chrono::steady_clock::now()
+        + std::chrono::microseconds((long long)(delays[order[0]] * 1000));
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    auto windowEnd = std::chrono::steady_clock::time_point::max();
+    while (!state->done)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (!state->ticks.empty() && windowEnd == std::chrono::steady_clock::time_point::max())
+        {
+            // the first node to answer may lag behind, so ask the next one right away
+            windowEnd = now + std::chrono::milliseconds(NODE_SET_TICK_WINDOW_MSEC);
+            hedgeTime = now;
+        }
+        if (now >= windowEnd)
+            break;
+        const bool allFinished = (state->finished == state->started);
+        if (next == numNodes)
+        {
+            // every node asked so far has given up
+            if (allFinished)
+                break;
+            if (windowEnd == std::chrono::steady_clock::time_point::max())
+                state->condition.wait(lock);
+            else
+                state->condition.wait_until(lock, windowEnd);
+            continue;
+        }
+        if (!allFinished && now < hedgeTime)
+        {
+            state->condition.wait_until(lock, std::min(hedgeTime, windowEnd));
+            continue;
+        }
+
+        // hedge: ask the next node
+        int nodeIndex = order[next++];
+        lock.unlock();
+        startRequest(nodeIndex);
+        hedgeTime = std::chrono::steady_clock::now()
+            + std::chrono::microseconds((long long)(delays[nodeIndex] * 1000));
+        lock.lock();
+    }
+
+    if (!state->ticks.empty())
+    {
+        // the collected response with the highest tick
+        size_t best = std::max_element(state->ticks.begin(), state->ticks.end()) - state->ticks.begin();
+        state->done = true;
+        state->winner = state->nodes[best];
+        state->payload = state->payloads[best];
+    }
+    if (!state->done)
+        return false;
+    payload = state->payload;
+    if (winner)
+        *winner = g_nodeSet[state->winner];
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// delay before sending a hedged request to the next node, as long as there are too few latency samples
+#define DEFAULT_HEDGE_DELAY_MSEC 100
+// responses carrying a tick that is more than this number of ticks behind the highest tick seen are stale
+#define MAX_NODE_SET_TICK_LAG 5
+// responses carrying a tick are collected until this many nodes answered (or all of them, if there are fewer) ...
+#define NODE_SET_TICK_QUORUM 2
+// ... or until this time after the first one, and the one with the highest tick is taken
+#define NODE_SET_TICK_WINDOW_MSEC 200
+
+struct NodeAddress
+{
+    std::string ip;
+    int port;
+};
+
+// Nodes given with -nodeset (empty if not used).
+extern std::vector<NodeAddress> g_nodeSet;
+// Latency percentile after which a request is sent to the next node of the set (-hedge). 0 means sending requests
+// to all nodes at once.
+extern int g_hedgePercentile;
+
+// Parse comma-separated list of IP[:PORT]. Return false if an entry is invalid.
+bool parseNodeSet(const char* list, int defaultPort, std::vector<NodeAddress>& nodes);
+
+// Check payload of a response. Return false to wait for another node instead.
+typedef std::function<bool(const uint8_t* payload, size_t size)> ResponseValidator;
+
+// Get the tick a response was made at.
+typedef std::function<uint32_t(const uint8_t* payload, size_t size)> ResponseTick;
+
+// Send packet (including its RequestResponseHeader) to the nodes of g_nodeSet and return the payload of the first
+// response of type responseType that isValid accepts. Nodes are tried in order of their latency, either all at once
+// or hedged (see g_hedgePercentile). A node answering END_RESPOND, an invalid response, or failing lets the next node
+// start right away. Return false if no node gave a valid response. winner is set to the node that answered.
+// If tickOf is given, the first node may lag behind, so the next node is asked right away and the valid responses
+// are collected until NODE_SET_TICK_QUORUM nodes answered or NODE_SET_TICK_WINDOW_MSEC passed. The response with the
+// highest tick is returned then.
+bool nodeSetRequest(const void* packet, size_t size, uint8_t responseType, const ResponseValidator& isValid,
+                    std::vector<uint8_t>& payload, NodeAddress* winner = nullptr, const ResponseTick& tickOf = nullptr);
+
+// Record tick from a node of the set. Return false if it is stale, that is more than MAX_NODE_SET_TICK_LAG ticks
+// behind the highest tick seen from the set.
+bool checkNodeSetTick(uint32_t tick);
+
+// Same as nodeSetRequest() with a response of type T. If tickOf is given, stale responses are rejected and the
+// response with the highest tick is taken.
+template <typename T>
+bool nodeSetRequestPacketAs(const void* packet, size_t size, T& result,
+                            std::function<bool(const T&)> isValid = nullptr,
+                            std::function<uint32_t(const T&)> tickOf = nullptr,
+                            NodeAddress* winner = nullptr)
+{
+    std::vector<uint8_t> payload;
+    bool ok = nodeSetRequest(packet, size, T::type(),
+        [isValid, tickOf](const uint8_t* data, size_t dataSize)
+        {
+            // run the checks on a zero-padded copy, so T can be used even if the node sent less
+            std::vector<uint8_t> buffer(sizeof(T), 0);
+            memcpy(buffer.data(), data, (dataSize < sizeof(T)) ? dataSize : sizeof(T));
+            const T& response = *(const T*)buffer.data();
+            if (tickOf && !checkNodeSetTick(tickOf(response)))
+                return false;
+            return !isValid || isValid(response);
+        },
+        payload, winner,
+        tickOf ? ResponseTick([tickOf](const uint8_t* data, size_t dataSize)
+            {
+                std::vector<uint8_t> buffer(sizeof(T), 0);
+                memcpy(buffer.data(), data, (dataSize < sizeof(T)) ? dataSize : sizeof(T));
+                return tickOf(*(const T*)buffer.data());
+            }) : ResponseTick());
+    if (ok)
+    {
+        memset(&result, 0, sizeof(T));
+        memcpy(&result, payload.data(), (payload.size() < sizeof(T)) ? payload.size() : sizeof(T));
+    }
+    return ok;
+}
@@ -1,3 +1,4 @@
+#include <array>
 #include <cstring>
 #include <vector>
 #include <cstdlib>
@@ -13,9 +14,15 @@
 #include "connection.h"
 #include "node_utils.h"
 #include "logger.h"
+#include "mapped_file.h"
+#include "node_rtt.h"
+#include "node_set.h"
+#include "tick_archive.h"
+#include "tick_download.h"
 #include "k12_and_key_utils.h"
 #include "key_utils.h"
 #include "wallet_utils.h"
+#include "verification_context.h"
 
 static CurrentTickInfo getTickInfoFromNode(QCPtr qc)
 {
@@ -52,10 +59,37 @@ uint32_t getTickNumberFromNode(QCPtr qc)
     return curTickInfo.tick;
 }
 
+// Get current tick info from the fastest node of g_nodeSet, rejecting nodes that lag behind.
+static CurrentTickInfo getTickInfoFromNodeSet()
+{
+    CurrentTickInfo result;
+    struct {
+        RequestResponseHeader header;
+    } packet;
+    packet.header.setSize(sizeof(packet));
+    packet.header.randomizeDejavu();
+    packet.header.setType(REQUEST_CURRENT_TICK_INFO);
+    if (!nodeSetRequestPacketAs<CurrentTickInfo>(&packet, packet.header.size(), result,
+            [](const CurrentTickInfo& info) { return info.epoch != 0; },
+            [](const CurrentTickInfo& info) { return info.tick; }))
+    {
+        memset(&result, 0, sizeof(CurrentTickInfo));
+    }
+    return result;
+}
+
 void printTickInfoFromNode(const char* nodeIp, int nodePort)
 {
-    auto qc = make_qc(nodeIp, nodePort);
-    auto curTickInfo = getTickInfoFromNode(qc);
+    CurrentTickInfo curTickInfo;
+    if (!g_nodeSet.empty())
+    {
+        curTickInfo = getTickInfoFromNodeSet();
+    }
+    else
+    {
+        auto qc = make_qc(nodeIp, nodePort);
+        curTickInfo = getTickInfoFromNode(qc);
+    }
     if (curTickInfo.epoch != 0)
     {
         LOG("Tick: %u\n", curTickInfo.tick);
@@ -70,6 +104,33 @@ void printTickInfoFromNode(const char* nodeIp, int nodePort)
     }
 }
 
+void printNodeLatency(const char* nodeIp, int nodePort, int numProbes)
+{
+    std::vector<NodeAddress> nodes = g_nodeSet;
+    if (nodes.empty())
+        nodes.push_back({ nodeIp, nodePort });
+    for (const auto& node : nodes)
+    {
+        try
+        {
+            // every request records a round-trip time sample of the node
+            auto qc = make_qc(node.ip.c_str(), node.port);
+            for (int i = 0; i < numProbes && !qc->isBroken(); i++)
+                getTickInfoFromNode(qc);
+        }
+        catch (std::logic_error)
+        {
+            LOG("Failed to connect to %s:%d\n", node.ip.c_str(), node.port);
+        }
+    }
+    LOG("Node\tSRTT (ms)\tRTTVAR (ms)\tTimeout (ms)\tSamples\n");
+    for (const auto& rtt : getAllNodeRtts())
+    {
+        LOG("%s:%d\t%.2f\t%.2f\t%lu\t%u\n", rtt.ip.c_str(), rtt.port, rtt.srttMillisec, rtt.rttvarMillisec,
+            rtt.timeoutMillisec, rtt.samples);
+    }
+}
+
 CurrentSystemInfo getSystemInfoFromNode(QCPtr qc)
 {
     CurrentSystemInfo result;
@@ -326,59 +387,72 @@ static void getTickTransactions(QCPtr qc, const uint32_t requestedTick, int nTx,
     for (int i = (nTx+7)/8; i < NUMBER_OF_TRANSACTIONS_PER_TICK/8; i++) packet->txs.transactionFlags[i] = 0xff;
     qc->sendData((uint8_t *) packet.get(), packet->header.size());
 
-    constexpr unsigned long long bufferSize = sizeof(RequestResponseHeader) + MAX_TRANSACTION_SIZE;
-    uint8_t buffer[bufferSize];
-    int recvByte = qc->receiveData(buffer, sizeof(RequestResponseHeader));
+    // the node sends the transactions it has, followed by END_RESPOND
     int recvTx = 0;
-    while (recvByte == sizeof(RequestResponseHeader))
+    // transactions to hash after receiving all of them, so they can be hashed in parallel
+    std::vector<uint8_t> rawTxs;
+    std::vector<unsigned int> rawTxSizes;
+    qc->receiveResponse([&](const RequestResponseHeader& header, const uint8_t* payload)
     {
-        auto header = (RequestResponseHeader*)buffer;
-        if (header->type() == BROADCAST_TRANSACTION)
+        if (header.type() != BROADCAST_TRANSACTION)
+            return false;
+        auto tx = (const Transaction*)payload;
+        size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+        if (payloadSize < sizeof(Transaction) || tx->inputSize > MAX_INPUT_SIZE
+            || payloadSize < sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE)
         {
-            recvByte = qc->receiveAllDataOrThrowException(buffer + sizeof(RequestResponseHeader), sizeof(Transaction));
-            auto tx = (Transaction*)(buffer + sizeof(RequestResponseHeader));
-            txs.push_back(*tx);
-            if (tx->inputSize > MAX_INPUT_SIZE)
-            {
-                LOG("Received tx with invalid inputSize!\n");
-                exit(1);
-            }
-            ++recvTx;
-            recvByte = qc->receiveAllDataOrThrowException(buffer + sizeof(RequestResponseHeader) + sizeof(Transaction), tx->inputSize + SIGNATURE_SIZE);
-            if (hashes != nullptr)
-            {
-                uint8_t digest[32] = { 0 };
-                KangarooTwelve(reinterpret_cast<const uint8_t*>(tx),
-                    sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE,
-                    digest,
-                    32);
-                TxhashStruct hash;
-                char txHash[128] = { 0 };
-                getTxHashFromDigest(digest, txHash);
-                memcpy(hash.hash, txHash, 60);
-                hashes->push_back(hash);
-            }
-            if (extraData != nullptr)
-            {
-                ExtraDataStruct ed;
-                ed.vecU8.resize(tx->inputSize);
-                if (tx->inputSize != 0)
-                {
-                    memcpy(ed.vecU8.data(), reinterpret_cast<const uint8_t*>(tx) + sizeof(Transaction), tx->inputSize);
-                }
-                extraData->push_back(ed);
-            }
-            if (sigs != nullptr)
+            LOG("Received tx with invalid inputSize!\n");
+            exit(1);
+        }
+        txs.push_back(*tx);
+        ++recvTx;
+        if (hashes != nullptr)
+        {
+            unsigned int rawTxSize = sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE;
+            rawTxs.insert(rawTxs.end(), payload, payload + rawTxSize);
+            rawTxSizes.push_back(rawTxSize);
+        }
+        if (extraData != nullptr)
+        {
+            ExtraDataStruct ed;
+            ed.vecU8.resize(tx->inputSize);
+            if (tx->inputSize != 0)
             {
-                SignatureStruct sig;
-                memcpy(sig.sig, reinterpret_cast<const uint8_t*>(tx) + sizeof(Transaction) + tx->inputSize, SIGNATURE_SIZE);
-                sigs->push_back(sig);
+                memcpy(ed.vecU8.data(), payload + sizeof(Transaction), tx->inputSize);
             }
+            extraData->push_back(ed);
+        }
+        if (sigs != nullptr)
+        {
+            SignatureStruct sig;
+            memcpy(sig.sig, payload + sizeof(Transaction) + tx->inputSize, SIGNATURE_SIZE);
+            sigs->push_back(sig);
+        }
+        return false;
+    });
+
+    if (hashes != nullptr && !rawTxSizes.empty())
+    {
+        const unsigned int numHashes = (unsigned int)rawTxSizes.size();
+        std::vector<uint8_t> digests(numHashes * 32);
+        std::vector<const uint8_t*> inputs(numHashes);
+        std::vector<uint8_t*> outputs(numHashes);
+        size_t offset = 0;
+        for (unsigned int i = 0; i < numHashes; i++)
+        {
+            inputs[i] = rawTxs.data() + offset;
+            outputs[i] = digests.data() + i * 32;
+            offset += rawTxSizes[i];
+        }
+        KangarooTwelveMany(inputs.data(), rawTxSizes.data(), outputs.data(), 32, numHashes);
+        for (unsigned int i = 0; i < numHashes; i++)
+        {
+            TxhashStruct hash;
+            char txHash[128] = { 0 };
+            getTxHashFromDigest(outputs[i], txHash);
+            memcpy(hash.hash, txHash, 60);
+            hashes->push_back(hash);
         }
-        recvByte = qc->receiveData(buffer, sizeof(RequestResponseHeader));
-        // check only after receive because response has an EndResponse header at the end
-        if (recvTx == nTx)
-            break;
     }
 
     LOG("Received %d tick transactions\n", recvTx);
@@ -435,7 +509,7 @@ int getMoneyFlewStatus(QCPtr qc, const char* txHash, const uint32_t requestedTic
     RespondTxStatus result;
     try
     {
-        result = qc->receivePacketWithHeaderAs<RespondTxStatus>();
+        qc->receivePacketWithHeaderAs<RespondTxStatus>(result);
         // notice: the node not always return full size of RESPOND_TX_STATUS
         // it only returns enough digests
         // -> set remainder in array memory which may contain junk to 0
@@ -526,10 +600,38 @@ bool checkTxOnTick(QCPtr qc, const char* txHash, uint32_t requestedTick, bool pr
 
 bool checkTxOnTick(const char* nodeIp, const int nodePort, const char* txHash, uint32_t requestedTick, bool printTxReceipt)
 {
-    auto qc = std::make_shared<QubicConnection>(nodeIp, nodePort);
+    auto qc = make_qc(nodeIp, nodePort);
     return checkTxOnTick(qc, txHash, requestedTick, printTxReceipt);
 }
 
+// Receive the response to REQUEST_TRANSACTION_INFO. Return the transaction (including input and signature) in txBuffer
+// if it matches txHash.
+static bool receiveTransactionInfo(QCPtr& qc, const char* txHash, std::vector<uint8_t>& txBuffer)
+{
+    bool receivedTx = false;
+    qc->receiveResponse([&](const RequestResponseHeader& header, const uint8_t* payload)
+    {
+        if (header.type() != BROADCAST_TRANSACTION)
+            return false;
+        size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+        auto tx = (const Transaction*)payload;
+        if (payloadSize < sizeof(Transaction) || payloadSize < sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE)
+            return true;
+        uint8_t digest[32] = {0};
+        char respondTxHash[61] = {0};
+        KangarooTwelve(payload, sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE, digest, 32);
+        getTxHashFromDigest(digest, respondTxHash);
+        // Check the digest of respond transaction
+        if (memcmp(txHash, respondTxHash, 60) == 0)
+        {
+            txBuffer.assign(payload, payload + sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE);
+            receivedTx = true;
+        }
+        return true;
+    });
+    return receivedTx;
+}
+
 // @return:
 // - 0: ok
 // - 1: hash doesn't exist
@@ -552,43 +654,14 @@ int _GetInputDataFromTxHash(QCPtr& qc, const char* txHash, uint8_t* outData, int
 
     qc->sendData((uint8_t *) &packet, packet.header.size());
 
-    // Received the respond and print the receipt
-    bool receivedTx = false;
-    constexpr unsigned long long bufferSize = sizeof(RequestResponseHeader) + MAX_TRANSACTION_SIZE;
-    uint8_t buffer[bufferSize];
-    int recvByte = qc->receiveData(buffer, bufferSize);
-    if (recvByte > 0)
-    {
-        auto header = (RequestResponseHeader*)buffer;
-        if (header->type() == BROADCAST_TRANSACTION)
-        {
-            auto tx = (Transaction*)(buffer + sizeof(RequestResponseHeader));
-            uint8_t digest[32] = {0};
-            char respondTxHash[61] = {0};
-            KangarooTwelve(
-                    reinterpret_cast<const uint8_t*>(tx),
-                    sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE,
-                    digest,
-                    32);
-            getTxHashFromDigest(digest, respondTxHash);
-            // Check the digest of respond transaction
-            if (memcmp(txHash, respondTxHash, 60) == 0)
-            {
-                ExtraDataStruct ed;
-                ed.vecU8.resize(tx->inputSize);
-                if (tx->inputSize != 0)
-                {
-                    memcpy(
-                            ed.vecU8.data(),
-                            reinterpret_cast<const uint8_t*>(tx) + sizeof(Transaction),
-                            tx->inputSize);
-                }
-
-                receivedTx = true;
-                memcpy(outData, ed.vecU8.data(), tx->inputSize);
-                dataSize = tx->inputSize;
-            }
-        }
+    // Received the respond and get the input data
+    std::vector<uint8_t> txBuffer;
+    bool receivedTx = receiveTransactionInfo(qc, txHash, txBuffer);
+    if (receivedTx)
+    {
+        auto tx = (const Transaction*)txBuffer.data();
+        memcpy(outData, txBuffer.data() + sizeof(Transaction), tx->inputSize);
+        dataSize = tx->inputSize;
     }
     if (!receivedTx)
     {
@@ -621,41 +694,13 @@ int _GetTxInfo(QCPtr& qc, const char* txHash)
     qc->sendData((uint8_t *) &packet, packet.header.size());
 
     // Received the respond and print the receipt
-    bool receivedTx = false;
-    constexpr unsigned long long bufferSize = sizeof(RequestResponseHeader) + MAX_TRANSACTION_SIZE;
-    uint8_t buffer[bufferSize];
-    int recvByte = qc->receiveData(buffer, bufferSize);
-    if (recvByte > 0)
-    {
-        auto header = (RequestResponseHeader*)(buffer);
-        if (header->type() == BROADCAST_TRANSACTION)
-        {
-            auto tx = (Transaction*)(buffer + sizeof(RequestResponseHeader));
-            uint8_t digest[32] = {0};
-            char respondTxHash[61] = {0};
-            KangarooTwelve(
-                    reinterpret_cast<const uint8_t*>(tx),
-                    sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE,
-                    digest,
-                    32);
-            getTxHashFromDigest(digest, respondTxHash);
-            // Check the digest of respond transaction
-            if (memcmp(txHash, respondTxHash, 60) == 0)
-            {
-                ExtraDataStruct ed;
-                ed.vecU8.resize(tx->inputSize);
-                if (tx->inputSize != 0)
-                {
-                    memcpy(
-                            ed.vecU8.data(),
-                            reinterpret_cast<const uint8_t*>(tx) + sizeof(Transaction),
-                            tx->inputSize);
-                }
-
-                receivedTx = true;
-                printReceipt(*tx, respondTxHash, ed.vecU8.data(), -1);
-            }
-        }
+    std::vector<uint8_t> txBuffer;
+    bool receivedTx = receiveTransactionInfo(qc, txHash, txBuffer);
+    if (receivedTx)
+    {
+        char respondTxHash[61] = {0};
+        memcpy(respondTxHash, txHash, 60);
+        printReceipt(*(Transaction*)txBuffer.data(), respondTxHash, txBuffer.data() + sizeof(Transaction), -1);
     }
     if (!receivedTx)
     {
@@ -667,7 +712,7 @@ int _GetTxInfo(QCPtr& qc, const char* txHash)
 
 int getTxInfo(const char* nodeIp, const int nodePort, const char* txHash)
 {
-    auto qc = std::make_shared<QubicConnection>(nodeIp, nodePort);
+    auto qc = make_qc(nodeIp, nodePort);
     return _GetTxInfo(qc, txHash);
 }
 
@@ -853,7 +898,7 @@ void getUniqueVotes(std::vector<Tick>& votes, std::vector<Tick>& uniqueVote, std
 
 void getQuorumTick(const char* nodeIp, const int nodePort, uint32_t requestedTick, const char* compFileName)
 {
-    auto qc = std::make_shared<QubicConnection>(nodeIp, nodePort);
+    auto qc = make_qc(nodeIp, nodePort);
     BroadcastComputors bc;
     {
         FILE* f = fopen(compFileName, "rb");
@@ -892,14 +937,32 @@ void getQuorumTick(const char* nodeIp, const int nodePort, uint32_t requestedTic
         return;
     }
 
+    // the signed digest covers the vote with computorIndex XORed with the packet type
+    std::vector<Tick> signedVotes(votes);
+    std::vector<const uint8_t*> voteInputs(N);
+    std::vector<unsigned int> voteInputSizes(N, sizeof(Tick) - SIGNATURE_SIZE);
+    std::vector<uint8_t> voteDigests(N * 32);
+    std::vector<uint8_t*> voteOutputs(N);
+    for (int i = 0; i < N; i++)
+    {
+        signedVotes[i].computorIndex ^= Tick::type();
+        voteInputs[i] = (const uint8_t*)&signedVotes[i];
+        voteOutputs[i] = voteDigests.data() + i * 32;
+    }
+    KangarooTwelveMany(voteInputs.data(), voteInputSizes.data(), voteOutputs.data(), 32, N);
+    std::vector<unsigned int> voteComputors(N);
+    std::vector<const uint8_t*> voteSignatures(N);
+    for (int i = 0; i < N; i++)
+    {
+        voteComputors[i] = votes[i].computorIndex;
+        voteSignatures[i] = votes[i].signature;
+    }
+    std::vector<uint8_t> voteValid((N + 7) / 8);
+    getComputorVerificationContext(bc, compFileName)->verifyBatch(voteComputors.data(), voteOutputs.data(),
+                                                                  voteSignatures.data(), N, voteValid.data());
     for (int i = 0; i < N; i++)
     {
-        uint8_t digest[64] = {0};
-        votes[i].computorIndex ^= Tick::type();
-        KangarooTwelve((uint8_t*)&votes[i], sizeof(Tick) - SIGNATURE_SIZE, digest, 32);
-        votes[i].computorIndex ^= Tick::type();
-        int comp_index = votes[i].computorIndex;
-        if (!verify(bc.computors.publicKeys[comp_index], digest, votes[i].signature))
+        if (!(voteValid[i / 8] & (1 << (i % 8))))
         {
             LOG("Signature of vote %d is not correct\n", i);
             dumpQuorumTick(votes[i]);
@@ -980,15 +1043,46 @@ void getQuorumTick(const char* nodeIp, const int nodePort, uint32_t requestedTic
     }
 }
 
+// Get tick data from the fastest node of g_nodeSet that has it. winner is set to that node.
+static void getTickDataFromNodeSet(const uint32_t tick, TickData& result, NodeAddress& winner)
+{
+    struct
+    {
+        RequestResponseHeader header;
+        RequestTickData requestTickData;
+    } packet;
+    packet.header.setSize(sizeof(packet));
+    packet.header.randomizeDejavu();
+    packet.header.setType(REQUEST_TICK_DATA);
+    packet.requestTickData.requestedTickData.tick = tick;
+    if (!nodeSetRequestPacketAs<TickData>(&packet, packet.header.size(), result,
+            [tick](const TickData& td) { return td.tick == tick && td.epoch != 0; }, nullptr, &winner))
+    {
+        // none of the nodes has the tick (or all failed)
+        memset(&result, 0, sizeof(TickData));
+    }
+}
+
 void getTickDataToFile(const char* nodeIp, const int nodePort, uint32_t requestedTick, const char* fileName)
 {
-    auto qc = std::make_shared<QubicConnection>(nodeIp, nodePort);
     auto td = std::make_unique<TickData>();
-    if (!getTickData(nodeIp, nodePort, requestedTick, *td))
+    QCPtr qc;
+    if (!g_nodeSet.empty())
     {
-        return;
+        // fetch the transactions from the node that answered first
+        NodeAddress winner{nodeIp, nodePort};
+        getTickDataFromNodeSet(requestedTick, *td, winner);
+        qc = make_qc(winner.ip.c_str(), winner.port);
     }
-    else if (td->epoch == 0)
+    else
+    {
+        if (!getTickData(nodeIp, nodePort, requestedTick, *td))
+        {
+            return;
+        }
+        qc = make_qc(nodeIp, nodePort);
+    }
+    if (td->epoch == 0)
     {
         LOG("Tick %u not in current epoch or in the future\n", requestedTick);
         return;
@@ -1026,221 +1120,139 @@ void getTickDataToFile(const char* nodeIp, const int nodePort, uint32_t requeste
     LOG("Tick data and tick transactions have been written to %s\n", fileName);
 }
 
-void readTickDataFromFile(const char* fileName, TickData& td,
-                          std::vector<Transaction>& txs,
-                          std::vector<ExtraDataStruct>* extraData,
-                          std::vector<SignatureStruct>* signatures,
-                          std::vector<TxhashStruct>* txHashes)
+// Transaction of a tick, pointing into a mapped tick file or tick archive. The transaction is followed by its input
+// and signature.
+struct TickTransactionView
 {
-    uint8_t extraDataBuffer[1024] = {0};
-    uint8_t signatureBuffer[128] = {0};
-    char txHashBuffer[128] = {0};
-    uint8_t digest[32] = {0};
-
-    FILE* f = fopen(fileName, "rb");
-    if (fread(&td, 1, sizeof(TickData), f) != sizeof(TickData))
+    const uint8_t* digest;
+    const Transaction* tx; // nullptr if there is no transaction with the digest
+};
+
+// Map a tick data file written by -gettickdata: the TickData followed by its transactions, each with input and
+// signature. td points to the TickData in the mapping and txs receives one entry per non-zero digest, in the order of
+// the digests. The views stay valid while file is open. Return false if the file has no TickData.
+static bool readTickDataFromFile(const char* fileName, MappedFile& file, const TickData*& td,
+                                 std::vector<TickTransactionView>& txs)
+{
+    txs.clear();
+    if (!file.open(fileName) || file.size() < sizeof(TickData))
     {
         LOG("Failed to read TickData\n");
-        fclose(f);
-        return;
+        return false;
     }
+    td = (const TickData*)file.data();
 
     int numTx = 0;
     uint8_t all_zero[32] = {0};
     LOG("List of transactions on tickData (correct order):\n");
     for (int i = 0; i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
     {
-        if (memcmp(all_zero, td.transactionDigests[i], 32) != 0)
+        if (memcmp(all_zero, td->transactionDigests[i], 32) != 0)
         {
             numTx++;
             char digestHex[65] = {0};
-            getIdentityFromPublicKey(td.transactionDigests[i], digestHex, true);
+            getIdentityFromPublicKey(td->transactionDigests[i], digestHex, true);
             LOG("%s\n", digestHex);
         }
     }
     LOG("Total number of transaction digests: %d\n", numTx);
 
-    auto vDigests = std::make_unique<std::vector<TxDigestStruct>>();
-    vDigests->resize(numTx);
+    // the transactions are hashed where they are in the mapping
+    std::vector<const uint8_t*> rawTxs;
+    std::vector<unsigned int> rawTxSizes;
+    rawTxs.reserve(numTx);
+    rawTxSizes.reserve(numTx);
+    size_t offset = sizeof(TickData);
     for (int i = 0; i < numTx; i++)
     {
-        Transaction tx;
-        if (fread(&tx, 1, sizeof(Transaction), f) != sizeof(Transaction))
+        if (file.size() - offset < sizeof(Transaction))
         {
             LOG("Failed to read Transaction %d\n", i);
             break;
         }
-        int extraDataSize = tx.inputSize;
-        if (extraData != nullptr)
-        {
-            ExtraDataStruct eds;
-            if (extraDataSize != 0)
-            {
-                if (fread(extraDataBuffer, 1, extraDataSize, f) != extraDataSize)
-                {
-                    LOG("Failed to read Transaction payload for tx %d\n", i);
-                    fclose(f);
-                    return;
-                }
-                eds.vecU8.resize(extraDataSize);
-                memcpy(eds.vecU8.data(), extraDataBuffer, extraDataSize);
-            }
-            extraData->push_back(eds);
-        }
-
-        if (fread(signatureBuffer, 1, SIGNATURE_SIZE, f) != SIGNATURE_SIZE)
-        {
-            LOG("Failed to read signature for tx %d\n", i);
-            fclose(f);
-            return;
-        }
-        if (signatures != nullptr)
-        {
-            SignatureStruct sig;
-            memcpy(sig.sig, signatureBuffer, SIGNATURE_SIZE);
-            signatures->push_back(sig);
-        }
+        const Transaction* tx = (const Transaction*)(file.data() + offset);
+        const size_t txSize = sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE;
+        if (tx->inputSize > MAX_INPUT_SIZE || file.size() - offset < txSize)
         {
-            std::vector<uint8_t> raw_data;
-            raw_data.resize(sizeof(Transaction) + tx.inputSize + SIGNATURE_SIZE);
-            auto ptr = raw_data.data();
-            memcpy(ptr, &tx, sizeof(Transaction));
-            memcpy(ptr + sizeof(Transaction), extraDataBuffer, tx.inputSize);
-            memcpy(ptr + sizeof(Transaction) + tx.inputSize, signatureBuffer, SIGNATURE_SIZE);
-            KangarooTwelve(ptr,
-                           uint32_t(raw_data.size()),
-                           digest,
-                           32);
-            memcpy(vDigests->at(i).digest, digest, 32);
-        }
-        if (txHashes != nullptr)
-        {
-            TxhashStruct tx_hash;
-            getTxHashFromDigest(digest, txHashBuffer);
-            memcpy(tx_hash.hash, txHashBuffer, 60);
-            txHashes->push_back(tx_hash);
-        }
-        txs.push_back(tx);
-    }
-
-    // if fread failed for a transaction, fill remaining txs with all zero
-    for (int i = int(txs.size()); i < numTx; i++)
-    {
-        Transaction tx;
-        memset(&tx, 0, sizeof(Transaction));
-        txs.push_back(tx);
-        if (extraData != nullptr)
-        {
-            ExtraDataStruct eds;
-            eds.vecU8.resize(0);
-            extraData->push_back(eds);
-        }
-        if (signatures != nullptr)
-        {
-            SignatureStruct ss;
-            memset(ss.sig, 0, 64);
-            signatures->push_back(ss);
-        }
-        if (txHashes != nullptr)
-        {
-            TxhashStruct tx_hash;
-            memset(tx_hash.hash, 0, 60);
-            txHashes->push_back(tx_hash);
+            LOG("Failed to read Transaction payload for tx %d\n", i);
+            break;
         }
+        rawTxs.push_back(file.data() + offset);
+        rawTxSizes.push_back((unsigned int)txSize);
+        offset += txSize;
     }
 
-    // put in correct order by tickdata
-    auto _txs = std::make_unique<std::vector<Transaction>>();
-    auto _extraData = std::make_unique<std::vector<ExtraDataStruct>>();
-    auto _signatures = std::make_unique<std::vector<SignatureStruct>>();
-    auto _txHashes = std::make_unique<std::vector<TxhashStruct>>();
-
-    _txs->resize(numTx);
-    if (extraData != nullptr) _extraData->resize(numTx);
-    if (signatures != nullptr) _signatures->resize(numTx);
-    if (txHashes != nullptr) _txHashes->resize(numTx);
-
-    unsigned int numNotMatched = 0;
-    for (int i = 0; i < numTx; i++)
+    int match[NUMBER_OF_TRANSACTIONS_PER_TICK];
+    const unsigned int numNotMatched = matchTickTransactions(*td, rawTxs.data(), rawTxSizes.data(),
+                                                             (unsigned int)rawTxs.size(), match);
+    txs.reserve(numTx);
+    for (int i = 0; i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
     {
-        bool foundMatch = false;
-        for (int j = 0; j < numTx; j++)
+        if (memcmp(all_zero, td->transactionDigests[i], 32) == 0)
+            continue;
+        TickTransactionView view{ td->transactionDigests[i], nullptr };
+        if (match[i] >= 0)
         {
-            // guaranteed by the protocol, if any duplicated here it's a bug on core side
-            if (memcmp(vDigests->at(j).digest, td.transactionDigests[i], 32) == 0)
-            {
-                foundMatch = true;
-                _txs->at(i) = txs[j];
-                if (extraData != nullptr) _extraData->at(i) =  extraData->at(j);
-                if (signatures != nullptr) _signatures->at(i) = signatures->at(j);
-                if (txHashes != nullptr) _txHashes->at(i) = txHashes->at(j);
-                break;
-            }
+            view.tx = (const Transaction*)rawTxs[match[i]];
         }
-        if (!foundMatch)
+        else
         {
-            numNotMatched++;
             LOG("Did not find a matching transaction for digest %d in TickData: ", i);
             char digestHex[65] = { 0 };
-            getIdentityFromPublicKey(td.transactionDigests[i], digestHex, true);
+            getIdentityFromPublicKey(td->transactionDigests[i], digestHex, true);
             LOG("%s\n", digestHex);
-
-            memset(&_txs->at(i), 0, sizeof(Transaction));
-            if (extraData != nullptr) _extraData->at(i).vecU8.resize(0);
-            if (signatures != nullptr) memset(_signatures->at(i).sig, 0, 64);
-            if (txHashes != nullptr) memset(_txHashes->at(i).hash, 0, 60);
         }
+        txs.push_back(view);
     }
     if (numNotMatched > 0)
     {
         LOG("In total: did not find a matching transaction for %u digests\n", numNotMatched);
     }
+    return true;
+}
 
-    txs = *_txs;
-    if (extraData != nullptr) (*extraData) = *_extraData;
-    if (signatures != nullptr) (*signatures) = *_signatures;
-    if (txHashes != nullptr) (*txHashes) = *_txHashes;
-    fclose(f);
+// Get the transactions of an archived tick like readTickDataFromFile(). They have been checked against the digests
+// when they were archived.
+static void readTickDataFromArchive(const ArchivedTick& tick, std::vector<TickTransactionView>& txs)
+{
+    txs.clear();
+    if (tick.empty())
+        return;
+    for (unsigned int i = 0; i < tick.numTransactions(); i++)
+    {
+        const Transaction* tx = tick.transaction(i);
+        if (tx != nullptr)
+            txs.push_back(TickTransactionView{ tick.digest(i), tx });
+    }
 }
 
 BroadcastComputors readComputorListFromFile(const char* fileName);
 
-void printTickDataFromFile(const char* fileName, const char* compFile)
+static void printTickData(const TickData& td, const std::vector<TickTransactionView>& txs,
+                          const BroadcastComputors& bc, const char* compFile)
 {
-    auto td = std::make_unique<TickData>();
-    auto txs = std::make_unique< std::vector<Transaction>>();
-    txs->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-    auto extraData = std::make_unique< std::vector<ExtraDataStruct>>();
-    extraData->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-    auto signatures = std::make_unique<std::vector<SignatureStruct>>();
-    signatures->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-    auto txHashes = std::make_unique< std::vector<TxhashStruct>>();
-    txHashes->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-
-    readTickDataFromFile(fileName, *td, *txs, extraData.get(), signatures.get(), txHashes.get());
-    
     // verify everything
     uint8_t digest[32];
-    BroadcastComputors bc;
-    bc = readComputorListFromFile(compFile);
-    if (bc.computors.epoch != td->epoch)
+    if (bc.computors.epoch != td.epoch)
     {
-        LOG("Computor list epoch (%u) and tick data epoch (%u) are not matched\n", bc.computors.epoch, td->epoch);
+        LOG("Computor list epoch (%u) and tick data epoch (%u) are not matched\n", bc.computors.epoch, td.epoch);
     }
-    KangarooTwelve((uint8_t*)td.get(), sizeof(TickData), digest, 32);
+    KangarooTwelve((const uint8_t*)&td, sizeof(TickData), digest, 32);
     {
         char tddigest[61]={0};
         getIdentityFromPublicKey(digest, tddigest, true);
         LOG("Tickdata: %s\n", tddigest);
     }
-    int computorIndex = td->computorIndex;
-    td->computorIndex ^= BROADCAST_FUTURE_TICK_DATA;
-    KangarooTwelve(reinterpret_cast<const uint8_t *>(td.get()),
+    int computorIndex = td.computorIndex;
+    // td may be mapped read-only, sign a copy
+    auto signedTd = std::make_unique<TickData>(td);
+    signedTd->computorIndex ^= BROADCAST_FUTURE_TICK_DATA;
+    KangarooTwelve(reinterpret_cast<const uint8_t *>(signedTd.get()),
                    sizeof(TickData) - SIGNATURE_SIZE,
                    digest,
                    32);
-    uint8_t* computorOfThisTick = bc.computors.publicKeys[computorIndex];
-    if (verify(computorOfThisTick, digest, td->signature))
+    const uint8_t* computorOfThisTick = bc.computors.publicKeys[computorIndex];
+    if (getComputorVerificationContext(bc, compFile)->verify(computorIndex, digest, td.signature))
     {
         char computorID[61] = {0};
         getIdentityFromPublicKey(computorOfThisTick, computorID, false);
@@ -1251,23 +1263,36 @@ void printTickDataFromFile(const char* fileName, const char* compFile)
     {
         LOG("Tick is NOT verified (not signed by correct computor).\n");
     }
-    LOG("Epoch: %u\n", td->epoch);
-    LOG("Tick: %u\n", td->tick);
+    LOG("Epoch: %u\n", td.epoch);
+    LOG("Tick: %u\n", td.tick);
     LOG("Computor index: %u\n", computorIndex);
-    LOG("Datetime: %u-%u-%u %u:%u:%u.%u\n", td->day, td->month, td->year, td->hour, td->minute, td->second, td->millisecond);
+    LOG("Datetime: %u-%u-%u %u:%u:%u.%u\n", td.day, td.month, td.year, td.hour, td.minute, td.second, td.millisecond);
 
+    std::vector<const Transaction*> present;
+    present.reserve(txs.size());
+    for (const auto& view : txs)
+    {
+        if (view.tx != nullptr)
+            present.push_back(view.tx);
+    }
+    std::vector<bool> txValid = verifyTxs(present.data(), (unsigned int)present.size());
     unsigned int numZero = 0;
-    for (int i = 0; i < txs->size(); i++)
+    size_t presentIndex = 0;
+    for (const auto& view : txs)
     {
-        if (isArrayZero((uint8_t*)&txs->at(i), sizeof(Transaction)))
+        if (view.tx == nullptr || isArrayZero((const uint8_t*)view.tx, sizeof(Transaction)))
         {
             LOG("Detect a zero transaction - Ignoring\n");
             numZero++;
+            if (view.tx != nullptr)
+                presentIndex++;
             continue;
         }
-        uint8_t* extraDataPtr = extraData->at(i).vecU8.empty() ? nullptr : extraData->at(i).vecU8.data();
-        printReceipt(txs->at(i), txHashes->at(i).hash, extraDataPtr);
-        if (verifyTx(txs->at(i), extraData->at(i).vecU8.data(), signatures->at(i).sig))
+        Transaction tx = *view.tx;
+        char txHash[128] = { 0 };
+        getTxHashFromDigest(view.digest, txHash);
+        printReceipt(tx, txHash, (const uint8_t*)view.tx + sizeof(Transaction));
+        if (txValid[presentIndex++])
         {
             LOG("Transaction is VERIFIED\n");
         }
@@ -1282,26 +1307,98 @@ void printTickDataFromFile(const char* fileName, const char* compFile)
     }
 }
 
+void printTickDataFromFile(const char* fileName, const char* compFile)
+{
+    std::vector<TickTransactionView> txs;
+    txs.reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
+    BroadcastComputors bc = readComputorListFromFile(compFile);
+
+    TickArchive archive;
+    std::vector<uint32_t> ticks;
+    if (openTickArchivePath(fileName, archive, ticks))
+    {
+        auto td = std::make_unique<TickData>();
+        for (uint32_t tick : ticks)
+        {
+            ArchivedTick archivedTick;
+            if (!archive.getTick(tick, archivedTick))
+            {
+                LOG("Tick %u is not in the archive\n", tick);
+                continue;
+            }
+            if (archivedTick.empty())
+            {
+                LOG("Tick %u is empty\n", tick);
+                continue;
+            }
+            archivedTick.getTickData(*td);
+            readTickDataFromArchive(archivedTick, txs);
+            printTickData(*td, txs, bc, compFile);
+        }
+        return;
+    }
+
+    MappedFile file;
+    const TickData* td = nullptr;
+    if (!readTickDataFromFile(fileName, file, td, txs))
+        return;
+    printTickData(*td, txs, bc, compFile);
+}
+
+// Return the transaction with the digest, nullptr if there is none.
+static const Transaction* findTickTransaction(const std::vector<TickTransactionView>& txs, const uint8_t* digest)
+{
+    for (const auto& view : txs)
+    {
+        if (view.tx != nullptr && memcmp(view.digest, digest, 32) == 0)
+            return view.tx;
+    }
+    return nullptr;
+}
+
 bool checkTxOnFile(const char* txHash, const char* fileName)
 {
-    auto td = std::make_unique<TickData>();
-    auto txs = std::make_unique< std::vector<Transaction>>();
-    txs->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-    auto extraData = std::make_unique< std::vector<ExtraDataStruct>>();
-    extraData->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-    auto signatures = std::make_unique<std::vector<SignatureStruct>>();
-    signatures->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
-    auto txHashes = std::make_unique< std::vector<TxhashStruct>>();
-    txHashes->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
+    // compare the digests instead of the hashes of all transactions
+    uint8_t txDigest[32];
+    if (!getDigestFromTxHash(txHash, txDigest))
+    {
+        LOG("Invalid tx hash %s\n", txHash);
+        return false;
+    }
+    std::vector<TickTransactionView> txs;
+    txs.reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
 
-    readTickDataFromFile(fileName, *td, *txs, extraData.get(), signatures.get(), txHashes.get());
+    TickArchive archive;
+    std::vector<uint32_t> ticks;
+    if (openTickArchivePath(fileName, archive, ticks))
+    {
+        for (uint32_t tick : ticks)
+        {
+            ArchivedTick archivedTick;
+            if (!archive.getTick(tick, archivedTick) || archivedTick.empty())
+                continue;
+            readTickDataFromArchive(archivedTick, txs);
+            if (const Transaction* tx = findTickTransaction(txs, txDigest))
+            {
+                LOG("Found tx %s in tick %u of %s\n", txHash, tick, fileName);
+                Transaction receiptTx = *tx;
+                printReceipt(receiptTx, txHash, (const uint8_t*)tx + sizeof(Transaction));
+                return true;
+            }
+        }
+        LOG("Can NOT find tx %s on file %s\n", txHash, fileName);
+        return false;
+    }
 
-    for (int i = 0; i < txs->size(); i++)
+    MappedFile file;
+    const TickData* td = nullptr;
+    if (readTickDataFromFile(fileName, file, td, txs))
     {
-        if (memcmp(txHashes->at(i).hash, txHash, 60) == 0)
+        if (const Transaction* tx = findTickTransaction(txs, txDigest))
         {
             LOG("Found tx %s on file %s\n", txHash, fileName);
-            printReceipt(txs->at(i), txHash, extraData->at(i).vecU8.data());
+            Transaction receiptTx = *tx;
+            printReceipt(receiptTx, txHash, (const uint8_t*)tx + sizeof(Transaction));
             return true;
         }
     }
@@ -1314,33 +1411,33 @@ void sendRawPacket(const char* nodeIp, const int nodePort, int rawPacketSize, ui
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData(rawPacket, rawPacketSize);
     LOG("Sent %d bytes\n", rawPacketSize);
-    RequestResponseHeader header;
-    uint8_t* headerPtr = (uint8_t*)&header;
-    qc->receiveData(headerPtr, sizeof(RequestResponseHeader));
-    std::vector<uint8_t> buffer;
-    if (header.size() > sizeof(RequestResponseHeader))
-    {
-        unsigned long long remainingSize = header.size() - sizeof(RequestResponseHeader);
-        buffer.resize(remainingSize);
-        qc->receiveData(buffer.data(), int(remainingSize));
-    }
-    LOG("Received %d bytes\n", header.size());
-    for (int i = 0; i < sizeof(RequestResponseHeader); ++i)
+    // print the first packet of the response
+    bool received = false;
+    bool ok = qc->receiveResponse([&received](const RequestResponseHeader& header, const uint8_t* payload)
     {
-        LOG("%02x", headerPtr[i]);
-    }
-    for (int i = 0; i < buffer.size(); ++i)
+        LOG("Received %d bytes\n", header.size());
+        const uint8_t* headerPtr = (const uint8_t*)&header;
+        for (int i = 0; i < sizeof(RequestResponseHeader); ++i)
+        {
+            LOG("%02x", headerPtr[i]);
+        }
+        for (unsigned int i = 0; i < header.size() - sizeof(RequestResponseHeader); ++i)
+        {
+            LOG("%02x", payload[i]);
+        }
+        LOG("\n");
+        received = true;
+        return true;
+    });
+    if (ok && !received)
     {
-        LOG("%02x", buffer[i]);
+        LOG("Received END_RESPOND\n");
     }
-    LOG("\n");
 }
 
 void sendSpecialCommand(const char* nodeIp, const int nodePort, const char* seed, int command)
 {
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
 
@@ -1356,14 +1453,13 @@ void sendSpecialCommand(const char* nodeIp, const int nodePort, const char* seed
     uint64_t commandByte = (uint64_t)(command) << 56;
     packet.cmd.everIncreasingNonceAndCommandType = commandByte | curTime;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
                    sizeof(packet.cmd),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t *) &packet, packet.header.size());
@@ -1402,9 +1498,7 @@ void sendSpecialCommand(const char* nodeIp, const int nodePort, const char* seed
 
 void toggleMainAux(const char* nodeIp, const int nodePort, const char* seed, std::string mode0, std::string mode1)
 {
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
 
@@ -1425,14 +1519,13 @@ void toggleMainAux(const char* nodeIp, const int nodePort, const char* seed, std
     packet.cmd.mainModeFlag = flag;
     memset(packet.cmd.padding, 0, 7);
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
                    sizeof(packet.cmd),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t *) &packet, packet.header.size());
@@ -1466,9 +1559,7 @@ void toggleMainAux(const char* nodeIp, const int nodePort, const char* seed, std
 
 void setSolutionThreshold(const char* nodeIp, const int nodePort, const char* seed, int epoch, int threshold, int algo)
 {
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
 
@@ -1487,14 +1578,13 @@ void setSolutionThreshold(const char* nodeIp, const int nodePort, const char* se
     packet.cmd.threshold = threshold;
     packet.cmd.algoType = algo;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
                    sizeof(packet.cmd),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t *) &packet, packet.header.size());
@@ -1564,14 +1654,11 @@ UtcTime convertTime(std::chrono::system_clock::time_point time)
 
 void syncTime(const char* nodeIp, const int nodePort, const char* seed)
 {
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     LOG("---------------------------------------------------------------------------------\n");
     LOG("This sets the node clock to roughly be in sync with the local clock.\n");
@@ -1607,7 +1694,7 @@ void syncTime(const char* nodeIp, const int nodePort, const char* seed)
                        sizeof(queryTimeMsg.cmd),
                        digest,
                        32);
-        sign(subseed, sourcePublicKey, digest, signature);
+        signer.sign(digest, signature);
         memcpy(queryTimeMsg.signature, signature, 64);
 
         auto startTime = steady_clock::now();
@@ -1674,7 +1761,7 @@ void syncTime(const char* nodeIp, const int nodePort, const char* seed)
                        sizeof(sendTimeMsg.cmd),
                        digest,
                        32);
-        sign(subseed, sourcePublicKey, digest, signature);
+        signer.sign(digest, signature);
         memcpy(sendTimeMsg.signature, signature, 64);
 
         auto startTime = steady_clock::now();
@@ -1710,9 +1797,7 @@ void syncTime(const char* nodeIp, const int nodePort, const char* seed)
 
 void setLoggingMode(const char* nodeIp, const int nodePort, const char* seed, char mode)
 {
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
 
@@ -1729,14 +1814,13 @@ void setLoggingMode(const char* nodeIp, const int nodePort, const char* seed, ch
     packet.cmd.everIncreasingNonceAndCommandType = commandByte | curTime;
     packet.cmd.loggingMode = mode;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
         sizeof(packet.cmd),
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t*)&packet, packet.header.size());
@@ -1763,13 +1847,10 @@ void setLoggingMode(const char* nodeIp, const int nodePort, const char* seed, ch
 
 void broadcastCompChat(const char* nodeIp, const int nodePort, const char* seed, char* compChatMsg)
 {
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     std::string compChatStr(compChatMsg);
     char rand_str[5] = {0};
     rand_str[0] = 'a' + (getRand32() % 26);
@@ -1797,7 +1878,7 @@ void broadcastCompChat(const char* nodeIp, const int nodePort, const char* seed,
                    uint32_t(vData.size() - sizeof(RequestResponseHeader) - SIGNATURE_SIZE),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature_ptr);
+    signer.sign(digest, signature_ptr);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData(vData.data(), int(vData.size()));
     LOG("Broadcasted message to network\n");
@@ -1847,7 +1928,7 @@ bool getComputorFromNode(const char* nodeIp, const int nodePort, BroadcastComput
 
     try
     {
-        result = qc->receivePacketWithHeaderAs<BroadcastComputors>();
+        qc->receivePacketWithHeaderAs<BroadcastComputors>(result);
         return true;
     }
     catch (const std::logic_error& e)
@@ -1988,21 +2069,40 @@ void dumpSpectrumToCSV(const char* input, const char* output){
         std::string header ="ID,LastInTick,LastOutTick,AmountIn,AmountOut,Balance\n";
         fwrite(header.c_str(), 1, header.size(), f);
     }
-    char buffer[128] = {0};
-    for (int i = 0; i < SPECTRUM_CAPACITY; i++)
-    {
-        if (!isEmptyEntity(spectrum[i]))
-        {
-            memset(buffer, 0, 128);
-            getIdentityFromPublicKey(spectrum[i].publicKey, buffer, false);
-            std::string id = buffer;
-            std::string line = id + "," + std::to_string(spectrum[i].latestIncomingTransferTick)
-                               + "," + std::to_string(spectrum[i].latestOutgoingTransferTick)
-                               + "," + std::to_string(spectrum[i].incomingAmount)
-                               + "," + std::to_string(spectrum[i].outgoingAmount)
-                               + "," + std::to_string(spectrum[i].incomingAmount-spectrum[i].outgoingAmount) + "\n";
+    // identities are computed for blocks of non-empty entities
+    const size_t IDENTITY_BLOCK_SIZE = 4096;
+    std::vector<size_t> blockEntities;
+    std::vector<const uint8_t*> blockKeys;
+    std::vector<std::array<char, 61>> blockIds(IDENTITY_BLOCK_SIZE);
+    std::vector<char*> blockIdPtrs(IDENTITY_BLOCK_SIZE);
+    for (size_t k = 0; k < IDENTITY_BLOCK_SIZE; k++)
+        blockIdPtrs[k] = blockIds[k].data();
+    for (size_t i = 0; i <= SPECTRUM_CAPACITY; i++)
+    {
+        if (i < SPECTRUM_CAPACITY)
+        {
+            if (!isEmptyEntity(spectrum[i]))
+            {
+                blockEntities.push_back(i);
+                blockKeys.push_back(spectrum[i].publicKey);
+            }
+            if (blockEntities.size() < IDENTITY_BLOCK_SIZE)
+                continue;
+        }
+        getIdentitiesFromPublicKeys(blockKeys.data(), blockIdPtrs.data(), blockKeys.size(), false);
+        for (size_t k = 0; k < blockEntities.size(); k++)
+        {
+            const Entity& entity = spectrum[blockEntities[k]];
+            std::string id = blockIds[k].data();
+            std::string line = id + "," + std::to_string(entity.latestIncomingTransferTick)
+                               + "," + std::to_string(entity.latestOutgoingTransferTick)
+                               + "," + std::to_string(entity.incomingAmount)
+                               + "," + std::to_string(entity.outgoingAmount)
+                               + "," + std::to_string(entity.incomingAmount-entity.outgoingAmount) + "\n";
             fwrite(line.c_str(), 1, line.size(), f);
         }
+        blockEntities.clear();
+        blockKeys.clear();
     }
     free(spectrum);
     fclose(f);
@@ -2026,13 +2126,38 @@ void dumpUniverseToCSV(const char* input, const char* output){
         fwrite(header.c_str(), 1, header.size(), f);
     }
     char buffer[128] = {0};
+    // identities of the records and of their issuers, computed in blocks
+    const size_t IDENTITY_BLOCK_SIZE = 4096;
+    std::vector<const uint8_t*> blockKeys;
+    std::vector<std::array<char, 61>> blockIds(2 * IDENTITY_BLOCK_SIZE);
+    std::vector<char*> blockIdPtrs(2 * IDENTITY_BLOCK_SIZE);
+    for (size_t k = 0; k < blockIdPtrs.size(); k++)
+        blockIdPtrs[k] = blockIds[k].data();
+    size_t nextId = 0;
     for (int i = 0; i < ASSETS_CAPACITY; i++)
     {
+        if (i % IDENTITY_BLOCK_SIZE == 0)
+        {
+            blockKeys.clear();
+            for (size_t j = i; j < i + IDENTITY_BLOCK_SIZE && j < ASSETS_CAPACITY; j++)
+            {
+                size_t issuanceIndex;
+                switch (asset[j].varStruct.ownership.type)
+                {
+                case ISSUANCE: issuanceIndex = j; break;
+                case OWNERSHIP: issuanceIndex = asset[j].varStruct.ownership.issuanceIndex; break;
+                case POSSESSION: issuanceIndex = asset[asset[j].varStruct.possession.ownershipIndex].varStruct.ownership.issuanceIndex; break;
+                default: continue;
+                }
+                blockKeys.push_back(asset[j].varStruct.issuance.publicKey);
+                blockKeys.push_back(asset[issuanceIndex].varStruct.issuance.publicKey);
+            }
+            getIdentitiesFromPublicKeys(blockKeys.data(), blockIdPtrs.data(), blockKeys.size(), false);
+            nextId = 0;
+        }
         if (asset[i].varStruct.ownership.type == OWNERSHIP)
         {
-            memset(buffer, 0, 128);
-            getIdentityFromPublicKey(asset[i].varStruct.ownership.publicKey, buffer, false);
-            std::string id = buffer;
+            std::string id = blockIds[nextId].data();
             std::string asset_name = "null";
             std::string issuerID = "null";
             size_t issue_index = asset[i].varStruct.ownership.issuanceIndex;
@@ -2044,9 +2169,7 @@ void dumpUniverseToCSV(const char* input, const char* output){
             }
             {
                 // get issuer
-                memset(buffer, 0, 128);
-                getIdentityFromPublicKey(asset[issue_index].varStruct.issuance.publicKey, buffer, false);
-                issuerID = buffer;
+                issuerID = blockIds[nextId + 1].data();
             }
             std::string line = std::to_string(i) + ",OWNERSHIP,"+ id
                                + "," + std::to_string(i) + ","
@@ -2054,12 +2177,11 @@ void dumpUniverseToCSV(const char* input, const char* output){
                                + "," + issuerID
                                + "," + std::to_string(asset[i].varStruct.ownership.numberOfShares) + "\n";
             fwrite(line.c_str(), 1, line.size(), f);
+            nextId += 2;
         }
         if (asset[i].varStruct.ownership.type == POSSESSION)
         {
-            memset(buffer, 0, 128);
-            getIdentityFromPublicKey(asset[i].varStruct.possession.publicKey, buffer, false);
-            std::string id = buffer;
+            std::string id = blockIds[nextId].data();
             std::string asset_name = "null";
             std::string issuerID = "null";
             std::string str_index = std::to_string(i);
@@ -2074,19 +2196,16 @@ void dumpUniverseToCSV(const char* input, const char* output){
                 memset(buffer, 0, 128);
                 memcpy(buffer, asset[issuance_index].varStruct.issuance.name, 7);
                 asset_name = buffer;
-                memset(buffer, 0, 128);
-                getIdentityFromPublicKey(asset[issuance_index].varStruct.issuance.publicKey, buffer, false);
-                issuerID = buffer;
+                issuerID = blockIds[nextId + 1].data();
             }
             std::string line = str_index + ",POSSESSION," + id + "," + str_owner_index + "," +
                                str_contract_index + "," + asset_name + "," + issuerID + "," + str_amount + "\n";
             fwrite(line.c_str(), 1, line.size(), f);
+            nextId += 2;
         }
         if (asset[i].varStruct.ownership.type == ISSUANCE)
         {
-            memset(buffer, 0, 128);
-            getIdentityFromPublicKey(asset[i].varStruct.issuance.publicKey, buffer, false);
-            std::string id = buffer;
+            std::string id = blockIds[nextId].data();
             std::string asset_name = "null";
             std::string issuerID = "null";
             std::string str_index = std::to_string(i);
@@ -2098,14 +2217,13 @@ void dumpUniverseToCSV(const char* input, const char* output){
                 memset(buffer, 0, 128);
                 memcpy(buffer, asset[i].varStruct.issuance.name, 7);
                 asset_name = buffer;
-                memset(buffer, 0, 128);
-                getIdentityFromPublicKey(asset[i].varStruct.issuance.publicKey, buffer, false);
-                issuerID = buffer;
+                issuerID = blockIds[nextId + 1].data();
             }
             // std::string header ="Index,Type,ID,OwnerIndex,ContractIndex,AssetName,AssetIssuer,Amount\n";
             std::string line = str_index + ",ISSUANCE," + id + "," + str_owner_index + "," +
                                str_contract_index + "," + asset_name + "," + issuerID + "," + str_amount + "\n";
             fwrite(line.c_str(), 1, line.size(), f);
+            nextId += 2;
         }
     }
     free(asset);
@@ -2114,9 +2232,7 @@ void dumpUniverseToCSV(const char* input, const char* output){
 
 void getMiningScoreRanking(const char* nodeIp, const int nodePort, const char* seed)
 {
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
 
@@ -2131,14 +2247,13 @@ void getMiningScoreRanking(const char* nodeIp, const int nodePort, const char* s
     uint64_t curTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     uint64_t commandByte = (uint64_t)(SPECIAL_COMMAND_GET_MINING_SCORE_RANKING) << 56;
     packet.cmd.everIncreasingNonceAndCommandType = commandByte | curTime;
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
                    sizeof(packet.cmd),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t *) &packet, packet.header.size());
@@ -2231,8 +2346,10 @@ void getVoteCounterTransaction(const char* nodeIp, const int nodePort, unsigned
     txs->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
     auto extraData = std::make_unique<std::vector<ExtraDataStruct>>();
     extraData->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
+    auto signatures = std::make_unique<std::vector<SignatureStruct>>();
+    signatures->reserve(NUMBER_OF_TRANSACTIONS_PER_TICK);
 
-    getTickTransactions(qc, requestedTick, NUMBER_OF_TRANSACTIONS_PER_TICK, *txs, /*hashes=*/nullptr, extraData.get(), /*sigs=*/nullptr);
+    getTickTransactions(qc, requestedTick, NUMBER_OF_TRANSACTIONS_PER_TICK, *txs, /*hashes=*/nullptr, extraData.get(), signatures.get());
     
     auto td = std::make_unique<TickData>();
     getTickData(qc, requestedTick, *td);
@@ -2248,6 +2365,16 @@ void getVoteCounterTransaction(const char* nodeIp, const int nodePort, unsigned
             if (memcmp(txs->at(i).sourcePublicKey, bc.computors.publicKeys[comp_idx], 32) == 0)
             {
                 uint8_t* data = extraData->at(i).vecU8.data();
+                std::vector<uint8_t> signedData(sizeof(Transaction) + extraData->at(i).vecU8.size());
+                memcpy(signedData.data(), &txs->at(i), sizeof(Transaction));
+                memcpy(signedData.data() + sizeof(Transaction), data, extraData->at(i).vecU8.size());
+                uint8_t digest[32];
+                KangarooTwelve(signedData.data(), uint32_t(signedData.size()), digest, 32);
+                if (!getComputorVerificationContext(bc, compFileName)->verify(comp_idx, digest, signatures->at(i).sig))
+                {
+                    LOG("Signature of transaction %d is not correct\n", i);
+                    continue;
+                }
                 uint32_t sum = 0;
                 if (txs->at(i).inputType == 1)
                 {
@@ -2308,9 +2435,7 @@ void getVoteCounterTransaction(const char* nodeIp, const int nodePort, unsigned
 
 void saveSnapshot(const char* nodeIp, const int nodePort, const char* seed)
 {
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
 
@@ -2326,14 +2451,13 @@ void saveSnapshot(const char* nodeIp, const int nodePort, const char* seed)
     uint64_t commandByte = (uint64_t)(SPECIAL_COMMAND_SAVE_SNAPSHOT) << 56;
     packet.cmd.everIncreasingNonceAndCommandType = commandByte | curTime;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
                    sizeof(packet.cmd),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t *) &packet, packet.header.size());
@@ -2383,9 +2507,7 @@ void saveSnapshot(const char* nodeIp, const int nodePort, const char* seed)
 
 void setExecutionFeeMultiplier(const char* nodeIp, const int nodePort, const char* seed, unsigned long long multiplierNumerator, unsigned long long multiplierDenominator)
 {
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
 
@@ -2403,14 +2525,13 @@ void setExecutionFeeMultiplier(const char* nodeIp, const int nodePort, const cha
     packet.cmd.multiplierNumerator = multiplierNumerator;
     packet.cmd.multiplierDenominator = multiplierDenominator;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
         sizeof(packet.cmd),
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t*)&packet, packet.header.size());
@@ -2437,9 +2558,7 @@ void setExecutionFeeMultiplier(const char* nodeIp, const int nodePort, const cha
 
 void getExecutionFeeMultiplier(const char* nodeIp, const int nodePort, const char* seed)
 {
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
 
@@ -2455,14 +2574,13 @@ void getExecutionFeeMultiplier(const char* nodeIp, const int nodePort, const cha
     uint64_t commandByte = (uint64_t)(SPECIAL_COMMAND_GET_EXECUTION_FEE_MULTIPLIER) << 56;
     packet.cmd.everIncreasingNonceAndCommandType = commandByte | curTime;
 
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     KangarooTwelve((unsigned char*)&packet.cmd,
         sizeof(packet.cmd),
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     auto qc = make_qc(nodeIp, nodePort);
     qc->sendData((uint8_t*)&packet, packet.header.size());
@@ -4,6 +4,8 @@
 #include "structs.h"
 
 void printTickInfoFromNode(const char* nodeIp, int nodePort);
+// Probe the node (or all nodes of g_nodeSet) numProbes times and print the round-trip time estimates.
+void printNodeLatency(const char* nodeIp, int nodePort, int numProbes);
 void printSystemInfoFromNode(const char* nodeIp, int nodePort);
 CurrentSystemInfo getSystemInfoFromNode(QCPtr qc);
 void dumpRevenueDataFromNode(const char* nodeIp, int nodePort, const char* outputFile);
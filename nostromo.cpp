@@ -246,17 +246,14 @@ void registerInTier(const char* nodeIp, int nodePort,
     
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -305,7 +302,7 @@ void registerInTier(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(registerInTier_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -328,17 +325,14 @@ void logoutFromTier(const char* nodeIp, int nodePort,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -366,7 +360,7 @@ void logoutFromTier(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(logoutFromTier_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -402,17 +396,14 @@ void createProject(const char* nodeIp, int nodePort,
     char assetNameS1[8] = {0};
     memcpy(assetNameS1, tokenName, strlen(tokenName));
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -451,7 +442,7 @@ void createProject(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(createProject_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -476,17 +467,14 @@ void voteInProject(const char* nodeIp, int nodePort,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -517,7 +505,7 @@ void voteInProject(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(voteInProject_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -589,17 +577,14 @@ void createFundraising(const char* nodeIp, int nodePort,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -677,7 +662,7 @@ void createFundraising(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(createFundraising_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -701,17 +686,14 @@ void investInProject(const char* nodeIp, int nodePort,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -741,7 +723,7 @@ void investInProject(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(investInProject_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -766,17 +748,14 @@ void claimToken(const char* nodeIp, int nodePort,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -807,7 +786,7 @@ void claimToken(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(claimToken_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -839,17 +818,14 @@ void upgradeTierLevel(const char* nodeIp, int nodePort,
     
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -896,7 +872,7 @@ void upgradeTierLevel(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(upgradeTier_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -928,17 +904,14 @@ void nostromoTransferShareManagementRights(const char* nodeIp, int nodePort,
     memcpy(assetNameS1, assetName, strlen(assetName));
     getPublicKeyFromIdentity(issuer, pubKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = NOSTROMO_CONTRACT_INDEX;
@@ -972,7 +945,7 @@ void nostromoTransferShareManagementRights(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(nostromoTransferShareManagementRights_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
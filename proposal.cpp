@@ -1046,14 +1046,11 @@ void getVote(const char* nodeIp, int nodePort, const char* proposalIndexString,
 	{
 		// Get public key from seed
 		sanityCheckSeed(voterSeed);
-		uint8_t privateKey[32] = { 0 };
-		uint8_t subseed[32] = { 0 };
 		uint8_t digest[32] = { 0 };
 		uint8_t signature[64] = { 0 };
 		char publicIdentity[128] = { 0 };
-		getSubseedFromSeed((uint8_t*)voterSeed, subseed);
-		getPrivateKeyFromSubSeed(subseed, privateKey);
-		getPublicKeyFromPrivateKey(privateKey, voterPublicKey);
+		const SigningContext& signer = getSigningContext(voterSeed);
+		memcpy(voterPublicKey, signer.publicKey(), 32);
 	}
 	else
 	{
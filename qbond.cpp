@@ -70,8 +70,6 @@ void qbondStake(const char* nodeIp, int nodePort, const char* seed, const int64_
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -80,9 +78,8 @@ void qbondStake(const char* nodeIp, int nodePort, const char* seed, const int64_
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = QBOND_CONTRACT_INDEX;
@@ -107,7 +104,7 @@ void qbondStake(const char* nodeIp, int nodePort, const char* seed, const int64_
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -138,8 +135,6 @@ void qbondTransfer(const char* nodeIp, int nodePort, const char* seed, const cha
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -148,9 +143,8 @@ void qbondTransfer(const char* nodeIp, int nodePort, const char* seed, const cha
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = QBOND_CONTRACT_INDEX;
@@ -175,7 +169,7 @@ void qbondTransfer(const char* nodeIp, int nodePort, const char* seed, const cha
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -225,8 +219,6 @@ void qbondOperateOrder(const char* nodeIp, int nodePort, const char* seed, const
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -235,9 +227,8 @@ void qbondOperateOrder(const char* nodeIp, int nodePort, const char* seed, const
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = QBOND_CONTRACT_INDEX;
@@ -262,7 +253,7 @@ void qbondOperateOrder(const char* nodeIp, int nodePort, const char* seed, const
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -290,8 +281,6 @@ void qbondBurn(const char* nodeIp, int nodePort, const char* seed, const int64_t
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -300,9 +289,8 @@ void qbondBurn(const char* nodeIp, int nodePort, const char* seed, const int64_t
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = QBOND_CONTRACT_INDEX;
@@ -327,7 +315,7 @@ void qbondBurn(const char* nodeIp, int nodePort, const char* seed, const int64_t
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -357,8 +345,6 @@ void qbondUpdateCFA(const char* nodeIp, int nodePort, const char* seed, const ch
         return;
     }
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32];
@@ -367,9 +353,8 @@ void qbondUpdateCFA(const char* nodeIp, int nodePort, const char* seed, const ch
     char txHash[128] = { 0 };
     const bool isLowerCase = false;
 
-    getSubseedFromSeed((uint8_t*) seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     memset(destPublicKey, 0, 32);
     ((uint64_t*) destPublicKey)[0] = QBOND_CONTRACT_INDEX;
@@ -394,7 +379,7 @@ void qbondUpdateCFA(const char* nodeIp, int nodePort, const char* seed, const ch
                    sizeof(packet.transaction) + sizeof(input),
                    digest, 
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -71,17 +71,14 @@ void qearnLock(const char* nodeIp, int nodePort, const char* seed, long long loc
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QEARN_CONTRACT_INDEX;
@@ -105,7 +102,7 @@ void qearnLock(const char* nodeIp, int nodePort, const char* seed, long long loc
                    sizeof(packet.transaction),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -126,17 +123,14 @@ void qearnUnlock(const char* nodeIp, int nodePort, const char* seed, long long u
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QEARN_CONTRACT_INDEX;
@@ -163,7 +157,7 @@ void qearnUnlock(const char* nodeIp, int nodePort, const char* seed, long long u
                    sizeof(packet.transaction) + sizeof(Unlock_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
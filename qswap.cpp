@@ -91,16 +91,13 @@ void qswapIssueAsset(const char* nodeIp, int nodePort,
     char UoMS1[8] = {0};
     memcpy(assetNameS1, assetName, strlen(assetName));
     for (int i = 0; i < 7; i++) UoMS1[i] = unitOfMeasurement[i] - 48;
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
 
     struct {
@@ -136,7 +133,7 @@ void qswapIssueAsset(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(QswapIssueAsset_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(QswapIssueAsset_input)+ SIGNATURE_SIZE);
@@ -164,10 +161,8 @@ void qswapTransferAsset(const char* nodeIp, int nodePort,
                         uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -183,9 +178,8 @@ void qswapTransferAsset(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
     getPublicKeyFromIdentity(newOwnerIdentity, newOwnerPublicKey);
     struct {
@@ -213,7 +207,7 @@ void qswapTransferAsset(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(QswapTransferAssetOwnershipAndPossession_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(QswapTransferAssetOwnershipAndPossession_input)+ SIGNATURE_SIZE);
@@ -257,10 +251,8 @@ void qswapCreatePool(const char* nodeIp, int nodePort,
                      uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -276,9 +268,8 @@ void qswapCreatePool(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
 
     struct {
@@ -312,7 +303,7 @@ void qswapCreatePool(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(CreatePool_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(CreatePool_input)+ SIGNATURE_SIZE);
@@ -342,10 +333,8 @@ void qswapAddLiquidity(const char* nodeIp, int nodePort,
                       uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -360,9 +349,8 @@ void qswapAddLiquidity(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
 
     struct {
@@ -403,7 +391,7 @@ void qswapAddLiquidity(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(AddLiquidity_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(AddLiquidity_input)+ SIGNATURE_SIZE);
@@ -432,10 +420,8 @@ void qswapRemoveLiquidity(const char* nodeIp, int nodePort,
                       uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -450,9 +436,8 @@ void qswapRemoveLiquidity(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
 
     struct {
@@ -492,7 +477,7 @@ void qswapRemoveLiquidity(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(RemoveLiquidity_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(RemoveLiquidity_input)+ SIGNATURE_SIZE);
@@ -521,10 +506,8 @@ void qswapSwapQuForAssetAction(const char* nodeIp, int nodePort,
                                uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -538,9 +521,8 @@ void qswapSwapQuForAssetAction(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
     struct {
         RequestResponseHeader header;
@@ -589,7 +571,7 @@ void qswapSwapQuForAssetAction(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(SwapQuForAssetAction_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(SwapQuForAssetAction_input)+ SIGNATURE_SIZE);
@@ -658,10 +640,8 @@ void qswapSwapAssetForQuAction(const char* nodeIp, int nodePort,
                                uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -675,9 +655,8 @@ void qswapSwapAssetForQuAction(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QSWAP_ADDRESS, destPublicKey);
     struct {
         RequestResponseHeader header;
@@ -726,7 +705,7 @@ void qswapSwapAssetForQuAction(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(SwapAssetForQuAction_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(SwapAssetForQuAction_input)+ SIGNATURE_SIZE);
@@ -636,15 +636,12 @@ void qtryPublishResult(const char* nodeIp, int nodePort, const char* seed, uint3
 
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
     char goIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     qtryBasicInfo_output basic{};
@@ -715,15 +712,12 @@ void qtryTryFinalizeEvent(const char* nodeIp, int nodePort, const char* seed, ui
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
     char goIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     qtryBasicInfo_output basic{};
@@ -810,13 +804,10 @@ void qtryDispute(const char* nodeIp, int nodePort, const char* seed, uint32_t sc
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     qtryBasicInfo_output basic{};
     quotteryGetBasicInfo(qc, basic);
@@ -925,14 +916,11 @@ void qtryResolveDispute(const char* nodeIp, int nodePort, const char* seed, uint
 
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     getEventInfo_output eventInfo{};
@@ -1004,14 +992,11 @@ void qtryUserClaimReward(const char* nodeIp, int nodePort, const char* seed, uin
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     getEventInfo_output eventInfo{};
@@ -1131,15 +1116,12 @@ void qtryGOForceClaimReward(const char* nodeIp, int nodePort, const char* seed,
 
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
     char goIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     qtryBasicInfo_output basic{};
@@ -1284,15 +1266,12 @@ void qtryCleanMemory(const char* nodeIp, int nodePort, const char* seed, uint32_
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
     char goIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     qtryBasicInfo_output basic{};
@@ -1423,15 +1402,12 @@ void qtryUpdateFeeDiscountList(const char* nodeIp, int nodePort, const char* see
 
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
     char goIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     qtryBasicInfo_output basic{};
@@ -1484,14 +1460,11 @@ void qtryProposalVote(const char* nodeIp, int nodePort, const char* seed,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    uint8_t subSeed[32] = { 0 };
     char sourceIdentity[128] = { 0 };
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getIdentityFromPublicKey(sourcePublicKey, sourceIdentity, false);
 
     qtryBasicInfo_output basic{};
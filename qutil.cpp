@@ -1,10 +1,13 @@
 #include <algorithm>
+#include <array>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <fstream>
 #include <cstring>
 #include <cinttypes>
+#include <chrono>
+#include <thread>
 
 #include "qutil.h"
 #include "key_utils.h"
@@ -14,6 +17,7 @@
 #include "node_utils.h"
 #include "k12_and_key_utils.h"
 #include "connection.h"
+#include "node_rtt.h"
 #include "wallet_utils.h"
 #include "sanity_check.h"
 
@@ -85,36 +89,61 @@ static_assert(sizeof(GetBalances16_output) == 128);
 
 static constexpr int kGetBalances16MaxAttempts = 6;
 
-static bool tryGetBalances16Batch(const char* nodeIp, int nodePort,
-    GetBalances16_input* input, GetBalances16_output* output,
-    size_t batchIndex1Based, size_t numBatches)
+// Run GetBalances16 for all batches, pipelined on one connection. Failed batches are retried on a new connection up to
+// kGetBalances16MaxAttempts times. Returns which batches succeeded.
+static std::vector<bool> getBalances16Batches(const char* nodeIp, int nodePort,
+    const std::vector<GetBalances16_input>& inputs, std::vector<GetBalances16_output>& outputs)
 {
+    const size_t numBatches = inputs.size();
+    std::vector<bool> done(numBatches, false);
     for (int attempt = 1; attempt <= kGetBalances16MaxAttempts; ++attempt)
     {
-        bool ok = false;
+        std::vector<size_t> pending;
+        for (size_t b = 0; b < numBatches; b++)
+            if (!done[b])
+                pending.push_back(b);
+        if (pending.empty())
+            break;
+#ifdef _DEBUG
+        if (attempt > 1)
+            LOG("WARNING: %zu GetBalances16 batch(es) failed; retrying (attempt %d/%d)...\n",
+                pending.size(), attempt, kGetBalances16MaxAttempts);
+#endif
+        if (attempt > 1)
+        {
+            // back off based on the node's round-trip time
+            std::this_thread::sleep_for(std::chrono::milliseconds(getNodeRetryDelayMsec(nodeIp, nodePort, attempt - 1)));
+        }
+
+        std::vector<GetBalances16_input> pendingInputs(pending.size());
+        std::vector<GetBalances16_output> pendingOutputs(pending.size());
+        for (size_t i = 0; i < pending.size(); i++)
+            pendingInputs[i] = inputs[pending[i]];
+        std::vector<bool> ok;
         try
         {
-            ok = runContractFunction(nodeIp, nodePort, QUTIL_CONTRACT_ID, qutilFunctionId::GetBalances16,
-                input, sizeof(GetBalances16_input), output, sizeof(GetBalances16_output));
+            ok = runContractFunctionMany(nodeIp, nodePort, QUTIL_CONTRACT_ID, qutilFunctionId::GetBalances16,
+                pendingInputs.data(), sizeof(GetBalances16_input), pendingOutputs.data(), sizeof(GetBalances16_output),
+                pending.size());
         }
         catch (...)
         {
 #ifdef _DEBUG
-            LOG("WARNING: GetBalances16 batch %zu/%zu: connection or response error.\n", batchIndex1Based, numBatches);
+            LOG("WARNING: GetBalances16: connection error.\n");
 #endif
-            ok = false;
+            continue;
         }
-        if (ok)
-            return true;
-        if (attempt < kGetBalances16MaxAttempts)
+        for (size_t i = 0; i < pending.size(); i++)
         {
-#ifdef _DEBUG
-            LOG("WARNING: GetBalances16 batch %zu/%zu: attempt %d/%d failed; retrying...\n",
-                batchIndex1Based, numBatches, attempt, kGetBalances16MaxAttempts);
-#endif
+            if (ok[i])
+            {
+                outputs[pending[i]] = pendingOutputs[i];
+                done[pending[i]] = true;
+            }
         }
     }
-    return false;
+
+    return done;
 }
 
 static bool readIdentityList(const char* path, std::vector<std::string>& identities, std::string& error)
@@ -159,9 +188,11 @@ static bool readIdentityList(const char* path, std::vector<std::string>& identit
     return !identities.empty();
 }
 
-bool readPayoutList(const char* payoutListFile, std::vector<std::string>& addresses, std::vector<int64_t>& amounts, std::string& error)
+bool readPayoutList(const char* payoutListFile, std::vector<std::array<uint8_t, 32>>& publicKeys, std::vector<int64_t>& amounts, std::string& error)
 {
-    addresses.resize(0);
+    std::vector<std::string> addresses;
+    std::vector<uint64_t> lineNos;
+    publicKeys.resize(0);
     amounts.resize(0);
     std::ifstream infile(payoutListFile);
     if (!infile.is_open())
@@ -192,8 +223,28 @@ bool readPayoutList(const char* payoutListFile, std::vector<std::string>& addres
             return false;
         }
         addresses.push_back(a);
+        lineNos.push_back(lineNo);
         amounts.push_back(b);
     }
+
+    std::vector<const char*> identities(addresses.size());
+    std::vector<uint8_t*> keys(addresses.size());
+    std::vector<uint8_t> valid((addresses.size() + 7) / 8);
+    publicKeys.resize(addresses.size());
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        identities[i] = addresses[i].c_str();
+        keys[i] = publicKeys[i].data();
+    }
+    getPublicKeysFromIdentities(identities.data(), keys.data(), addresses.size(), valid.data());
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        if (!(valid[i / 8] & (1 << (i % 8))))
+        {
+            error = "invalid identity at line " + std::to_string(lineNos[i]) + ", expected 60 uppercase letters with a correct checksum";
+            return false;
+        }
+    }
     return true;
 }
 
@@ -287,7 +338,7 @@ void qutilSendToManyV1(const char* nodeIp, int nodePort, const char* seed, const
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    std::vector<std::string> addresses;
+    std::vector<std::array<uint8_t, 32>> addresses;
     std::vector<int64_t> amounts;
     std::string parseError;
     if (!readPayoutList(payoutListFile, addresses, amounts, parseError))
@@ -299,17 +350,14 @@ void qutilSendToManyV1(const char* nodeIp, int nodePort, const char* seed, const
     {
         LOG("WARNING: payout list has more than 25 addresses, only the first 25 addresses will be paid\n");
     }
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QUTIL_CONTRACT_ID;
@@ -327,7 +375,7 @@ void qutilSendToManyV1(const char* nodeIp, int nodePort, const char* seed, const
     packet.transaction.amount = 0;
     for (int i = 0; i < std::min(25, int(addresses.size())); i++)
     {
-        getPublicKeyFromIdentity(addresses[i].data(), packet.stm.addresses[i]);
+        memcpy(packet.stm.addresses[i], addresses[i].data(), 32);
         packet.stm.amounts[i] = amounts[i];
         packet.transaction.amount += amounts[i];
     }
@@ -346,7 +394,7 @@ void qutilSendToManyV1(const char* nodeIp, int nodePort, const char* seed, const
                    sizeof(packet.transaction) + sizeof(SendToManyV1_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -369,7 +417,7 @@ void qutilTransferSharesToManyV1(const char* nodeIp, int nodePort, const char* s
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    std::vector<std::string> addresses;
+    std::vector<std::array<uint8_t, 32>> addresses;
     std::vector<int64_t> amounts;
     std::string parseError;
     if (!readPayoutList(payoutListFile, addresses, amounts, parseError))
@@ -387,16 +435,13 @@ void qutilTransferSharesToManyV1(const char* nodeIp, int nodePort, const char* s
         LOG("WARNING: payout list has more than 24 addresses, only the first 24 entries will be used\n");
     }
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     ((uint64_t*)destPublicKey)[0] = QUTIL_CONTRACT_ID;
     ((uint64_t*)destPublicKey)[1] = 0;
     ((uint64_t*)destPublicKey)[2] = 0;
@@ -415,7 +460,7 @@ void qutilTransferSharesToManyV1(const char* nodeIp, int nodePort, const char* s
 
     for (int i = 0; i < std::min(24, int(addresses.size())); i++)
     {
-        getPublicKeyFromIdentity(addresses[i].data(), packet.tsm.addresses[i]);
+        memcpy(packet.tsm.addresses[i], addresses[i].data(), 32);
         packet.tsm.amounts[i] = amounts[i];
     }
 
@@ -432,7 +477,7 @@ void qutilTransferSharesToManyV1(const char* nodeIp, int nodePort, const char* s
                    sizeof(packet.transaction) + sizeof(TransferSharesToManyV1_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -469,14 +514,14 @@ void qutilTransferSharesManagementRights(const char* nodeIp, int nodePort, const
         invocationQu, sizeof(input), &input, scheduledTickOffset);
 }
 
-void qutilGetBalancesMany(const char* nodeIp, int nodePort, const char* identitiesFile)
+bool qutilGetBalancesMany(const char* nodeIp, int nodePort, const char* identitiesFile)
 {
     std::vector<std::string> identities;
     std::string err;
     if (!readIdentityList(identitiesFile, identities, err))
     {
         LOG("ERROR: %s\n", err.c_str());
-        return;
+        return false;
     }
 
     constexpr size_t kBatch = 16;
@@ -484,46 +529,51 @@ void qutilGetBalancesMany(const char* nodeIp, int nodePort, const char* identiti
     if (numBatches > 1)
         LOG("%zu identities, %zu GetBalances16 request(s).\n", identities.size(), numBatches);
 
+    std::vector<GetBalances16_input> inputs(numBatches);
+    std::vector<GetBalances16_output> outputs(numBatches);
+    memset(inputs.data(), 0, numBatches * sizeof(GetBalances16_input));
+    memset(outputs.data(), 0, numBatches * sizeof(GetBalances16_output));
+    for (size_t i = 0; i < identities.size(); i++)
+        getPublicKeyFromIdentity(identities[i].c_str(), inputs[i / kBatch].publicKeys[i % kBatch]);
+
+    const std::vector<bool> done = getBalances16Batches(nodeIp, nodePort, inputs, outputs);
+
+    std::vector<std::string> failed;
     for (size_t b = 0; b < numBatches; b++)
     {
         const size_t offset = b * kBatch;
         const size_t count = std::min(kBatch, identities.size() - offset);
-
-        GetBalances16_input input{};
-        memset(&input, 0, sizeof(input));
         for (size_t i = 0; i < count; i++)
-            getPublicKeyFromIdentity(identities[offset + i].c_str(), input.publicKeys[i]);
-
-        GetBalances16_output output{};
-        memset(&output, 0, sizeof(output));
-
-        if (!tryGetBalances16Batch(nodeIp, nodePort, &input, &output, b + 1, numBatches))
         {
-            LOG("ERROR: GetBalances16 batch %zu / %zu failed after %d attempts.\n",
-                b + 1, numBatches, kGetBalances16MaxAttempts);
-            return;
+            if (done[b])
+                LOG("%s  %" PRIi64 "\n", identities[offset + i].c_str(), outputs[b].balances[i]);
+            else
+                failed.push_back(identities[offset + i]);
         }
-
-        for (size_t i = 0; i < count; i++)
-            LOG("%s  %" PRIi64 "\n", identities[offset + i].c_str(), output.balances[i]);
     }
+    if (!failed.empty())
+    {
+        LOG("ERROR: GetBalances16 failed after %d attempts for %zu identities:\n",
+            kGetBalances16MaxAttempts, failed.size());
+        for (const auto& identity : failed)
+            LOG("%s\n", identity.c_str());
+        return false;
+    }
+    return true;
 }
 
 void qutilBurnQubic(const char* nodeIp, int nodePort, const char* seed, long long amount, uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QUTIL_CONTRACT_ID;
@@ -549,7 +599,7 @@ void qutilBurnQubic(const char* nodeIp, int nodePort, const char* seed, long lon
                    sizeof(packet.transaction) + sizeof(BurnQubic_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -597,17 +647,14 @@ void qutilSendToManyBenchmark(const char* nodeIp, int nodePort, const char* seed
 
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
     char publicIdentity[128] = { 0 };
     char txHash[128] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QUTIL_CONTRACT_ID;
@@ -635,7 +682,7 @@ void qutilSendToManyBenchmark(const char* nodeIp, int nodePort, const char* seed
         sizeof(packet.transaction) + sizeof(SendToManyBenchmark_input),
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -784,16 +831,13 @@ void qutilCreatePoll(const char* nodeIp, int nodePort, const char* seed,
     if (!getFees(qc, fees))
         return;
 
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint8_t destPublicKey[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
     char txHash[128] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     ((uint64_t*)destPublicKey)[0] = QUTIL_CONTRACT_ID;
 
     struct
@@ -816,7 +860,7 @@ void qutilCreatePoll(const char* nodeIp, int nodePort, const char* seed,
         sizeof(packet.transaction) + sizeof(input),
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -851,12 +895,9 @@ void qutilVote(const char* nodeIp, int nodePort, const char* seed,
     Vote_input input;
     memset(&input, 0, sizeof(input));
     input.poll_id = poll_id;
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     memcpy(input.address, sourcePublicKey, 32);
     input.amount = amount;
     input.chosen_option = chosen_option;
@@ -887,7 +928,7 @@ void qutilVote(const char* nodeIp, int nodePort, const char* seed,
                     sizeof(packet.transaction) + sizeof(input),
                     digest,
                     32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -1133,12 +1174,9 @@ void qutilCancelPoll(const char* nodeIp, int nodePort, const char* seed, uint64_
 
     CancelPoll_input input;
     input.poll_id = poll_id;
-    uint8_t subseed[32] = { 0 };
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     uint8_t destPublicKey[32] = { 0 };
     ((uint64_t*)destPublicKey)[0] = QUTIL_CONTRACT_ID;
@@ -1166,7 +1204,7 @@ void qutilCancelPoll(const char* nodeIp, int nodePort, const char* seed, uint64_
                     sizeof(packet.transaction) + sizeof(CancelPoll_input),
                     digest,
                     32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -170,4 +170,6 @@ void qutilCancelPoll(const char* nodeIp, int nodePort, const char* seed, uint64_
 
 void qutilPrintFees(const char* nodeIp, int nodePort);
 
-void qutilGetBalancesMany(const char* nodeIp, int nodePort, const char* identitiesFile);
+// Print the balances of the identities in the file (one per line). Return false if a balance could not be queried;
+// the identities concerned are listed after the others.
+bool qutilGetBalancesMany(const char* nodeIp, int nodePort, const char* identitiesFile);
@@ -138,17 +138,14 @@ void submitAuthAddress(const char* nodeIp, int nodePort, const char* seed, uint3
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -176,7 +173,7 @@ void submitAuthAddress(const char* nodeIp, int nodePort, const char* seed, uint3
                    sizeof(packet.transaction) + sizeof(submitAuthAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -197,17 +194,14 @@ void changeAuthAddress(const char* nodeIp, int nodePort, const char* seed, uint3
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -235,7 +229,7 @@ void changeAuthAddress(const char* nodeIp, int nodePort, const char* seed, uint3
                    sizeof(packet.transaction) + sizeof(changeAuthAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -256,17 +250,14 @@ void submitFees(const char* nodeIp, int nodePort, const char* seed, uint32_t sch
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -296,7 +287,7 @@ void submitFees(const char* nodeIp, int nodePort, const char* seed, uint32_t sch
                    sizeof(packet.transaction) + sizeof(submitFees_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -317,17 +308,14 @@ void changeFees(const char* nodeIp, int nodePort, const char* seed, uint32_t sch
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -357,7 +345,7 @@ void changeFees(const char* nodeIp, int nodePort, const char* seed, uint32_t sch
                    sizeof(packet.transaction) + sizeof(changeFees_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -381,17 +369,14 @@ void submitReinvestingAddress(const char* nodeIp, int nodePort, const char* seed
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -419,7 +404,7 @@ void submitReinvestingAddress(const char* nodeIp, int nodePort, const char* seed
                    sizeof(packet.transaction) + sizeof(submitReinvestingAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -443,17 +428,14 @@ void changeReinvestingAddress(const char* nodeIp, int nodePort, const char* seed
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -481,7 +463,7 @@ void changeReinvestingAddress(const char* nodeIp, int nodePort, const char* seed
                    sizeof(packet.transaction) + sizeof(changeReinvestingAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -505,17 +487,14 @@ void submitAdminAddress(const char* nodeIp, int nodePort, const char* seed,  uin
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -543,7 +522,7 @@ void submitAdminAddress(const char* nodeIp, int nodePort, const char* seed,  uin
                    sizeof(packet.transaction) + sizeof(submitAdminAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -567,17 +546,14 @@ void changeAdminAddress(const char* nodeIp, int nodePort, const char* seed,  uin
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -605,7 +581,7 @@ void changeAdminAddress(const char* nodeIp, int nodePort, const char* seed,  uin
                    sizeof(packet.transaction) + sizeof(changeAdminAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -724,17 +700,14 @@ void submitBannedAddress(const char* nodeIp, int nodePort, const char* seed,  ui
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -762,7 +735,7 @@ void submitBannedAddress(const char* nodeIp, int nodePort, const char* seed,  ui
                    sizeof(packet.transaction) + sizeof(submitBannedAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -786,17 +759,14 @@ void saveBannedAddress(const char* nodeIp, int nodePort, const char* seed,  uint
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -824,7 +794,7 @@ void saveBannedAddress(const char* nodeIp, int nodePort, const char* seed,  uint
                    sizeof(packet.transaction) + sizeof(saveBannedAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -848,17 +818,14 @@ void submitUnbannedannedAddress(const char* nodeIp, int nodePort, const char* se
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -886,7 +853,7 @@ void submitUnbannedannedAddress(const char* nodeIp, int nodePort, const char* se
                    sizeof(packet.transaction) + sizeof(submitUnbannedAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
@@ -910,17 +877,14 @@ void saveUnbannedAddress(const char* nodeIp, int nodePort, const char* seed,  ui
     uint8_t publicKey[32] = {0};
     getPublicKeyFromIdentity(identity, publicKey);
 
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};  
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     ((uint64_t*)destPublicKey)[0] = QVAULT_CONTRACT_INDEX;
@@ -948,7 +912,7 @@ void saveUnbannedAddress(const char* nodeIp, int nodePort, const char* seed,  ui
                    sizeof(packet.transaction) + sizeof(unblockBannedAddress_input),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
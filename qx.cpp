@@ -81,16 +81,13 @@ void qxIssueAsset(const char* nodeIp, int nodePort,
     char UoMS1[8] = {0};
     memcpy(assetNameS1, assetName, strlen(assetName));
     for (int i = 0; i < 7; i++) UoMS1[i] = unitOfMeasurement[i] - 48;
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QX_ADDRESS, destPublicKey);
 
     struct {
@@ -126,7 +123,7 @@ void qxIssueAsset(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(IssueAsset_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(IssueAsset_input)+ SIGNATURE_SIZE);
@@ -154,10 +151,8 @@ void qxTransferAsset(const char* nodeIp, int nodePort,
                      uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -173,9 +168,8 @@ void qxTransferAsset(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QX_ADDRESS, destPublicKey);
     getPublicKeyFromIdentity(newOwnerIdentity, newOwnerPublicKey);
     struct {
@@ -203,7 +197,7 @@ void qxTransferAsset(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(TransferAssetOwnershipAndPossession_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(TransferAssetOwnershipAndPossession_input)+ SIGNATURE_SIZE);
@@ -231,10 +225,8 @@ void qxOrderAction(const char* nodeIp, int nodePort,
                    uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subSeed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     uint8_t issuer[32] = {0};
@@ -248,9 +240,8 @@ void qxOrderAction(const char* nodeIp, int nodePort,
     }
     getPublicKeyFromIdentity(pIssuerInQubicFormat, issuer);
 
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     getPublicKeyFromIdentity(QX_ADDRESS, destPublicKey);
     struct {
         RequestResponseHeader header;
@@ -291,7 +282,7 @@ void qxOrderAction(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + sizeof(qxOrderAction_input),
                    digest,
                    32);
-    sign(subSeed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.sig, signature, SIGNATURE_SIZE);
     // set header
     packet.header.setSize(sizeof(packet.header)+sizeof(Transaction)+sizeof(qxOrderAction_input)+ SIGNATURE_SIZE);
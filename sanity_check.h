@@ -3,6 +3,7 @@
 #include <cinttypes>
 #include <fstream>
 
+#include "cpu_features.h"
 #include "logger.h"
 
 static bool isValidIpAddress(char* ipAddress)
@@ -150,6 +151,16 @@ static void sanityFileExist (const std::string name)
     }
 }
 
+// Like sanityFileExist() for a tick data file, which can also be given as <ARCHIVE>@<TICK>
+static void sanityTickFileExist(const std::string name)
+{
+    size_t at = name.rfind('@');
+    if (std::ifstream(name.c_str()).good() || at == std::string::npos)
+        sanityFileExist(name);
+    else
+        sanityFileExist(name.substr(0, at));
+}
+
 static void sanityCheckSpecialCommand(int cmd)
 {
     if (cmd == -1)
@@ -159,6 +170,19 @@ static void sanityCheckSpecialCommand(int cmd)
     }
 }
 
+// The commands using the core headers (oracle_utils.cpp, qpi_adapter.cpp) are built with AVX2, the rest of the binary
+// runs on any x86-64 CPU.
+static void sanityCheckCpuAvx2()
+{
+#if defined(CPU_X86_KERNELS) && !defined(_MSC_VER)
+    if (detectCpuLevel() < CPU_LEVEL_AVX2)
+    {
+        LOG("This command requires a CPU with AVX2\n");
+        exit(1);
+    }
+#endif
+}
+
 static void sanityCheckNumberOfUnit(long long unit)
 {
     if (unit <= 0)
@@ -231,6 +231,12 @@ enum COMMAND
     ESCROW_CANCEL_DEAL_CMD,
     ESCROW_TRANSFER_RIGHTS_CMD,
     ESCROW_GET_FREE_ASSET_CMD,
+    GET_NODE_LATENCY,
+    DERIVE_KEYS,
+    GET_TICK_RANGE_TO_ARCHIVE,
+    BUILD_TX_INDEX,
+    LOOKUP_TX_INDEX,
+    FOLLOW_TICKS,
     TOTAL_COMMAND // DO NOT CHANGE THIS
 };
 
@@ -260,6 +266,11 @@ public:
         return _dejavu;
     }
 
+    inline void setDejavu(unsigned int dejavu)
+    {
+        _dejavu = dejavu;
+    }
+
     inline bool isDejavuZero() const
     {
         return !_dejavu;
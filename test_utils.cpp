@@ -1,11 +1,14 @@
 #include <vector>
 #include <array>
 #include <cinttypes>
+#include <chrono>
+#include <thread>
 
 #include "test_utils.h"
 #include "node_utils.h"
 #include "connection.h"
 #include "logger.h"
+#include "node_rtt.h"
 #include "key_utils.h"
 #include "k12_and_key_utils.h"
 #include "wallet_utils.h"
@@ -141,16 +144,13 @@ bool qpiFunctionsOutputMatchesTick(const QpiFunctionsOutput& qpiOutput, const Ti
 
 std::vector<std::array<char, 128>> queryQpiFunctionsOutputToState(QCPtr qc, const char* seed, uint32_t firstScheduledTick, uint32_t numTicks)
 {
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint64_t destPublicKey[4] = { TESTEXA_CONTRACT_INDEX, 0, 0, 0 };
-    uint8_t subSeed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
     char txHash[128] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subSeed);
-    getPrivateKeyFromSubSeed(subSeed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     struct {
         RequestResponseHeader header;
@@ -176,7 +176,7 @@ std::vector<std::array<char, 128>> queryQpiFunctionsOutputToState(QCPtr qc, cons
             sizeof(Transaction),
             digest,
             32);
-        sign(subSeed, sourcePublicKey, digest, signature);
+        signer.sign(digest, signature);
         memcpy(packet.sig, signature, SIGNATURE_SIZE);
 
         qc->sendData((uint8_t*)&packet, packet.header.size());
@@ -275,6 +275,8 @@ static void queryAndMatchQpiFunctionsOutput(QCPtr qc, uint32_t firstQueriedTick,
             {
                 if (retryCtr == 0)
                     break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(
+                    getNodeRetryDelayMsec(qc->nodeIp(), qc->nodePort(), numRetries - retryCtr + 1)));
                 qc->resolveConnection();
                 retryCtr--;
             }
@@ -284,6 +286,8 @@ static void queryAndMatchQpiFunctionsOutput(QCPtr qc, uint32_t firstQueriedTick,
         {
             if (retryCtr == 0)
                 break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                getNodeRetryDelayMsec(qc->nodeIp(), qc->nodePort(), numRetries - retryCtr + 1)));
             qc->resolveConnection();
             retryCtr--;
         }
@@ -0,0 +1,637 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tick_archive.h"
+#include "tick_download.h"
+#include "defines.h"
+#include "structs.h"
+#include "event_loop.h"
+#include "logger.h"
+#include "node_rtt.h"
+#include "node_set.h"
+
+// connections per node, so a slow response doesn't hold back all ticks pipelined behind it
+#define TICK_ARCHIVE_CONNECTIONS_PER_NODE 4
+// attempts per tick before giving up on it for this run
+#define TICK_ARCHIVE_MAX_ATTEMPTS 8
+// nodes that must have no tick data for a tick before it is archived as empty
+#define TICK_ARCHIVE_EMPTY_CONFIRMATIONS 2
+// seconds between progress messages
+#define TICK_ARCHIVE_PROGRESS_INTERVAL 5
+
+static_assert(offsetof(TickArchiveRecord, signature) == offsetof(TickData, transactionDigests),
+              "TickArchiveRecord must start with the fields of TickData before transactionDigests");
+static_assert(sizeof(TickArchiveRecord) % 8 == 0, "contract fees after the digests must be aligned");
+
+static bool seekFile(FILE* f, uint64_t offset, int origin)
+{
+#ifdef _MSC_VER
+    return _fseeki64(f, (long long)offset, origin) == 0;
+#else
+    return fseeko(f, (off_t)offset, origin) == 0;
+#endif
+}
+
+static uint64_t tellFile(FILE* f)
+{
+#ifdef _MSC_VER
+    return (uint64_t)_ftelli64(f);
+#else
+    return (uint64_t)ftello(f);
+#endif
+}
+
+static std::string segmentFileName(const std::string& dir, uint32_t firstTick)
+{
+    return (std::filesystem::path(dir) / (std::to_string(firstTick) + TICK_ARCHIVE_SEGMENT_EXTENSION)).string();
+}
+
+static bool isValidSegmentHeader(const TickArchiveSegmentHeader& header)
+{
+    return header.magic == TICK_ARCHIVE_MAGIC && header.version == TICK_ARCHIVE_VERSION && header.numTicks > 0
+        && header.numTicks <= TICK_ARCHIVE_SEGMENT_TICKS && header.firstTick % TICK_ARCHIVE_SEGMENT_TICKS == 0;
+}
+
+const Transaction* ArchivedTick::transaction(unsigned int i) const
+{
+    if (mOffsets[i + 1] == mOffsets[i])
+        return nullptr;
+    return (const Transaction*)(mTransactions + mOffsets[i]);
+}
+
+void ArchivedTick::getTickData(TickData& td) const
+{
+    memset(&td, 0, sizeof(TickData));
+    td.tick = mTick;
+    if (!mRecord)
+        return;
+    memcpy(&td, mRecord, offsetof(TickData, transactionDigests));
+    memcpy(td.transactionDigests, mDigests, size_t(mRecord->numTransactions) * 32);
+    memcpy(td.contractFees, mContractFees, size_t(mRecord->numContractFees) * sizeof(long long));
+    memcpy(td.signature, mRecord->signature, SIGNATURE_SIZE);
+}
+
+bool TickArchive::open(const char* path)
+{
+    mSegments.clear();
+    std::vector<std::string> fileNames;
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(path, ec))
+        {
+            if (entry.path().extension() == TICK_ARCHIVE_SEGMENT_EXTENSION)
+                fileNames.push_back(entry.path().string());
+        }
+    }
+    else
+    {
+        fileNames.push_back(path);
+    }
+
+    for (const auto& fileName : fileNames)
+    {
+        Segment segment;
+        segment.fileName = fileName;
+        segment.file = std::make_unique<MappedFile>();
+        if (!segment.file->open(fileName.c_str()) || segment.file->size() < sizeof(TickArchiveSegmentHeader))
+            continue;
+        segment.header = (const TickArchiveSegmentHeader*)segment.file->data();
+        // other files, such as tick files of -gettickdata, are silently ignored
+        if (segment.header->magic != TICK_ARCHIVE_MAGIC)
+            continue;
+        if (!isValidSegmentHeader(*segment.header)
+            || segment.file->size() < sizeof(TickArchiveSegmentHeader) + segment.header->numTicks * sizeof(TickArchiveIndexEntry))
+        {
+            LOG("%s is not a tick archive segment of this version\n", fileName.c_str());
+            continue;
+        }
+        segment.index = (const TickArchiveIndexEntry*)(segment.file->data() + sizeof(TickArchiveSegmentHeader));
+        uint32_t firstTick = segment.header->firstTick;
+        mSegments[firstTick] = std::move(segment);
+    }
+    return !mSegments.empty();
+}
+
+std::vector<uint32_t> TickArchive::ticks() const
+{
+    std::vector<uint32_t> result;
+    for (const auto& it : mSegments)
+    {
+        const Segment& segment = it.second;
+        for (uint32_t i = 0; i < segment.header->numTicks; i++)
+        {
+            if (segment.index[i].flags)
+                result.push_back(segment.header->firstTick + i);
+        }
+    }
+    return result;
+}
+
+bool TickArchive::getTick(uint32_t tick, ArchivedTick& result) const
+{
+    auto it = mSegments.upper_bound(tick);
+    if (it == mSegments.begin())
+        return false;
+    --it;
+    const Segment& segment = it->second;
+    if (tick - segment.header->firstTick >= segment.header->numTicks)
+        return false;
+    const TickArchiveIndexEntry& entry = segment.index[tick - segment.header->firstTick];
+    result = ArchivedTick();
+    result.mTick = tick;
+    if (entry.flags & TICK_ARCHIVE_EMPTY)
+        return true;
+    if (!(entry.flags & TICK_ARCHIVE_STORED))
+        return false;
+
+    // check the record, so the accessors of ArchivedTick stay within the mapping
+    const size_t fileSize = segment.file->size();
+    const TickArchiveRecord* record = (const TickArchiveRecord*)(segment.file->data() + entry.offset);
+    size_t tablesSize = 0;
+    bool valid = entry.offset % 8 == 0 && entry.offset <= fileSize && entry.size <= fileSize - entry.offset
+        && entry.size >= sizeof(TickArchiveRecord);
+    if (valid)
+    {
+        valid = record->tick == tick && record->numTransactions <= NUMBER_OF_TRANSACTIONS_PER_TICK
+            && record->numContractFees <= 1024;
+        tablesSize = sizeof(TickArchiveRecord) + size_t(record->numTransactions) * 32
+            + size_t(record->numContractFees) * sizeof(long long) + (size_t(record->numTransactions) + 1) * 4;
+        valid = valid && tablesSize <= entry.size;
+    }
+    if (valid)
+    {
+        const uint8_t* p = (const uint8_t*)record + sizeof(TickArchiveRecord);
+        result.mRecord = record;
+        result.mDigests = p;
+        p += size_t(record->numTransactions) * 32;
+        result.mContractFees = (const long long*)p;
+        p += size_t(record->numContractFees) * sizeof(long long);
+        result.mOffsets = (const unsigned int*)p;
+        result.mTransactions = (const uint8_t*)record + tablesSize;
+        valid = result.mOffsets[0] == 0 && result.mOffsets[record->numTransactions] <= entry.size - tablesSize;
+        // each transaction must span exactly its input and signature, so the readers of its input stay in the record
+        for (unsigned int i = 0; valid && i < record->numTransactions; i++)
+        {
+            valid = result.mOffsets[i] <= result.mOffsets[i + 1];
+            const unsigned int span = result.mOffsets[i + 1] - result.mOffsets[i];
+            if (valid && span)
+            {
+                const Transaction* tx = (const Transaction*)(result.mTransactions + result.mOffsets[i]);
+                valid = span >= sizeof(Transaction) + SIGNATURE_SIZE && tx->inputSize <= MAX_INPUT_SIZE
+                    && span == sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE;
+            }
+        }
+    }
+    if (!valid)
+    {
+        LOG("Invalid record of tick %u in %s\n", tick, segment.fileName.c_str());
+        result = ArchivedTick();
+        return false;
+    }
+    return true;
+}
+
+bool isTickArchive(const char* path)
+{
+    TickArchive archive;
+    return archive.open(path);
+}
+
+TickArchiveWriter::~TickArchiveWriter()
+{
+    close();
+}
+
+bool TickArchiveWriter::open(const char* dir)
+{
+    close();
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec)
+    {
+        LOG("Failed to create directory %s: %s\n", dir, ec.message().c_str());
+        return false;
+    }
+    mDir = dir;
+    return true;
+}
+
+void TickArchiveWriter::close()
+{
+    for (auto& it : mSegments)
+    {
+        if (it.second.file)
+            fclose(it.second.file);
+    }
+    mSegments.clear();
+    mInvalidSegments.clear();
+}
+
+TickArchiveWriter::Segment* TickArchiveWriter::getSegment(uint32_t tick, bool create)
+{
+    const uint32_t firstTick = tick - tick % TICK_ARCHIVE_SEGMENT_TICKS;
+    auto it = mSegments.find(firstTick);
+    if (it != mSegments.end())
+        return &it->second;
+    if (mInvalidSegments.count(firstTick))
+        return nullptr;
+
+    Segment segment;
+    segment.index.resize(TICK_ARCHIVE_SEGMENT_TICKS);
+    std::string fileName = segmentFileName(mDir, firstTick);
+    segment.file = fopen(fileName.c_str(), "r+b");
+    if (segment.file)
+    {
+        TickArchiveSegmentHeader header;
+        if (fread(&header, sizeof(header), 1, segment.file) != 1 || !isValidSegmentHeader(header)
+            || header.firstTick != firstTick || header.numTicks != TICK_ARCHIVE_SEGMENT_TICKS
+            || fread(segment.index.data(), sizeof(TickArchiveIndexEntry), segment.index.size(), segment.file) != segment.index.size())
+        {
+            LOG("%s is not a tick archive segment of this version\n", fileName.c_str());
+            fclose(segment.file);
+            mInvalidSegments.insert(firstTick);
+            return nullptr;
+        }
+    }
+    else
+    {
+        if (!create)
+            return nullptr;
+        segment.file = fopen(fileName.c_str(), "w+b");
+        if (!segment.file)
+        {
+            LOG("Failed to create %s\n", fileName.c_str());
+            return nullptr;
+        }
+        TickArchiveSegmentHeader header = { TICK_ARCHIVE_MAGIC, TICK_ARCHIVE_VERSION, firstTick, TICK_ARCHIVE_SEGMENT_TICKS };
+        if (fwrite(&header, sizeof(header), 1, segment.file) != 1
+            || fwrite(segment.index.data(), sizeof(TickArchiveIndexEntry), segment.index.size(), segment.file) != segment.index.size()
+            || fflush(segment.file) != 0)
+        {
+            LOG("Failed to write %s\n", fileName.c_str());
+            fclose(segment.file);
+            return nullptr;
+        }
+    }
+    return &(mSegments[firstTick] = std::move(segment));
+}
+
+bool TickArchiveWriter::isArchived(uint32_t tick)
+{
+    Segment* segment = getSegment(tick, false);
+    return segment && segment->index[tick % TICK_ARCHIVE_SEGMENT_TICKS].flags != 0;
+}
+
+bool TickArchiveWriter::append(uint32_t tick, const TickData* td, const uint8_t* const* transactions,
+                               const unsigned int* sizes)
+{
+    Segment* segment = getSegment(tick, true);
+    if (!segment)
+        return false;
+    TickArchiveIndexEntry entry = { 0, 0, TICK_ARCHIVE_EMPTY };
+    if (td)
+    {
+        const uint8_t allZero[32] = { 0 };
+        unsigned int numTransactions = NUMBER_OF_TRANSACTIONS_PER_TICK;
+        while (numTransactions > 0 && memcmp(td->transactionDigests[numTransactions - 1], allZero, 32) == 0)
+            numTransactions--;
+        unsigned int numContractFees = 1024;
+        while (numContractFees > 0 && td->contractFees[numContractFees - 1] == 0)
+            numContractFees--;
+
+        TickArchiveRecord record;
+        memset(&record, 0, sizeof(record));
+        memcpy(&record, td, offsetof(TickData, transactionDigests));
+        memcpy(record.signature, td->signature, SIGNATURE_SIZE);
+        record.numTransactions = numTransactions;
+        record.numContractFees = numContractFees;
+
+        std::vector<unsigned int> offsets(numTransactions + 1, 0);
+        for (unsigned int i = 0; i < numTransactions; i++)
+        {
+            bool zero = memcmp(td->transactionDigests[i], allZero, 32) == 0;
+            offsets[i + 1] = offsets[i] + (zero ? 0 : sizes[i]);
+        }
+        mRecord.clear();
+        mRecord.insert(mRecord.end(), (const uint8_t*)&record, (const uint8_t*)&record + sizeof(record));
+        mRecord.insert(mRecord.end(), td->transactionDigests[0], td->transactionDigests[0] + size_t(numTransactions) * 32);
+        mRecord.insert(mRecord.end(), (const uint8_t*)td->contractFees,
+                       (const uint8_t*)(td->contractFees + numContractFees));
+        mRecord.insert(mRecord.end(), (const uint8_t*)offsets.data(), (const uint8_t*)(offsets.data() + offsets.size()));
+        for (unsigned int i = 0; i < numTransactions; i++)
+        {
+            if (offsets[i + 1] != offsets[i])
+                mRecord.insert(mRecord.end(), transactions[i], transactions[i] + sizes[i]);
+        }
+        entry.size = uint32_t(mRecord.size());
+        entry.flags = TICK_ARCHIVE_STORED;
+        // records start 8-byte aligned, so the contract fees can be read in place
+        mRecord.resize((mRecord.size() + 7) & ~size_t(7), 0);
+
+        if (!seekFile(segment->file, 0, SEEK_END))
+            return false;
+        entry.offset = (tellFile(segment->file) + 7) & ~uint64_t(7);
+        const uint8_t padding[8] = { 0 };
+        size_t paddingSize = size_t(entry.offset - tellFile(segment->file));
+        if ((paddingSize && fwrite(padding, paddingSize, 1, segment->file) != 1)
+            || fwrite(mRecord.data(), mRecord.size(), 1, segment->file) != 1 || fflush(segment->file) != 0)
+            return false;
+    }
+
+    // write the index entry after the record, so the tick is only archived if the record is complete
+    const uint32_t slot = tick % TICK_ARCHIVE_SEGMENT_TICKS;
+    if (!seekFile(segment->file, sizeof(TickArchiveSegmentHeader) + uint64_t(slot) * sizeof(TickArchiveIndexEntry), SEEK_SET)
+        || fwrite(&entry, sizeof(entry), 1, segment->file) != 1 || fflush(segment->file) != 0)
+        return false;
+    segment->index[slot] = entry;
+    return true;
+}
+
+bool openTickArchivePath(const char* fileName, TickArchive& archive, std::vector<uint32_t>& ticks)
+{
+    std::string path = fileName;
+    uint32_t selectedTick = 0;
+    bool selected = false;
+    size_t at = path.rfind('@');
+    if (at != std::string::npos && at + 1 < path.size()
+        && path.find_first_not_of("0123456789", at + 1) == std::string::npos)
+    {
+        selectedTick = uint32_t(strtoul(path.c_str() + at + 1, nullptr, 10));
+        selected = true;
+        path.resize(at);
+    }
+    if (!archive.open(path.c_str()))
+        return false;
+    ticks.clear();
+    if (selected)
+        ticks.push_back(selectedTick);
+    else
+        ticks = archive.ticks();
+    return true;
+}
+
+void getTickRangeToArchive(const char* nodeIp, int nodePort, uint32_t fromTick, uint32_t toTick, const char* outputDir,
+                           unsigned int ticksInFlight)
+{
+    if (fromTick > toTick)
+    {
+        LOG("First tick %u is after last tick %u\n", fromTick, toTick);
+        return;
+    }
+    if (ticksInFlight == 0)
+        ticksInFlight = DEFAULT_TICKS_IN_FLIGHT;
+    std::vector<NodeAddress> nodes = g_nodeSet;
+    if (nodes.empty())
+        nodes.push_back(NodeAddress{ nodeIp, nodePort });
+
+    TickArchiveWriter archive;
+    if (!archive.open(outputDir))
+        return;
+
+    QubicEventLoop loop;
+    std::vector<AsyncQCPtr> connections;
+    const unsigned int perConnection = (ticksInFlight + TICK_ARCHIVE_CONNECTIONS_PER_NODE * unsigned(nodes.size()) - 1)
+        / (TICK_ARCHIVE_CONNECTIONS_PER_NODE * unsigned(nodes.size()));
+    for (const auto& node : nodes)
+    {
+        for (int i = 0; i < TICK_ARCHIVE_CONNECTIONS_PER_NODE; i++)
+        {
+            connections.push_back(loop.connect(node.ip.c_str(), node.port));
+            connections.back()->setMaxInFlight(perConnection);
+        }
+    }
+
+    // Only ask a node for ticks before its current tick, so that a node lagging behind isn't taken to have empty
+    // ticks. The tick storage of the nodes starts at the initial tick of the epoch.
+    std::vector<uint32_t> nodeTicks(nodes.size(), 0);
+    uint32_t highestTick = 0;
+    uint32_t initialTick = 0;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        struct
+        {
+            RequestResponseHeader header;
+        } packet;
+        packet.header.setSize(sizeof(packet));
+        packet.header.randomizeDejavu();
+        packet.header.setType(REQUEST_CURRENT_TICK_INFO);
+        try
+        {
+            CurrentTickInfo info = connections[i * TICK_ARCHIVE_CONNECTIONS_PER_NODE]
+                ->requestPacketWithHeaderAs<CurrentTickInfo>(&packet, packet.header.size()).get();
+            nodeTicks[i] = info.tick;
+            if (info.tick > highestTick)
+            {
+                highestTick = info.tick;
+                initialTick = info.initialTick;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG("Not using node %s:%d: %s\n", nodes[i].ip.c_str(), nodes[i].port, e.what());
+        }
+    }
+    if (highestTick == 0)
+    {
+        LOG("Failed to get the current tick\n");
+        return;
+    }
+    if (fromTick < initialTick)
+    {
+        LOG("Ticks before %u are not in the current epoch, starting at %u\n", initialTick, initialTick);
+        fromTick = initialTick;
+    }
+    if (toTick >= highestTick)
+    {
+        LOG("Ticks from the current tick %u on are not final, stopping at %u\n", highestTick, highestTick - 1);
+        toTick = highestTick - 1;
+    }
+
+    std::deque<uint32_t> pending;
+    for (uint64_t tick = fromTick; tick <= toTick; tick++)
+    {
+        if (!archive.isArchived(uint32_t(tick)))
+            pending.push_back(uint32_t(tick));
+    }
+    const size_t numTicks = pending.size();
+    if (fromTick <= toTick)
+        LOG("Archiving %zu ticks of %u-%u to %s, %zu already archived\n", numTicks, fromTick, toTick, outputDir,
+            size_t(toTick - fromTick + 1) - numTicks);
+    if (numTicks == 0)
+        return;
+
+    // Pick a connection to a node that has the tick and hasn't reported it as empty, starting at the given index.
+    // Return -1 if there is none.
+    auto pickConnection = [&](const TickDownload& job, size_t start)
+    {
+        for (size_t i = 0; i < connections.size(); i++)
+        {
+            size_t c = (start + i) % connections.size();
+            size_t node = c / TICK_ARCHIVE_CONNECTIONS_PER_NODE;
+            if (nodeTicks[node] > job.tick
+                && std::find(job.emptyFrom.begin(), job.emptyFrom.end(), node) == job.emptyFrom.end())
+                return c;
+        }
+        return size_t(-1);
+    };
+
+    auto queue = std::make_shared<TickDownloadQueue>();
+    std::multimap<std::chrono::steady_clock::time_point, TickDownloadPtr> retries; // by time to retry
+    size_t nextConnection = 0;
+    size_t inFlight = 0;
+    size_t numArchived = 0, numEmpty = 0, numFailed = 0, numUnconfirmed = 0, numTransactions = 0;
+    const auto startTime = std::chrono::steady_clock::now();
+    auto progressTime = startTime + std::chrono::seconds(TICK_ARCHIVE_PROGRESS_INTERVAL);
+    std::vector<const uint8_t*> ordered;
+    std::vector<unsigned int> orderedSizes;
+
+    while (!pending.empty() || !retries.empty() || inFlight)
+    {
+        // keep ticksInFlight ticks going, retries first
+        auto now = std::chrono::steady_clock::now();
+        while (inFlight < ticksInFlight)
+        {
+            TickDownloadPtr job;
+            if (!retries.empty() && retries.begin()->first <= now)
+            {
+                job = retries.begin()->second;
+                retries.erase(retries.begin());
+            }
+            else if (!pending.empty())
+            {
+                job = std::make_shared<TickDownload>();
+                job->tick = pending.front();
+                job->connection = pickConnection(*job, nextConnection++);
+                pending.pop_front();
+                if (job->connection == size_t(-1))
+                {
+                    // all nodes reported that they are behind the tick
+                    LOG("Failed to get tick %u, no node left that is past it\n", job->tick);
+                    numFailed++;
+                    continue;
+                }
+            }
+            else
+            {
+                break;
+            }
+            job->attempt++;
+            inFlight++;
+            // a pipelined request also waits for the requests sent before it on the connection
+            const AsyncQCPtr& conn = connections[job->connection];
+            requestTick(queue, conn, job, getNodeTimeoutMsec(conn->nodeIp(), conn->nodePort()) * (perConnection + 1));
+        }
+
+        std::deque<TickDownloadPtr> finished;
+        {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            auto wakeUpTime = progressTime;
+            if (!retries.empty() && inFlight < ticksInFlight)
+                wakeUpTime = std::min(wakeUpTime, retries.begin()->first);
+            if (queue->finished.empty())
+                queue->condition.wait_until(lock, wakeUpTime);
+            finished.swap(queue->finished);
+        }
+
+        for (const auto& job : finished)
+        {
+            inFlight--;
+            const AsyncQCPtr& conn = connections[job->connection];
+            const size_t node = job->connection / TICK_ARCHIVE_CONNECTIONS_PER_NODE;
+            bool complete = !job->failed;
+            if (complete && job->tickData)
+                complete = orderTickTransactions(*job, ordered, orderedSizes);
+            if (complete && !job->tickData)
+            {
+                if (job->nodeTick <= job->tick)
+                {
+                    // the node restarted or fell behind, don't ask it for this tick again
+                    LOG("Node %s:%d is at tick %u, behind tick %u\n", conn->nodeIp(), conn->nodePort(), job->nodeTick,
+                        job->tick);
+                    nodeTicks[node] = std::min(nodeTicks[node], job->nodeTick);
+                    complete = false;
+                }
+                else
+                {
+                    job->emptyFrom.push_back(node);
+                    if (job->emptyFrom.size() < TICK_ARCHIVE_EMPTY_CONFIRMATIONS)
+                    {
+                        // ask another node right away
+                        job->connection = pickConnection(*job, job->connection);
+                        if (job->connection == size_t(-1))
+                        {
+                            numUnconfirmed++;
+                            continue;
+                        }
+                        job->attempt--;
+                        retries.emplace(std::chrono::steady_clock::now(), job);
+                        continue;
+                    }
+                }
+            }
+            if (complete)
+            {
+                if (!archive.append(job->tick, job->tickData.get(), ordered.data(), orderedSizes.data()))
+                {
+                    LOG("Failed to write tick %u to %s\n", job->tick, outputDir);
+                    return;
+                }
+                if (job->tickData)
+                    numTransactions += orderedSizes.size() - std::count(orderedSizes.begin(), orderedSizes.end(), 0u);
+                else
+                    numEmpty++;
+                numArchived++;
+                continue;
+            }
+
+            if (job->attempt >= TICK_ARCHIVE_MAX_ATTEMPTS)
+            {
+                LOG("Failed to get tick %u after %d attempts, last from %s:%d\n", job->tick, job->attempt,
+                    conn->nodeIp(), conn->nodePort());
+                numFailed++;
+                continue;
+            }
+            // retry on the next node, or on another connection if there is only one
+            auto retryTime = std::chrono::steady_clock::now()
+                + std::chrono::milliseconds(getNodeRetryDelayMsec(conn->nodeIp(), conn->nodePort(), job->attempt));
+            job->connection = pickConnection(*job, job->connection
+                + ((nodes.size() > 1) ? TICK_ARCHIVE_CONNECTIONS_PER_NODE : 1));
+            if (job->connection == size_t(-1))
+            {
+                LOG("Failed to get tick %u, no node left that is past it\n", job->tick);
+                numFailed++;
+                continue;
+            }
+            retries.emplace(retryTime, job);
+        }
+
+        now = std::chrono::steady_clock::now();
+        if (now >= progressTime)
+        {
+            std::chrono::duration<double> elapsed = now - startTime;
+            LOG("Archived %zu of %zu ticks (%.1f ticks/s), %zu in flight, %zu waiting for retry\n", numArchived, numTicks,
+                numArchived / elapsed.count(), inFlight, retries.size());
+            progressTime = now + std::chrono::seconds(TICK_ARCHIVE_PROGRESS_INTERVAL);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    LOG("Archived %zu ticks (%zu empty, %zu transactions) in %.1f s (%.1f ticks/s)\n", numArchived, numEmpty,
+        numTransactions, elapsed.count(), numArchived / elapsed.count());
+    if (numFailed)
+        LOG("%zu ticks failed, run the command again to retry them\n", numFailed);
+    if (numUnconfirmed)
+        LOG("%zu ticks have no tick data on one node and no other node confirmed that they are empty, they are not "
+            "archived (use -nodeset with more nodes)\n", numUnconfirmed);
+}
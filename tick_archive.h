@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "mapped_file.h"
+#include "structs.h"
+
+// default number of ticks requested at once by getTickRangeToArchive()
+#define DEFAULT_TICKS_IN_FLIGHT 64
+
+// Tick archive: a directory of segment files <FIRST_TICK>.qta, each covering TICK_ARCHIVE_SEGMENT_TICKS consecutive
+// ticks starting at a multiple of TICK_ARCHIVE_SEGMENT_TICKS. A segment file starts with a TickArchiveSegmentHeader and
+// an index of one TickArchiveIndexEntry per tick of the segment, followed by the tick records in the order they were
+// appended. Records are only appended; the index entry of a tick is written after its record, so an interrupted write
+// leaves the tick unarchived. All integers are little endian.
+//
+// A record is a TickArchiveRecord followed by
+//   unsigned char transactionDigests[numTransactions][32]
+//   long long contractFees[numContractFees]
+//   unsigned int transactionOffsets[numTransactions + 1]
+//   the transactions (each a Transaction followed by its input and signature) in the order of the digests
+// Transaction i spans transactionOffsets[i] to transactionOffsets[i + 1], relative to the end of the offset table, which
+// is exactly sizeof(Transaction) + inputSize + SIGNATURE_SIZE bytes. It is empty if its digest is zero. The zero digests
+// and contract fees at the end of TickData are not stored.
+
+#define TICK_ARCHIVE_MAGIC 0x52415451 // "QTAR"
+#define TICK_ARCHIVE_VERSION 1
+#define TICK_ARCHIVE_SEGMENT_TICKS 10000
+#define TICK_ARCHIVE_SEGMENT_EXTENSION ".qta"
+
+struct TickArchiveSegmentHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t firstTick;
+    uint32_t numTicks; // number of index entries
+};
+
+enum TickArchiveIndexFlags : uint32_t
+{
+    TICK_ARCHIVE_STORED = 1, // the record of the tick is at offset
+    TICK_ARCHIVE_EMPTY = 2,  // the tick has no tick data, there is no record
+};
+
+struct TickArchiveIndexEntry
+{
+    uint64_t offset; // of the record in the segment file
+    uint32_t size;   // of the record
+    uint32_t flags;  // 0 if the tick is not archived
+};
+
+struct TickArchiveRecord
+{
+    // fields of TickData before transactionDigests
+    unsigned short computorIndex;
+    unsigned short epoch;
+    unsigned int tick;
+    unsigned short millisecond;
+    unsigned char second;
+    unsigned char minute;
+    unsigned char hour;
+    unsigned char day;
+    unsigned char month;
+    unsigned char year;
+    unsigned char timelock[32];
+
+    unsigned char signature[SIGNATURE_SIZE];
+    unsigned int numTransactions; // digests up to the last non-zero one
+    unsigned int numContractFees; // contract fees up to the last non-zero one
+};
+
+// View of an archived tick, pointing into the mapped segment file
+class ArchivedTick
+{
+public:
+    uint32_t tick() const { return mTick; }
+    // true if the tick has no tick data
+    bool empty() const { return mRecord == nullptr; }
+
+    const TickArchiveRecord& record() const { return *mRecord; }
+    unsigned int numTransactions() const { return mRecord->numTransactions; }
+    const uint8_t* digest(unsigned int i) const { return mDigests + size_t(i) * 32; }
+    // nullptr if the digest is zero
+    const Transaction* transaction(unsigned int i) const;
+    // size of the transaction including input and signature, 0 if the digest is zero
+    unsigned int transactionSize(unsigned int i) const { return mOffsets[i + 1] - mOffsets[i]; }
+
+    // Restore the TickData the tick was archived from.
+    void getTickData(TickData& td) const;
+
+private:
+    friend class TickArchive;
+
+    uint32_t mTick = 0;
+    const TickArchiveRecord* mRecord = nullptr;
+    const uint8_t* mDigests = nullptr;
+    const long long* mContractFees = nullptr;
+    const unsigned int* mOffsets = nullptr;
+    const uint8_t* mTransactions = nullptr;
+};
+
+// Read access to a tick archive through memory mappings of its segment files
+class TickArchive
+{
+public:
+    // Open the archive directory or a single segment file. Return false if it is neither.
+    bool open(const char* path);
+
+    // Archived ticks (including empty ones) in ascending order
+    std::vector<uint32_t> ticks() const;
+
+    // Return false if the tick is not archived or its record is invalid.
+    bool getTick(uint32_t tick, ArchivedTick& result) const;
+
+private:
+    struct Segment
+    {
+        std::string fileName;
+        std::unique_ptr<MappedFile> file;
+        const TickArchiveSegmentHeader* header;
+        const TickArchiveIndexEntry* index;
+    };
+    std::map<uint32_t, Segment> mSegments; // by first tick
+};
+
+// Return true if path is a tick archive directory or segment file.
+bool isTickArchive(const char* path);
+
+// Open a tick archive given as "<ARCHIVE>" (all ticks) or "<ARCHIVE>@<TICK>" (one tick), as accepted by -readtickdata
+// and -checktxonfile. ticks receives the ticks addressed. Return false if the path is not a tick archive.
+bool openTickArchivePath(const char* path, TickArchive& archive, std::vector<uint32_t>& ticks);
+
+// Appends ticks to a tick archive. Not thread safe.
+class TickArchiveWriter
+{
+public:
+    ~TickArchiveWriter();
+
+    // Open or create the archive directory. Return false on failure.
+    bool open(const char* dir);
+    void close();
+
+    // Return true if the tick has been archived before.
+    bool isArchived(uint32_t tick);
+
+    // Append a tick. transactions[i] (including input and signature) of size sizes[i] belongs to digest i of td and
+    // is ignored if the digest is zero. td == nullptr archives the tick as empty. Return false on write failure.
+    bool append(uint32_t tick, const TickData* td, const uint8_t* const* transactions, const unsigned int* sizes);
+
+private:
+    struct Segment
+    {
+        FILE* file;
+        std::vector<TickArchiveIndexEntry> index;
+    };
+    // Open or create the segment of the tick. Return nullptr if it doesn't exist and create is false, or on failure.
+    Segment* getSegment(uint32_t tick, bool create);
+
+    std::string mDir;
+    std::map<uint32_t, Segment> mSegments; // by first tick
+    std::set<uint32_t> mInvalidSegments; // first ticks of segment files that are not valid, reported once
+    std::vector<uint8_t> mRecord;
+};
+
+// Download the tick data and transactions of the ticks fromTick to toTick into the tick archive outputDir. The ticks
+// are spread over several connections to each node of g_nodeSet (or to nodeIp:nodePort), ticksInFlight of them at
+// once. A tick that fails or arrives incomplete is retried on the next node. A tick is only archived as empty if two
+// nodes that are past it have no tick data for it. Ticks already in the archive are skipped, so an interrupted run
+// resumes where it stopped. Ticks that failed on every attempt or that no second node confirmed as empty are retried by
+// the next run.
+void getTickRangeToArchive(const char* nodeIp, int nodePort, uint32_t fromTick, uint32_t toTick, const char* outputDir,
+                           unsigned int ticksInFlight);
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "tick_download.h"
+#include "k12_and_key_utils.h"
+
+static void finishTick(const TickDownloadQueuePtr& queue, const TickDownloadPtr& job, bool failed)
+{
+    job->failed = failed;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->finished.push_back(job);
+    queue->condition.notify_all();
+}
+
+static void requestTickTransactions(const TickDownloadQueuePtr& queue, const AsyncQCPtr& conn,
+                                    const TickDownloadPtr& job, unsigned long timeoutMillisec)
+{
+    struct
+    {
+        RequestResponseHeader header;
+        RequestedTickTransactions txs;
+    } packet;
+    packet.header.setSize(sizeof(packet));
+    packet.header.randomizeDejavu();
+    packet.header.setType(REQUEST_TICK_TRANSACTIONS);
+    packet.txs.tick = job->tick;
+    // a set flag means that the transaction is not needed
+    const uint8_t allZero[32] = { 0 };
+    memset(packet.txs.transactionFlags, 0, sizeof(packet.txs.transactionFlags));
+    for (int i = 0; i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
+    {
+        if (memcmp(job->tickData->transactionDigests[i], allZero, 32) == 0)
+            packet.txs.transactionFlags[i >> 3] |= (1 << (i & 7));
+    }
+
+    conn->request(std::vector<uint8_t>((const uint8_t*)&packet, (const uint8_t*)&packet + sizeof(packet)),
+        [job](const RequestResponseHeader& header, const uint8_t* payload)
+        {
+            if (header.type() == END_RESPOND)
+                return true;
+            if (header.type() != BROADCAST_TRANSACTION)
+                return false;
+            auto tx = (const Transaction*)payload;
+            size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+            if (payloadSize < sizeof(Transaction) || tx->inputSize > MAX_INPUT_SIZE
+                || payloadSize < sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE)
+            {
+                // dropped, so the tick is incomplete and retried
+                return false;
+            }
+            unsigned int txSize = (unsigned int)(sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE);
+            job->transactions.insert(job->transactions.end(), payload, payload + txSize);
+            job->transactionSizes.push_back(txSize);
+            return false;
+        },
+        [queue, job](std::exception_ptr error)
+        {
+            finishTick(queue, job, error != nullptr);
+        },
+        timeoutMillisec);
+}
+
+static void requestNodeTick(const TickDownloadQueuePtr& queue, const AsyncQCPtr& conn, const TickDownloadPtr& job,
+                            unsigned long timeoutMillisec)
+{
+    struct
+    {
+        RequestResponseHeader header;
+    } packet;
+    packet.header.setSize(sizeof(packet));
+    packet.header.randomizeDejavu();
+    packet.header.setType(REQUEST_CURRENT_TICK_INFO);
+
+    conn->request(std::vector<uint8_t>((const uint8_t*)&packet, (const uint8_t*)&packet + sizeof(packet)),
+        [job](const RequestResponseHeader& header, const uint8_t* payload)
+        {
+            if (header.type() != CurrentTickInfo::type())
+                return false;
+            if (header.size() - sizeof(RequestResponseHeader) >= sizeof(CurrentTickInfo))
+                job->nodeTick = ((const CurrentTickInfo*)payload)->tick;
+            return true;
+        },
+        [queue, job](std::exception_ptr error)
+        {
+            finishTick(queue, job, error != nullptr || job->nodeTick == 0);
+        },
+        timeoutMillisec);
+}
+
+void requestTick(const TickDownloadQueuePtr& queue, const AsyncQCPtr& conn, const TickDownloadPtr& job,
+                 unsigned long timeoutMillisec)
+{
+    struct
+    {
+        RequestResponseHeader header;
+        RequestTickData requestTickData;
+    } packet;
+    packet.header.setSize(sizeof(packet));
+    packet.header.randomizeDejavu();
+    packet.header.setType(REQUEST_TICK_DATA);
+    packet.requestTickData.requestedTickData.tick = job->tick;
+
+    job->failed = false;
+    job->tickData.reset();
+    job->nodeTick = 0;
+    job->transactions.clear();
+    job->transactionSizes.clear();
+    conn->request(std::vector<uint8_t>((const uint8_t*)&packet, (const uint8_t*)&packet + sizeof(packet)),
+        [job](const RequestResponseHeader& header, const uint8_t* payload)
+        {
+            // END_RESPOND without tick data means that the tick is empty
+            if (header.type() == END_RESPOND)
+                return true;
+            if (header.type() != TickData::type())
+                return false;
+            size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+            job->tickData = std::make_unique<TickData>();
+            memset(job->tickData.get(), 0, sizeof(TickData));
+            memcpy(job->tickData.get(), payload, std::min(payloadSize, sizeof(TickData)));
+            return true;
+        },
+        [queue, conn, job, timeoutMillisec](std::exception_ptr error)
+        {
+            if (error || (job->tickData && (job->tickData->tick != job->tick || job->tickData->epoch == 0)))
+            {
+                finishTick(queue, job, true);
+                return;
+            }
+            if (!job->tickData)
+            {
+                // only an empty tick if the node is past it, see the callers
+                requestNodeTick(queue, conn, job, timeoutMillisec);
+                return;
+            }
+            // get the transactions from the node that sent the tick data
+            requestTickTransactions(queue, conn, job, timeoutMillisec);
+        },
+        timeoutMillisec);
+}
+
+unsigned int matchTickTransactions(const TickData& td, const uint8_t* const* transactions, const unsigned int* sizes,
+                                   unsigned int count, int* match)
+{
+    std::vector<uint8_t> digests(size_t(count) * 32);
+    std::vector<uint8_t*> outputs(count);
+    for (unsigned int i = 0; i < count; i++)
+        outputs[i] = digests.data() + size_t(i) * 32;
+    KangarooTwelveMany(transactions, sizes, outputs.data(), 32, count);
+
+    std::unordered_map<std::string, unsigned int> byDigest;
+    byDigest.reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+        byDigest.emplace(std::string((const char*)outputs[i], 32), i);
+
+    const uint8_t allZero[32] = { 0 };
+    unsigned int numMissing = 0;
+    for (int i = 0; i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
+    {
+        match[i] = -1;
+        const uint8_t* digest = td.transactionDigests[i];
+        if (memcmp(digest, allZero, 32) == 0)
+            continue;
+        auto it = byDigest.find(std::string((const char*)digest, 32));
+        if (it == byDigest.end())
+            numMissing++;
+        else
+            match[i] = int(it->second);
+    }
+    return numMissing;
+}
+
+bool orderTickTransactions(const TickDownload& job, std::vector<const uint8_t*>& ordered,
+                                  std::vector<unsigned int>& orderedSizes)
+{
+    const unsigned int numReceived = (unsigned int)job.transactionSizes.size();
+    std::vector<const uint8_t*> inputs(numReceived);
+    size_t offset = 0;
+    for (unsigned int i = 0; i < numReceived; i++)
+    {
+        inputs[i] = job.transactions.data() + offset;
+        offset += job.transactionSizes[i];
+    }
+    int match[NUMBER_OF_TRANSACTIONS_PER_TICK];
+    if (matchTickTransactions(*job.tickData, inputs.data(), job.transactionSizes.data(), numReceived, match) != 0)
+        return false;
+
+    ordered.assign(NUMBER_OF_TRANSACTIONS_PER_TICK, nullptr);
+    orderedSizes.assign(NUMBER_OF_TRANSACTIONS_PER_TICK, 0);
+    for (int i = 0; i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
+    {
+        if (match[i] < 0)
+            continue;
+        ordered[i] = inputs[match[i]];
+        orderedSizes[i] = job.transactionSizes[match[i]];
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "event_loop.h"
+#include "structs.h"
+
+// Download of single ticks over the event loop, shared by -gettickrangetoarchive and -followticks
+
+// One tick being downloaded. Filled by the handlers on the event loop thread, checked by the thread driving the
+// download once it is in TickDownloadQueue::finished.
+struct TickDownload
+{
+    uint32_t tick;
+    int attempt = 0;
+    size_t connection = 0; // index of the connection used, kept by the caller
+    bool failed = false;
+    std::unique_ptr<TickData> tickData; // nullptr if the node has no tick data (empty tick)
+    uint32_t nodeTick = 0; // current tick of the node, requested if it has no tick data
+    std::vector<size_t> emptyFrom; // nodes that have no tick data for the tick (indices kept by the caller)
+    std::vector<uint8_t> transactions; // as received, including input and signature
+    std::vector<unsigned int> transactionSizes;
+};
+typedef std::shared_ptr<TickDownload> TickDownloadPtr;
+
+// Ticks finished by the handlers running on the event loop thread
+struct TickDownloadQueue
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<TickDownloadPtr> finished;
+};
+typedef std::shared_ptr<TickDownloadQueue> TickDownloadQueuePtr;
+
+// Request the tick data of job->tick on conn and then its transactions from the same node. If the node has no tick
+// data, its current tick is requested instead and stored in job->nodeTick, so that the caller can tell an empty tick
+// from a node that restarted or fell behind. job is pushed to queue when the requests are done, with failed set if a
+// request failed or the node sent tick data of another tick. timeoutMillisec is passed to
+// AsyncQubicConnection::request().
+void requestTick(const TickDownloadQueuePtr& queue, const AsyncQCPtr& conn, const TickDownloadPtr& job,
+                 unsigned long timeoutMillisec);
+
+// Hash the transactions (each including input and signature) with K12 and match them to the digests of td. match
+// has NUMBER_OF_TRANSACTIONS_PER_TICK entries and receives the index of the transaction with digest i, or -1 if the
+// digest is zero or none of the transactions has it. Return the number of non-zero digests without a transaction.
+unsigned int matchTickTransactions(const TickData& td, const uint8_t* const* transactions, const unsigned int* sizes,
+                                   unsigned int count, int* match);
+
+// Check that the transactions of the tick data of job have all been received. Return them by the index of their
+// digest, with nullptr for zero digests.
+bool orderTickTransactions(const TickDownload& job, std::vector<const uint8_t*>& ordered,
+                           std::vector<unsigned int>& orderedSizes);
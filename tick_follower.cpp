@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "tick_follower.h"
+#include "tick_archive.h"
+#include "tick_download.h"
+#include "defines.h"
+#include "structs.h"
+#include "event_loop.h"
+#include "key_utils.h"
+#include "node_rtt.h"
+#include "node_set.h"
+
+namespace
+{
+// Tick info of the nodes, updated by the handlers of the polls. Guarded by the mutex of the TickDownloadQueue, so that
+// an answered poll wakes up the main thread like a finished tick.
+struct FollowedNodes
+{
+    std::vector<uint32_t> ticks; // 0 if unknown or the node didn't answer
+    std::vector<uint32_t> initialTicks;
+    std::vector<bool> polling;
+    std::vector<unsigned int> numPolls; // finished
+};
+typedef std::shared_ptr<FollowedNodes> FollowedNodesPtr;
+
+// A downloaded tick waiting to be printed
+struct DownloadedTick
+{
+    TickDownloadPtr job;
+    std::vector<const uint8_t*> transactions; // by the index of their digest, see orderTickTransactions()
+};
+}
+
+static void pollNode(const TickDownloadQueuePtr& queue, const FollowedNodesPtr& nodes, const AsyncQCPtr& conn,
+                     size_t node)
+{
+    struct
+    {
+        RequestResponseHeader header;
+    } packet;
+    packet.header.setSize(sizeof(packet));
+    packet.header.randomizeDejavu();
+    packet.header.setType(REQUEST_CURRENT_TICK_INFO);
+
+    auto info = std::make_shared<CurrentTickInfo>();
+    memset(info.get(), 0, sizeof(CurrentTickInfo));
+    conn->request(std::vector<uint8_t>((const uint8_t*)&packet, (const uint8_t*)&packet + sizeof(packet)),
+        [info](const RequestResponseHeader& header, const uint8_t* payload)
+        {
+            if (header.type() == END_RESPOND)
+                return true;
+            if (header.type() != CurrentTickInfo::type())
+                return false;
+            size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+            memcpy(info.get(), payload, std::min(payloadSize, sizeof(CurrentTickInfo)));
+            return true;
+        },
+        [queue, nodes, node, info](std::exception_ptr error)
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            nodes->polling[node] = false;
+            nodes->numPolls[node]++;
+            nodes->ticks[node] = error ? 0 : info->tick;
+            nodes->initialTicks[node] = error ? 0 : info->initialTick;
+            queue->condition.notify_all();
+        },
+        getNodeTimeoutMsec(conn->nodeIp(), conn->nodePort()));
+}
+
+static void printTransaction(uint32_t tick, const uint8_t* digest, const uint8_t* transaction)
+{
+    Transaction tx;
+    memcpy(&tx, transaction, sizeof(Transaction));
+    char txHash[128] = { 0 };
+    char source[128] = { 0 };
+    char destination[128] = { 0 };
+    getTxHashFromDigest(digest, txHash);
+    getIdentityFromPublicKey(tx.sourcePublicKey, source, false);
+    getIdentityFromPublicKey(tx.destinationPublicKey, destination, false);
+    static const char hexDigits[] = "0123456789abcdef";
+    char payload[MAX_INPUT_SIZE * 2 + 1];
+    const uint8_t* input = transaction + sizeof(Transaction);
+    for (unsigned int i = 0; i < tx.inputSize; i++)
+    {
+        payload[2 * i] = hexDigits[input[i] >> 4];
+        payload[2 * i + 1] = hexDigits[input[i] & 15];
+    }
+    payload[2 * tx.inputSize] = 0;
+    printf("{\"tick\":%u,\"hash\":\"%s\",\"source\":\"%s\",\"destination\":\"%s\",\"amount\":%lld,\"inputType\":%u,"
+           "\"payload\":\"%s\"}\n",
+           tick, txHash, source, destination, (long long)tx.amount, tx.inputType, payload);
+}
+
+void followTicks(const char* nodeIp, int nodePort, uint32_t startTick, unsigned int ticksInFlight)
+{
+    if (ticksInFlight == 0)
+        ticksInFlight = DEFAULT_TICKS_IN_FLIGHT;
+    std::vector<NodeAddress> addresses = g_nodeSet;
+    if (addresses.empty())
+        addresses.push_back(NodeAddress{ nodeIp, nodePort });
+    const size_t numNodes = addresses.size();
+
+    // The ticks are pipelined on one connection per node, the polls go over another one so that they don't wait for
+    // the ticks.
+    QubicEventLoop loop;
+    std::vector<AsyncQCPtr> tickConnections;
+    std::vector<AsyncQCPtr> pollConnections;
+    const unsigned int perConnection = (ticksInFlight + unsigned(numNodes) - 1) / unsigned(numNodes);
+    for (const auto& address : addresses)
+    {
+        tickConnections.push_back(loop.connect(address.ip.c_str(), address.port));
+        tickConnections.back()->setMaxInFlight(perConnection);
+        pollConnections.push_back(loop.connect(address.ip.c_str(), address.port));
+    }
+
+    auto queue = std::make_shared<TickDownloadQueue>();
+    auto nodes = std::make_shared<FollowedNodes>();
+    nodes->ticks.assign(numNodes, 0);
+    nodes->initialTicks.assign(numNodes, 0);
+    nodes->polling.assign(numNodes, false);
+    nodes->numPolls.assign(numNodes, 0);
+    // copies taken by the main thread, and whether the node answered the last poll
+    std::vector<uint32_t> nodeTicks(numNodes, 0);
+    std::vector<uint32_t> nodeInitialTicks(numNodes, 0);
+    std::vector<unsigned int> numPolls(numNodes, 0);
+    std::vector<bool> nodeUp(numNodes, true);
+    std::vector<std::chrono::steady_clock::time_point> nextPoll(numNodes, std::chrono::steady_clock::now());
+
+    // Pick a node that is past the tick of job and has it in its tick storage, starting at the given index and
+    // skipping the nodes that answered that it is empty. Nodes that are not past the tick answer as if it was empty.
+    auto pickNode = [&](const TickDownload& job, size_t start)
+    {
+        for (size_t i = 0; i < numNodes; i++)
+        {
+            size_t n = (start + i) % numNodes;
+            if (nodeTicks[n] > job.tick && nodeInitialTicks[n] <= job.tick
+                && std::find(job.emptyFrom.begin(), job.emptyFrom.end(), n) == job.emptyFrom.end())
+                return n;
+        }
+        return size_t(-1);
+    };
+    // An empty tick is confirmed once TICK_FOLLOWER_EMPTY_CONFIRMATIONS nodes answered that it is empty, or all nodes
+    // that are up and have the tick in their epoch if there are fewer. The others may not be past it yet.
+    auto emptyConfirmed = [&](const TickDownload& job)
+    {
+        size_t numUp = job.emptyFrom.size();
+        for (size_t n = 0; n < numNodes; n++)
+        {
+            if (nodeTicks[n] != 0 && nodeInitialTicks[n] <= job.tick
+                && std::find(job.emptyFrom.begin(), job.emptyFrom.end(), n) == job.emptyFrom.end())
+                numUp++;
+        }
+        return !job.emptyFrom.empty()
+            && job.emptyFrom.size() >= std::min(numUp, size_t(TICK_FOLLOWER_EMPTY_CONFIRMATIONS));
+    };
+
+    uint32_t nextTick = startTick; // to print, 0 until the current tick is known
+    std::set<uint32_t> requested; // in flight, waiting for retry, or downloaded
+    std::map<uint32_t, DownloadedTick> downloaded;
+    std::multimap<std::chrono::steady_clock::time_point, TickDownloadPtr> retries; // by time to retry
+    std::map<uint32_t, unsigned int> waiting; // number of retries without a node that is past the tick
+    size_t nextNode = 0;
+    std::vector<const uint8_t*> ordered;
+    std::vector<unsigned int> orderedSizes;
+    if (startTick)
+        fprintf(stderr, "Following ticks from %u on %zu nodes\n", startTick, numNodes);
+
+    for (;;)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::vector<size_t> toPoll;
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            for (size_t n = 0; n < numNodes; n++)
+            {
+                nodeTicks[n] = nodes->ticks[n];
+                nodeInitialTicks[n] = nodes->initialTicks[n];
+                numPolls[n] = nodes->numPolls[n];
+                if (!nodes->polling[n] && now >= nextPoll[n])
+                {
+                    nodes->polling[n] = true;
+                    toPoll.push_back(n);
+                }
+            }
+        }
+        for (size_t n : toPoll)
+        {
+            pollNode(queue, nodes, pollConnections[n], n);
+            nextPoll[n] = now + std::chrono::milliseconds(TICK_FOLLOWER_POLL_MSEC);
+        }
+        for (size_t n = 0; n < numNodes; n++)
+        {
+            if (!numPolls[n] || (nodeTicks[n] != 0) == nodeUp[n])
+                continue;
+            nodeUp[n] = nodeTicks[n] != 0;
+            fprintf(stderr, "Node %s:%d is %s\n", addresses[n].ip.c_str(), addresses[n].port,
+                    nodeUp[n] ? "back" : "not answering, switching to the other nodes");
+        }
+
+        const size_t highest = std::max_element(nodeTicks.begin(), nodeTicks.end()) - nodeTicks.begin();
+        if (nodeTicks[highest])
+        {
+            if (nextTick == 0)
+            {
+                nextTick = nodeTicks[highest];
+                fprintf(stderr, "Following ticks from %u on %zu nodes\n", nextTick, numNodes);
+            }
+            // the ticks between the epochs don't exist
+            if (nextTick < nodeInitialTicks[highest])
+            {
+                fprintf(stderr, "Ticks %u to %u are not in the current epoch, continuing at %u\n", nextTick,
+                        nodeInitialTicks[highest] - 1, nodeInitialTicks[highest]);
+                nextTick = nodeInitialTicks[highest];
+                requested.erase(requested.begin(), requested.lower_bound(nextTick));
+                downloaded.erase(downloaded.begin(), downloaded.lower_bound(nextTick));
+                waiting.erase(waiting.begin(), waiting.lower_bound(nextTick));
+                for (auto it = retries.begin(); it != retries.end();)
+                    it = (it->second->tick < nextTick) ? retries.erase(it) : std::next(it);
+            }
+        }
+
+        // retries first, then the next ticks up to ticksInFlight ahead of the tick to print
+        while (!retries.empty() && retries.begin()->first <= now)
+        {
+            TickDownloadPtr job = retries.begin()->second;
+            retries.erase(retries.begin());
+            size_t n = pickNode(*job, job->connection + ((numNodes > 1) ? 1 : 0));
+            if (n == size_t(-1) && emptyConfirmed(*job))
+            {
+                // the other nodes went down since the tick was found empty
+                downloaded[job->tick].job = job;
+                waiting.erase(job->tick);
+                continue;
+            }
+            if (n == size_t(-1))
+            {
+                // wait for a node that is past the tick, but don't wait forever for a node that is stuck behind it to
+                // confirm an empty tick
+                unsigned int numWaits = ++waiting[job->tick];
+                if (job->emptyFrom.empty() && numWaits == TICK_FOLLOWER_STUCK_ATTEMPTS)
+                    fprintf(stderr, "Tick %u is stuck, no node is past it any more, waiting\n", job->tick);
+                if (!job->emptyFrom.empty() && numWaits >= TICK_FOLLOWER_STUCK_ATTEMPTS)
+                {
+                    const AsyncQCPtr& conn = tickConnections[job->emptyFrom.back()];
+                    fprintf(stderr, "Tick %u is empty on %s:%d, no other node got past it to confirm\n", job->tick,
+                            conn->nodeIp(), conn->nodePort());
+                    downloaded[job->tick].job = job;
+                    waiting.erase(job->tick);
+                    continue;
+                }
+                retries.emplace(now + std::chrono::milliseconds(TICK_FOLLOWER_POLL_MSEC), job);
+                continue;
+            }
+            waiting.erase(job->tick);
+            job->connection = n;
+            job->attempt++;
+            const AsyncQCPtr& conn = tickConnections[n];
+            requestTick(queue, conn, job, getNodeTimeoutMsec(conn->nodeIp(), conn->nodePort()) * (perConnection + 1));
+        }
+        for (uint32_t tick = nextTick; nextTick && tick - nextTick < ticksInFlight; tick++)
+        {
+            if (requested.count(tick))
+                continue;
+            auto job = std::make_shared<TickDownload>();
+            job->tick = tick;
+            size_t n = pickNode(*job, nextNode);
+            if (n == size_t(-1))
+                break;
+            nextNode = n + 1;
+            job->connection = n;
+            job->attempt = 1;
+            requested.insert(tick);
+            const AsyncQCPtr& conn = tickConnections[n];
+            requestTick(queue, conn, job, getNodeTimeoutMsec(conn->nodeIp(), conn->nodePort()) * (perConnection + 1));
+        }
+
+        std::deque<TickDownloadPtr> finished;
+        {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            auto wakeUpTime = *std::min_element(nextPoll.begin(), nextPoll.end());
+            if (!retries.empty())
+                wakeUpTime = std::min(wakeUpTime, retries.begin()->first);
+            queue->condition.wait_until(lock, wakeUpTime, [&]()
+            {
+                return !queue->finished.empty() || nodes->numPolls != numPolls;
+            });
+            finished.swap(queue->finished);
+        }
+
+        for (const auto& job : finished)
+        {
+            // skipped at an epoch change
+            if (job->tick < nextTick)
+                continue;
+            bool complete = !job->failed;
+            if (complete && job->tickData)
+                complete = orderTickTransactions(*job, ordered, orderedSizes);
+            const AsyncQCPtr& conn = tickConnections[job->connection];
+            if (complete && !job->tickData)
+            {
+                if (job->nodeTick <= job->tick)
+                {
+                    // the node restarted or fell behind, don't ask it for this tick until it is past it again
+                    fprintf(stderr, "Node %s:%d is at tick %u, behind tick %u\n", conn->nodeIp(), conn->nodePort(),
+                            job->nodeTick, job->tick);
+                    nodeTicks[job->connection] = std::min(nodeTicks[job->connection], job->nodeTick);
+                    std::lock_guard<std::mutex> lock(queue->mutex);
+                    nodes->ticks[job->connection] = std::min(nodes->ticks[job->connection], job->nodeTick);
+                    complete = false;
+                }
+                else
+                {
+                    job->emptyFrom.push_back(job->connection);
+                    if (!emptyConfirmed(*job))
+                    {
+                        // ask another node right away
+                        job->attempt--;
+                        retries.emplace(std::chrono::steady_clock::now(), job);
+                        continue;
+                    }
+                }
+            }
+            if (complete)
+            {
+                DownloadedTick& result = downloaded[job->tick];
+                result.job = job;
+                if (job->tickData)
+                    result.transactions = ordered;
+                continue;
+            }
+            // The delay doubles with every attempt. The following ticks can't be printed before this one, so a tick
+            // that keeps failing is reported as stuck, less often the longer it fails.
+            const unsigned long delay = getNodeRetryDelayMsec(conn->nodeIp(), conn->nodePort(), job->attempt);
+            if (job->attempt < TICK_FOLLOWER_STUCK_ATTEMPTS)
+                fprintf(stderr, "Failed to get tick %u from %s:%d (attempt %d), retrying\n", job->tick,
+                        conn->nodeIp(), conn->nodePort(), job->attempt);
+            else if ((job->attempt & (job->attempt - 1)) == 0)
+                fprintf(stderr, "Tick %u is stuck after %d attempts, last on %s:%d, the following ticks wait for it "
+                        "(retrying in %lu ms)\n", job->tick, job->attempt, conn->nodeIp(), conn->nodePort(), delay);
+            retries.emplace(std::chrono::steady_clock::now() + std::chrono::milliseconds(delay), job);
+        }
+
+        // print the ticks in order, while the following ones are being downloaded
+        bool printed = false;
+        while (!downloaded.empty() && downloaded.begin()->first == nextTick)
+        {
+            const DownloadedTick& tick = downloaded.begin()->second;
+            for (size_t i = 0; i < tick.transactions.size(); i++)
+            {
+                if (tick.transactions[i] != nullptr)
+                {
+                    printTransaction(nextTick, tick.job->tickData->transactionDigests[i], tick.transactions[i]);
+                    printed = true;
+                }
+            }
+            downloaded.erase(downloaded.begin());
+            requested.erase(nextTick);
+            nextTick++;
+        }
+        if (printed)
+            fflush(stdout);
+    }
+}
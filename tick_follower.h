@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// time between the current tick requests to each node
+#define TICK_FOLLOWER_POLL_MSEC 1000
+// nodes that have to answer that a tick is empty before it is printed as empty, if as many nodes are up
+#define TICK_FOLLOWER_EMPTY_CONFIRMATIONS 2
+// failed attempts after which a tick is reported as stuck, and again whenever the number of attempts doubles. Also the
+// number of polls to wait for a second node to confirm an empty tick.
+#define TICK_FOLLOWER_STUCK_ATTEMPTS 8
+
+// Follow the ticks of the nodes of g_nodeSet (or of nodeIp:nodePort) from startTick on (0 = the current tick) and
+// print each transaction as one line of JSON, in the order of the ticks and of the digests in the tick data:
+//   {"tick":N,"hash":"...","source":"...","destination":"...","amount":N,"inputType":N,"payload":"<hex>"}
+// A tick is downloaded once one of the nodes is past it, up to ticksInFlight ticks ahead of the tick being printed.
+// Failed ticks are retried on the next node that is past them, so no tick is skipped when a connection breaks or a
+// node falls behind, with a delay that doubles with every attempt. A tick without tick data is only taken as empty
+// once the node is known to be past it and a second node that is up agrees, unless none gets past the tick in time.
+// Status messages, including ticks that are stuck, go to stderr. Runs until it is stopped.
+void followTicks(const char* nodeIp, int nodePort, uint32_t startTick, unsigned int ticksInFlight);
@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tx_index.h"
+#include "common_functions.h"
+#include "defines.h"
+#include "structs.h"
+#include "k12_and_key_utils.h"
+#include "key_utils.h"
+#include "logger.h"
+#include "tick_archive.h"
+#include "tick_download.h"
+
+static_assert(sizeof(TxIndexSegment) % 8 == 0 && sizeof(TxIndexEntry) % 8 == 0, "index sections must be aligned");
+
+// ticks or tick files scanned per work item of buildTxIndex()
+#define TX_INDEX_SCAN_BATCH 256
+
+// The Bloom filters are blocked: all probes of a digest fall into one block of 512 bits (a cache line), selected by the
+// first word of the digest. The probes are taken 9 bits at a time from the second word. The digests are uniformly
+// distributed, so they don't need to be hashed again.
+static const uint64_t* bloomBlock(const uint64_t* bloom, uint64_t numBlocks, const uint8_t* digest)
+{
+    uint64_t h1;
+    memcpy(&h1, digest, 8);
+    return bloom + (h1 & (numBlocks - 1)) * TX_INDEX_BLOOM_BLOCK_WORDS;
+}
+
+static uint32_t bloomBit(const uint8_t* digest, uint32_t probe)
+{
+    uint64_t h2;
+    memcpy(&h2, digest + 8, 8);
+    return uint32_t(h2 >> (9 * probe)) & 511;
+}
+
+static bool digestLess(const TxIndexEntry& a, const TxIndexEntry& b)
+{
+    int cmp = memcmp(a.digest, b.digest, 32);
+    if (cmp != 0)
+        return cmp < 0;
+    return a.tick != b.tick ? a.tick < b.tick : a.position < b.position;
+}
+
+bool TxIndex::open(const char* fileName)
+{
+    mHeader = nullptr;
+    mSegments = nullptr;
+    if (!mFile.open(fileName) || mFile.size() < sizeof(TxIndexHeader))
+        return false;
+    const TxIndexHeader* header = (const TxIndexHeader*)mFile.data();
+    if (header->magic != TX_INDEX_MAGIC || header->version != TX_INDEX_VERSION || header->bloomProbes == 0
+        || header->bloomProbes > 7
+        || mFile.size() < sizeof(TxIndexHeader) + uint64_t(header->numSegments) * sizeof(TxIndexSegment))
+        return false;
+    const TxIndexSegment* segments = (const TxIndexSegment*)(mFile.data() + sizeof(TxIndexHeader));
+    for (uint32_t i = 0; i < header->numSegments; i++)
+    {
+        const TxIndexSegment& segment = segments[i];
+        const uint64_t numBlocks = segment.bloomWords / TX_INDEX_BLOOM_BLOCK_WORDS;
+        if (numBlocks == 0 || (numBlocks & (numBlocks - 1)) || segment.bloomWords % TX_INDEX_BLOOM_BLOCK_WORDS
+            || segment.bloomOffset % 8 || segment.entryOffset % 8
+            || segment.bloomOffset > mFile.size() || segment.bloomWords > (mFile.size() - segment.bloomOffset) / 8
+            || segment.entryOffset > mFile.size()
+            || segment.numEntries > (mFile.size() - segment.entryOffset) / sizeof(TxIndexEntry))
+            return false;
+    }
+    mHeader = header;
+    mSegments = segments;
+    return true;
+}
+
+void TxIndex::find(const uint8_t* digests, size_t count, std::vector<std::pair<size_t, TxIndexEntry>>& results) const
+{
+    results.clear();
+    TxIndexEntry key;
+    key.tick = 0;
+    key.position = 0;
+    for (uint32_t i = 0; i < mHeader->numSegments; i++)
+    {
+        const TxIndexSegment& segment = mSegments[i];
+        const uint64_t* bloom = (const uint64_t*)(mFile.data() + segment.bloomOffset);
+        const uint64_t numBlocks = segment.bloomWords / TX_INDEX_BLOOM_BLOCK_WORDS;
+        const TxIndexEntry* begin = (const TxIndexEntry*)(mFile.data() + segment.entryOffset);
+        const TxIndexEntry* end = begin + segment.numEntries;
+        for (size_t d = 0; d < count; d++)
+        {
+            const uint8_t* digest = digests + d * 32;
+            const uint64_t* block = bloomBlock(bloom, numBlocks, digest);
+            bool maybe = true;
+            for (uint32_t probe = 0; probe < mHeader->bloomProbes && maybe; probe++)
+            {
+                uint32_t bit = bloomBit(digest, probe);
+                maybe = (block[bit / 64] >> (bit % 64)) & 1;
+            }
+            if (!maybe)
+                continue;
+            memcpy(key.digest, digest, 32);
+            for (const TxIndexEntry* it = std::lower_bound(begin, end, key, digestLess);
+                 it != end && memcmp(it->digest, digest, 32) == 0; it++)
+                results.emplace_back(d, *it);
+        }
+    }
+    // the segments are in the order of their ticks
+    std::stable_sort(results.begin(), results.end(),
+                     [](const std::pair<size_t, TxIndexEntry>& a, const std::pair<size_t, TxIndexEntry>& b)
+                     {
+                         return a.first < b.first;
+                     });
+}
+
+// Append the entries of the non-zero digests of a tick.
+static void addTickEntries(uint32_t tick, const uint8_t (*digests)[32], unsigned int numDigests,
+                           std::vector<TxIndexEntry>& entries)
+{
+    for (unsigned int i = 0; i < numDigests; i++)
+    {
+        if (isArrayZero(digests[i], 32))
+            continue;
+        TxIndexEntry entry;
+        memcpy(entry.digest, digests[i], 32);
+        entry.tick = tick;
+        entry.position = i;
+        entries.push_back(entry);
+    }
+}
+
+// Check that file is a tick data file written by -gettickdata: a TickData of a non-zero tick and epoch followed by
+// some of its transactions (each including input and signature) and nothing else, all matching a digest of the tick
+// data. The name of the file doesn't matter.
+static bool isTickFile(const MappedFile& file)
+{
+    if (file.size() < sizeof(TickData))
+        return false;
+    const TickData* td = (const TickData*)file.data();
+    if (td->tick == 0 || td->epoch == 0)
+        return false;
+
+    unsigned int numDigests = 0;
+    for (int i = 0; i < NUMBER_OF_TRANSACTIONS_PER_TICK; i++)
+    {
+        if (!isArrayZero(td->transactionDigests[i], 32))
+            numDigests++;
+    }
+    std::vector<const uint8_t*> txs;
+    std::vector<unsigned int> txSizes;
+    size_t offset = sizeof(TickData);
+    while (offset < file.size())
+    {
+        if (txs.size() == numDigests || file.size() - offset < sizeof(Transaction))
+            return false;
+        const Transaction* tx = (const Transaction*)(file.data() + offset);
+        const size_t txSize = sizeof(Transaction) + tx->inputSize + SIGNATURE_SIZE;
+        if (tx->tick != td->tick || tx->inputSize > MAX_INPUT_SIZE || file.size() - offset < txSize)
+            return false;
+        txs.push_back(file.data() + offset);
+        txSizes.push_back((unsigned int)txSize);
+        offset += txSize;
+    }
+    if (txs.empty())
+        return true;
+    std::vector<int> match(NUMBER_OF_TRANSACTIONS_PER_TICK);
+    matchTickTransactions(*td, txs.data(), txSizes.data(), (unsigned int)txs.size(), match.data());
+    return (size_t)std::count_if(match.begin(), match.end(), [](int m) { return m >= 0; }) == txs.size();
+}
+
+void buildTxIndex(const char* tickFiles, const char* indexFile, unsigned int numThreads)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // One work item per TX_INDEX_SCAN_BATCH ticks of the archive or tick files of the directory. The digests of the
+    // tick data are indexed; the transactions are only hashed to check that a file is a tick data file.
+    TickArchive archive;
+    std::vector<uint32_t> ticks;
+    std::vector<std::string> fileNames;
+    const bool isArchive = archive.open(tickFiles);
+    if (isArchive)
+    {
+        ticks = archive.ticks();
+    }
+    else
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(tickFiles, ec))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(tickFiles, ec))
+            {
+                if (entry.is_regular_file(ec))
+                    fileNames.push_back(entry.path().string());
+            }
+        }
+        else
+        {
+            fileNames.push_back(tickFiles);
+        }
+    }
+    const size_t numItems = isArchive ? ticks.size() : fileNames.size();
+    const unsigned int numBatches = (unsigned int)((numItems + TX_INDEX_SCAN_BATCH - 1) / TX_INDEX_SCAN_BATCH);
+    std::vector<std::vector<TxIndexEntry>> batchEntries(numBatches);
+    std::atomic<unsigned int> numTicks(0);
+    std::atomic<unsigned int> numSkipped(0);
+    runOnThreads(numBatches, numThreads, [&](unsigned int batch)
+    {
+        std::vector<TxIndexEntry>& entries = batchEntries[batch];
+        const size_t end = std::min(numItems, size_t(batch + 1) * TX_INDEX_SCAN_BATCH);
+        for (size_t i = size_t(batch) * TX_INDEX_SCAN_BATCH; i < end; i++)
+        {
+            if (isArchive)
+            {
+                ArchivedTick tick;
+                if (!archive.getTick(ticks[i], tick))
+                {
+                    numSkipped++;
+                    continue;
+                }
+                if (!tick.empty())
+                {
+                    addTickEntries(tick.tick(), (const uint8_t (*)[32])tick.digest(0), tick.numTransactions(),
+                                   entries);
+                    numTicks++;
+                }
+            }
+            else
+            {
+                MappedFile file;
+                if (!file.open(fileNames[i].c_str()) || !isTickFile(file))
+                {
+                    numSkipped++;
+                    continue;
+                }
+                const TickData* td = (const TickData*)file.data();
+                addTickEntries(td->tick, td->transactionDigests, NUMBER_OF_TRANSACTIONS_PER_TICK, entries);
+                numTicks++;
+            }
+        }
+    });
+    if (numTicks == 0)
+    {
+        LOG("No ticks found in %s\n", tickFiles);
+        return;
+    }
+
+    std::map<uint32_t, std::vector<TxIndexEntry>> segmentEntries; // by first tick
+    for (auto& entries : batchEntries)
+    {
+        for (const TxIndexEntry& entry : entries)
+            segmentEntries[entry.tick - entry.tick % TICK_ARCHIVE_SEGMENT_TICKS].push_back(entry);
+        std::vector<TxIndexEntry>().swap(entries);
+    }
+
+    std::vector<TxIndexSegment> segments;
+    std::vector<std::vector<TxIndexEntry>*> sortedEntries;
+    for (auto& it : segmentEntries)
+    {
+        TxIndexSegment segment;
+        memset(&segment, 0, sizeof(segment));
+        segment.firstTick = it.first;
+        segments.push_back(segment);
+        sortedEntries.push_back(&it.second);
+    }
+    std::vector<std::vector<uint64_t>> blooms(segments.size());
+    runOnThreads((unsigned int)segments.size(), numThreads, [&](unsigned int i)
+    {
+        // a tick given twice, e.g. as two files, is indexed once
+        std::vector<TxIndexEntry>& entries = *sortedEntries[i];
+        std::sort(entries.begin(), entries.end(), digestLess);
+        entries.erase(std::unique(entries.begin(), entries.end(), [](const TxIndexEntry& a, const TxIndexEntry& b)
+        {
+            return memcmp(&a, &b, sizeof(TxIndexEntry)) == 0;
+        }), entries.end());
+
+        uint64_t numBlocks = 1;
+        while (numBlocks * TX_INDEX_BLOOM_BLOCK_WORDS * 64 < entries.size() * TX_INDEX_BLOOM_BITS_PER_ENTRY)
+            numBlocks *= 2;
+        std::vector<uint64_t>& bloom = blooms[i];
+        bloom.assign(numBlocks * TX_INDEX_BLOOM_BLOCK_WORDS, 0);
+        for (const TxIndexEntry& entry : entries)
+        {
+            uint64_t* block = (uint64_t*)bloomBlock(bloom.data(), numBlocks, entry.digest);
+            for (uint32_t probe = 0; probe < TX_INDEX_BLOOM_PROBES; probe++)
+            {
+                uint32_t bit = bloomBit(entry.digest, probe);
+                block[bit / 64] |= 1ULL << (bit % 64);
+            }
+        }
+    });
+
+    TxIndexHeader header;
+    header.magic = TX_INDEX_MAGIC;
+    header.version = TX_INDEX_VERSION;
+    header.numSegments = (uint32_t)segments.size();
+    header.bloomProbes = TX_INDEX_BLOOM_PROBES;
+    header.numEntries = 0;
+    uint64_t offset = sizeof(TxIndexHeader) + segments.size() * sizeof(TxIndexSegment);
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        segments[i].bloomOffset = offset;
+        segments[i].bloomWords = blooms[i].size();
+        offset += blooms[i].size() * 8;
+        segments[i].entryOffset = offset;
+        segments[i].numEntries = sortedEntries[i]->size();
+        offset += sortedEntries[i]->size() * sizeof(TxIndexEntry);
+        header.numEntries += sortedEntries[i]->size();
+    }
+
+    // write a temporary file and replace the index with it, so that an interrupted build keeps the previous index
+    std::string tempFile = std::string(indexFile) + ".tmp";
+    FILE* f = fopen(tempFile.c_str(), "wb");
+    if (!f)
+    {
+        LOG("Failed to create %s\n", tempFile.c_str());
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+        && fwrite(segments.data(), sizeof(TxIndexSegment), segments.size(), f) == segments.size();
+    for (size_t i = 0; ok && i < segments.size(); i++)
+    {
+        ok = fwrite(blooms[i].data(), 8, blooms[i].size(), f) == blooms[i].size()
+            && fwrite(sortedEntries[i]->data(), sizeof(TxIndexEntry), sortedEntries[i]->size(), f)
+                == sortedEntries[i]->size();
+    }
+    ok = fclose(f) == 0 && ok;
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tempFile, indexFile, ec);
+    if (!ok || ec)
+    {
+        LOG("Failed to write %s\n", indexFile);
+        std::filesystem::remove(tempFile, ec);
+        return;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG("Indexed %" PRIu64 " transactions of %u ticks in %u segments to %s in %.1f s\n",
+        header.numEntries, numTicks.load(), header.numSegments, indexFile, seconds);
+    if (numSkipped > 0)
+        LOG("Skipped %u files or ticks that could not be read or are not tick data\n", numSkipped.load());
+}
+
+void lookupTxIndex(const char* indexFile, const char* txHashes)
+{
+    TxIndex index;
+    if (!index.open(indexFile))
+    {
+        LOG("%s is not a transaction index of this version\n", indexFile);
+        return;
+    }
+
+    std::vector<std::string> hashes;
+    uint8_t digest[32];
+    if (strlen(txHashes) == 60 && getDigestFromTxHash(txHashes, digest))
+    {
+        hashes.push_back(txHashes);
+    }
+    else
+    {
+        std::ifstream in(txHashes);
+        if (!in.good())
+        {
+            LOG("%s is neither a tx hash nor a file of tx hashes\n", txHashes);
+            return;
+        }
+        std::string line;
+        while (std::getline(in, line))
+        {
+            line.erase(std::remove_if(line.begin(), line.end(), [](char c) { return isspace((unsigned char)c) != 0; }),
+                       line.end());
+            if (!line.empty())
+                hashes.push_back(line);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> digests(hashes.size() * 32);
+    std::vector<bool> valid(hashes.size());
+    for (size_t i = 0; i < hashes.size(); i++)
+        valid[i] = hashes[i].size() == 60 && getDigestFromTxHash(hashes[i].c_str(), digests.data() + i * 32);
+    std::vector<std::pair<size_t, TxIndexEntry>> results;
+    index.find(digests.data(), hashes.size(), results);
+    double millisec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    unsigned int numFound = 0;
+    auto result = results.begin();
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        if (!valid[i])
+        {
+            LOG("%s invalid tx hash\n", hashes[i].c_str());
+            continue;
+        }
+        if (result == results.end() || result->first != i)
+        {
+            LOG("%s not found\n", hashes[i].c_str());
+            continue;
+        }
+        numFound++;
+        for (; result != results.end() && result->first == i; result++)
+            LOG("%s tick %u position %u\n", hashes[i].c_str(), result->second.tick, result->second.position);
+    }
+    LOG("Found %u of %u tx hashes in %.1f ms\n", numFound, (unsigned int)hashes.size(), millisec);
+}
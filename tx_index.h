@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+
+// Transaction index: the transaction digests of many ticks, sorted, with the tick and the position of each digest in
+// the tick data. The digests are grouped into segments of TICK_ARCHIVE_SEGMENT_TICKS ticks like a tick archive, and
+// each segment has a Bloom filter of its digests, so a lookup only searches the segments whose filter matches.
+//
+// The file starts with a TxIndexHeader and numSegments TxIndexSegment entries in ascending order of firstTick. The
+// Bloom filter and the sorted TxIndexEntry array of each segment follow at the offsets given in its entry. All
+// integers are little endian.
+
+#define TX_INDEX_MAGIC 0x49585451 // "QTXI"
+#define TX_INDEX_VERSION 1
+#define TX_INDEX_BLOOM_BITS_PER_ENTRY 10 // at least, the number of blocks is rounded up to a power of 2
+#define TX_INDEX_BLOOM_PROBES 7 // at most 7, ~1% false positives with 10 bits per entry
+#define TX_INDEX_BLOOM_BLOCK_WORDS 8
+
+struct TxIndexHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numSegments;
+    uint32_t bloomProbes;
+    uint64_t numEntries;
+};
+
+struct TxIndexSegment
+{
+    uint32_t firstTick;
+    uint32_t reserved;
+    uint64_t bloomOffset;  // of the filter in the index file
+    uint64_t bloomWords;   // size of the filter in uint64_t, a power of 2 times TX_INDEX_BLOOM_BLOCK_WORDS
+    uint64_t entryOffset;  // of the entries in the index file
+    uint64_t numEntries;
+};
+
+struct TxIndexEntry
+{
+    uint8_t digest[32];
+    uint32_t tick;
+    uint32_t position; // index of the digest in TickData::transactionDigests
+};
+
+// Read access to a transaction index through a memory mapping
+class TxIndex
+{
+public:
+    // Return false if the file is not a transaction index of this version.
+    bool open(const char* fileName);
+
+    uint64_t numEntries() const { return mHeader->numEntries; }
+    uint32_t numSegments() const { return mHeader->numSegments; }
+
+    // Find the entries of count digests of 32 bytes. Each segment is checked for all digests in turn, so that its Bloom
+    // filter stays in the cache. results receives the index of the digest and the entry for each match, ordered by
+    // the digest index and then by tick.
+    void find(const uint8_t* digests, size_t count, std::vector<std::pair<size_t, TxIndexEntry>>& results) const;
+
+private:
+    MappedFile mFile;
+    const TxIndexHeader* mHeader = nullptr;
+    const TxIndexSegment* mSegments = nullptr;
+};
+
+// Index the transaction digests of a tick archive, or of a directory of tick data files written by -gettickdata, on
+// numThreads threads (0 = one per hardware thread). The index file is replaced when it is complete.
+void buildTxIndex(const char* tickFiles, const char* indexFile, unsigned int numThreads);
+
+// Look up a tx hash, or each tx hash in a file with one of them per line, in the index and print the ticks that
+// contain them.
+void lookupTxIndex(const char* indexFile, const char* txHashes);
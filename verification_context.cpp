@@ -0,0 +1,156 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "verification_context.h"
+#include "k12_and_key_utils.h"
+#include "logger.h"
+
+// Cache file: header followed by NUMBER_OF_COMPUTORS VerificationKey in memory layout, so it can only be read by a
+// build with the same layout. The keys are only used if the digest of the key payload matches and each key has the
+// public key of the computor list, so a corrupt or truncated file is prepared again.
+#define VERIFICATION_KEYS_MAGIC 0x4B565143 // "CQVK"
+#define VERIFICATION_KEYS_VERSION 2
+
+struct VerificationKeysHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t keySize; // sizeof(VerificationKey)
+    uint32_t numKeys;
+    uint8_t listDigest[32];
+    uint8_t keysDigest[32]; // K12 of the NUMBER_OF_COMPUTORS keys
+};
+
+bool g_cacheComputorKeys = false;
+
+static std::mutex contextsMutex;
+static std::map<std::string, std::shared_ptr<const ComputorVerificationContext>> contexts; // by computor list digest
+
+ComputorVerificationContext::ComputorVerificationContext(const BroadcastComputors& bc, const char* cacheFileName)
+    : mEpoch(bc.computors.epoch), mKeys(new VerificationKey[NUMBER_OF_COMPUTORS])
+{
+    KangarooTwelve((const uint8_t*)&bc, sizeof(BroadcastComputors), mListDigest, 32);
+    if (cacheFileName && loadCache(cacheFileName, bc))
+        return;
+    runOnThreads(NUMBER_OF_COMPUTORS, std::thread::hardware_concurrency(), [&](unsigned int i)
+    {
+        prepareVerificationKey(bc.computors.publicKeys[i], &mKeys[i]);
+    });
+    if (cacheFileName)
+        saveCache(cacheFileName);
+}
+
+ComputorVerificationContext::~ComputorVerificationContext()
+{
+}
+
+bool ComputorVerificationContext::loadCache(const char* fileName, const BroadcastComputors& bc)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (!f)
+        return false;
+    VerificationKeysHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1
+        && header.magic == VERIFICATION_KEYS_MAGIC && header.version == VERIFICATION_KEYS_VERSION
+        && header.keySize == sizeof(VerificationKey) && header.numKeys == NUMBER_OF_COMPUTORS
+        && memcmp(header.listDigest, mListDigest, 32) == 0;
+    if (!ok)
+    {
+        fclose(f);
+        LOG("Ignoring %s, it has not been written for this computor list\n", fileName);
+        return false;
+    }
+
+    // read the keys as bytes and check them before using them as VerificationKey
+    std::vector<uint8_t> keys(sizeof(VerificationKey) * NUMBER_OF_COMPUTORS);
+    ok = fread(keys.data(), keys.size(), 1, f) == 1;
+    fclose(f);
+    if (ok)
+    {
+        uint8_t keysDigest[32];
+        KangarooTwelveParallel(keys.data(), keys.size(), keysDigest, 32, std::thread::hardware_concurrency());
+        ok = memcmp(keysDigest, header.keysDigest, 32) == 0;
+    }
+    for (unsigned int i = 0; ok && i < NUMBER_OF_COMPUTORS; i++)
+    {
+        const uint8_t* key = keys.data() + sizeof(VerificationKey) * i;
+        const uint8_t valid = key[offsetof(VerificationKey, valid)];
+        ok = memcmp(key + offsetof(VerificationKey, publicKey), bc.computors.publicKeys[i], 32) == 0 && valid <= 1;
+    }
+    if (!ok)
+    {
+        LOG("Ignoring %s, its keys are corrupt\n", fileName);
+        return false;
+    }
+    memcpy(mKeys.get(), keys.data(), keys.size());
+    return true;
+}
+
+void ComputorVerificationContext::saveCache(const char* fileName) const
+{
+    FILE* f = fopen(fileName, "wb");
+    if (!f)
+    {
+        LOG("Failed to write %s\n", fileName);
+        return;
+    }
+    VerificationKeysHeader header;
+    header.magic = VERIFICATION_KEYS_MAGIC;
+    header.version = VERIFICATION_KEYS_VERSION;
+    header.keySize = sizeof(VerificationKey);
+    header.numKeys = NUMBER_OF_COMPUTORS;
+    memcpy(header.listDigest, mListDigest, 32);
+    KangarooTwelveParallel((const uint8_t*)mKeys.get(), sizeof(VerificationKey) * NUMBER_OF_COMPUTORS, header.keysDigest,
+                           32, std::thread::hardware_concurrency());
+    if (fwrite(&header, sizeof(header), 1, f) != 1
+        || fwrite(mKeys.get(), sizeof(VerificationKey), NUMBER_OF_COMPUTORS, f) != NUMBER_OF_COMPUTORS)
+    {
+        LOG("Failed to write %s\n", fileName);
+    }
+    fclose(f);
+}
+
+bool ComputorVerificationContext::verify(unsigned int computorIndex, const uint8_t* digest, const uint8_t* signature) const
+{
+    if (computorIndex >= NUMBER_OF_COMPUTORS)
+        return false;
+    return verifyWithKey(&mKeys[computorIndex], digest, signature);
+}
+
+void ComputorVerificationContext::verifyBatch(const unsigned int* computorIndices, const uint8_t* const* digests,
+                                              const uint8_t* const* signatures, unsigned int count, uint8_t* results) const
+{
+    // an out of range index gets an invalid key, so that its signature fails
+    VerificationKey invalidKey;
+    memset(&invalidKey, 0, sizeof(invalidKey));
+    std::vector<const VerificationKey*> keys(count);
+    for (unsigned int i = 0; i < count; i++)
+        keys[i] = (computorIndices[i] < NUMBER_OF_COMPUTORS) ? &mKeys[computorIndices[i]] : &invalidKey;
+    verifyBatchWithKeys(keys.data(), digests, signatures, count, results, 0);
+}
+
+std::shared_ptr<const ComputorVerificationContext> getComputorVerificationContext(const BroadcastComputors& bc,
+                                                                                  const char* compFileName)
+{
+    uint8_t digest[32];
+    KangarooTwelve((const uint8_t*)&bc, sizeof(BroadcastComputors), digest, 32);
+    std::string key((const char*)digest, 32);
+
+    std::lock_guard<std::mutex> lock(contextsMutex);
+    auto it = contexts.find(key);
+    if (it != contexts.end())
+        return it->second;
+    std::string cacheFileName;
+    if (g_cacheComputorKeys && compFileName)
+        cacheFileName = std::string(compFileName) + ".keys";
+    auto context = std::make_shared<const ComputorVerificationContext>(bc,
+        cacheFileName.empty() ? nullptr : cacheFileName.c_str());
+    contexts[key] = context;
+    return context;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "structs.h"
+
+struct VerificationKey;
+
+// Save the prepared computor keys next to the computor list file (-cachekeys), see getComputorVerificationContext()
+extern bool g_cacheComputorKeys;
+
+// Public keys of the computors of an epoch, decoded and prepared once for verifying their signatures (votes, tick data,
+// vote counter transactions) with verifyWithKey().
+class ComputorVerificationContext
+{
+public:
+    // Prepare the keys of bc. With cacheFileName, the keys are read from that file if it has been written for the same
+    // computor list and its keys are intact, otherwise they are prepared and written to it.
+    ComputorVerificationContext(const BroadcastComputors& bc, const char* cacheFileName = nullptr);
+    ~ComputorVerificationContext();
+
+    unsigned short epoch() const { return mEpoch; }
+
+    // Verify a signature of the computor like verify().
+    bool verify(unsigned int computorIndex, const uint8_t* digest, const uint8_t* signature) const;
+
+    // Verify count signatures of computors at once like verifyBatch(). Bit i % 8 of results[i / 8] is set if signature
+    // i is valid.
+    void verifyBatch(const unsigned int* computorIndices, const uint8_t* const* digests, const uint8_t* const* signatures,
+                     unsigned int count, uint8_t* results) const;
+
+private:
+    bool loadCache(const char* fileName, const BroadcastComputors& bc);
+    void saveCache(const char* fileName) const;
+
+    unsigned short mEpoch;
+    uint8_t mListDigest[32]; // of the computor list
+    std::unique_ptr<VerificationKey[]> mKeys;
+};
+
+// Return the context for the computor list bc, read from compFileName. Contexts are kept for the lifetime of the
+// process, so each list is prepared once. With g_cacheComputorKeys, the keys are also cached in <compFileName>.keys.
+std::shared_ptr<const ComputorVerificationContext> getComputorVerificationContext(const BroadcastComputors& bc,
+                                                                                  const char* compFileName = nullptr);
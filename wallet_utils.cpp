@@ -1,8 +1,11 @@
+#include <array>
 #include <chrono>
 #include <thread>
 #include <cstdint>
 #include <cstring>
+#include <fstream>
 #include <stdexcept>
+#include <string>
 
 #include "utils.h"
 #include "node_utils.h"
@@ -10,7 +13,9 @@
 #include "logger.h"
 #include "structs.h"
 #include "connection.h"
+#include "event_loop.h"
 #include "k12_and_key_utils.h"
+#include "node_set.h"
 #include "sc_utils.h"
 
 void printWalletInfo(const char* seed)
@@ -34,14 +39,115 @@ void printWalletInfo(const char* seed)
     LOG("Identity: %s\n", publicIdentity);
 }
 
+void deriveKeysFromSeedFile(const char* seedFile, const char* outputFile, unsigned int numThreads,
+                            unsigned int combWidth, unsigned int combTables)
+{
+    std::ifstream infile(seedFile);
+    if (!infile.is_open())
+    {
+        LOG("Failed to open %s\n", seedFile);
+        return;
+    }
+    FILE* f = fopen(outputFile, "w");
+    if (!f)
+    {
+        LOG("Failed to create %s\n", outputFile);
+        return;
+    }
+    if (!numThreads)
+    {
+        numThreads = std::thread::hardware_concurrency();
+        if (!numThreads)
+            numThreads = 1;
+    }
+    fputs("Seed,Identity,PublicKey\n", f);
+
+    // seeds are read, derived and written in blocks, so the file can be larger than the memory
+    const size_t DERIVE_BLOCK_SIZE = 65536;
+    std::vector<std::string> seeds;
+    std::vector<std::array<uint8_t, 32>> publicKeys(DERIVE_BLOCK_SIZE);
+    std::vector<std::array<char, 61>> identities(DERIVE_BLOCK_SIZE);
+    std::vector<std::array<char, 61>> publicKeyStrings(DERIVE_BLOCK_SIZE);
+    std::vector<const char*> seedPtrs;
+    std::vector<uint8_t*> publicKeyPtrs(DERIVE_BLOCK_SIZE);
+    std::vector<const uint8_t*> constPublicKeyPtrs(DERIVE_BLOCK_SIZE);
+    std::vector<char*> identityPtrs(DERIVE_BLOCK_SIZE);
+    std::vector<char*> publicKeyStringPtrs(DERIVE_BLOCK_SIZE);
+    std::vector<uint8_t> valid(DERIVE_BLOCK_SIZE / 8);
+    for (size_t k = 0; k < DERIVE_BLOCK_SIZE; k++)
+    {
+        publicKeyPtrs[k] = publicKeys[k].data();
+        constPublicKeyPtrs[k] = publicKeys[k].data();
+        identityPtrs[k] = identities[k].data();
+        publicKeyStringPtrs[k] = publicKeyStrings[k].data();
+    }
+
+    uint64_t numDerived = 0;
+    uint64_t numInvalid = 0;
+    uint64_t lineNo = 0;
+    double deriveSeconds = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    std::string line;
+    bool endOfFile = false;
+    while (!endOfFile)
+    {
+        seeds.clear();
+        while (seeds.size() < DERIVE_BLOCK_SIZE)
+        {
+            if (!std::getline(infile, line))
+            {
+                endOfFile = true;
+                break;
+            }
+            ++lineNo;
+            while (!line.empty() && isspace((unsigned char)line.back()))
+                line.pop_back();
+            if (line.empty())
+                continue;
+            if (line.size() != 55 || line.find_first_not_of("abcdefghijklmnopqrstuvwxyz") != std::string::npos)
+            {
+                LOG("Invalid seed at line %llu, expected 55 lowercase letters\n", (unsigned long long)lineNo);
+                numInvalid++;
+                continue;
+            }
+            seeds.push_back(line);
+        }
+        if (seeds.empty())
+            break;
+
+        seedPtrs.resize(seeds.size());
+        for (size_t k = 0; k < seeds.size(); k++)
+            seedPtrs[k] = seeds[k].c_str();
+        auto deriveStartTime = std::chrono::steady_clock::now();
+        if (!getPublicKeysFromSeeds(seedPtrs.data(), publicKeyPtrs.data(), seeds.size(), valid.data(),
+                                    numThreads, combWidth, combTables))
+        {
+            LOG("Invalid comb table size %u %u\n", combWidth, combTables);
+            break;
+        }
+        deriveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - deriveStartTime).count();
+
+        // the seeds have been checked while reading, so all keys are valid
+        getIdentitiesFromPublicKeys(constPublicKeyPtrs.data(), identityPtrs.data(), seeds.size(), false);
+        getIdentitiesFromPublicKeys(constPublicKeyPtrs.data(), publicKeyStringPtrs.data(), seeds.size(), true);
+        for (size_t k = 0; k < seeds.size(); k++)
+            fprintf(f, "%s,%s,%s\n", seeds[k].c_str(), identities[k].data(), publicKeyStrings[k].data());
+        numDerived += seeds.size();
+    }
+    fclose(f);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    LOG("Derived %llu keys in %.3f s: %.0f keys/s including I/O, %.0f keys/s for the derivation alone (%u threads)\n",
+        (unsigned long long)numDerived, seconds, (seconds > 0) ? numDerived / seconds : 0.0,
+        (deriveSeconds > 0) ? numDerived / deriveSeconds : 0.0, numThreads);
+    if (numInvalid)
+        LOG("Skipped %llu invalid seeds\n", (unsigned long long)numInvalid);
+}
+
 RespondedEntity getBalance(const char* nodeIp, const int nodePort, const uint8_t* publicKey)
 {
     RespondedEntity result;
     memset(&result, 0, sizeof(RespondedEntity));
-    std::vector<uint8_t> buffer;
-    buffer.resize(0);
-    uint8_t tmp[1024] = {0};
-    auto qc = make_qc(nodeIp, nodePort);
     struct {
         RequestResponseHeader header;
         RequestedEntity req;
@@ -50,27 +156,26 @@ RespondedEntity getBalance(const char* nodeIp, const int nodePort, const uint8_t
     packet.header.randomizeDejavu();
     packet.header.setType(REQUEST_ENTITY);
     memcpy(packet.req.publicKey, publicKey, 32);
-    qc->sendData((uint8_t *) &packet, packet.header.size());
-    int recvByte = qc->receiveData(tmp, 1024);
-    while (recvByte > 0)
+    if (!g_nodeSet.empty())
     {
-        buffer.resize(recvByte + buffer.size());
-        memcpy(buffer.data() + buffer.size() - recvByte, tmp, recvByte);
-        recvByte = qc->receiveData(tmp, 1024);
-    }
-    uint8_t* data = buffer.data();
-    recvByte = int(buffer.size());
-    int ptr = 0;
-    while (ptr < recvByte)
-    {
-        auto header = (RequestResponseHeader*)(data+ptr);
-        if (header->type() == RESPOND_ENTITY)
+        // first response of a node that isn't behind the others
+        if (!nodeSetRequestPacketAs<RespondedEntity>(&packet, packet.header.size(), result, nullptr,
+                [](const RespondedEntity& entity) { return entity.tick; }))
         {
-            auto entity = (RespondedEntity*)(data + ptr + sizeof(RequestResponseHeader));
-            result = *entity;
+            memset(&result, 0, sizeof(RespondedEntity));
         }
-        ptr+= header->size();
+        return result;
     }
+    auto qc = make_qc(nodeIp, nodePort);
+    qc->sendData((uint8_t *) &packet, packet.header.size());
+    qc->receiveResponse([&result](const RequestResponseHeader& header, const uint8_t* payload)
+    {
+        if (header.type() != RESPOND_ENTITY)
+            return false;
+        size_t payloadSize = header.size() - sizeof(RequestResponseHeader);
+        memcpy(&result, payload, (payloadSize < sizeof(RespondedEntity)) ? payloadSize : sizeof(RespondedEntity));
+        return true;
+    });
 
     return result;
 }
@@ -179,22 +284,46 @@ bool verifyTx(Transaction& tx, const uint8_t* extraData, const uint8_t* signatur
     return verify(tx.sourcePublicKey, digest, signature);
 }
 
+std::vector<bool> verifyTxs(const Transaction* const* txs, unsigned int count)
+{
+    std::vector<const uint8_t*> inputs(count);
+    std::vector<unsigned int> inputSizes(count);
+    std::vector<uint8_t> digests(count * 32);
+    std::vector<uint8_t*> outputs(count);
+    std::vector<const uint8_t*> publicKeys(count);
+    std::vector<const uint8_t*> signaturePtrs(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // the signature follows the input, sign the transaction and input in place
+        inputs[i] = (const uint8_t*)txs[i];
+        inputSizes[i] = sizeof(Transaction) + txs[i]->inputSize;
+        outputs[i] = digests.data() + i * 32;
+        publicKeys[i] = txs[i]->sourcePublicKey;
+        signaturePtrs[i] = inputs[i] + inputSizes[i];
+    }
+    KangarooTwelveMany(inputs.data(), inputSizes.data(), outputs.data(), 32, count);
+    std::vector<uint8_t> results((count + 7) / 8);
+    if (!verifyBatch(publicKeys.data(), outputs.data(), signaturePtrs.data(), count, results.data(), 0))
+        LOG("Failed to allocate memory for verifying %u signatures\n", count);
+    std::vector<bool> valid(count);
+    for (unsigned int i = 0; i < count; i++)
+        valid[i] = (results[i / 8] >> (i % 8)) & 1;
+    return valid;
+}
+
 void makeStandardTransactionInTick(const char* nodeIp, int nodePort, const char* seed,
                              const char* targetIdentity, const uint64_t amount, uint32_t txTick,
                              int waitUntilFinish)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     getPublicKeyFromIdentity(targetIdentity, destPublicKey);
@@ -213,7 +342,7 @@ void makeStandardTransactionInTick(const char* nodeIp, int nodePort, const char*
                    sizeof(packet.transaction),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet.header)+sizeof(packet.transaction) + 64);
     packet.header.zeroDejavu();
@@ -270,17 +399,14 @@ void makeCustomTransaction(const char* nodeIp, int nodePort,
         throw std::invalid_argument("extraDataSize < 0");
 
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     getPublicKeyFromIdentity(targetIdentity, destPublicKey);
@@ -306,7 +432,7 @@ void makeCustomTransaction(const char* nodeIp, int nodePort,
                    sizeof(Transaction) + extraDataSize,
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.data() + sizeof(RequestResponseHeader) + sizeof(Transaction) + extraDataSize, signature, SIGNATURE_SIZE);
     temp_packet.header.setSize(sizeof(RequestResponseHeader) + sizeof(Transaction) + extraDataSize + SIGNATURE_SIZE);
     temp_packet.header.zeroDejavu();
@@ -341,17 +467,14 @@ void makeContractTransaction(const char* nodeIp, int nodePort,
 {
     QCPtr qc = (!qcPtr) ? make_qc(nodeIp, nodePort) : *qcPtr;
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint64_t destPublicKey[4] = { contractIndex, 0, 0, 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
     char publicIdentity[128] = { 0 };
     char txHash[128] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     std::vector<uint8_t> packet(sizeof(RequestResponseHeader) + sizeof(Transaction) + extraDataSize + SIGNATURE_SIZE);
     RequestResponseHeader& packetHeader = (RequestResponseHeader&)packet[0];
@@ -377,7 +500,7 @@ void makeContractTransaction(const char* nodeIp, int nodePort,
         sizeof(Transaction) + extraDataSize,
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, packetSignature);
+    signer.sign(digest, packetSignature);
 
     qc->sendData(packet.data(), int(packet.size()));
 
@@ -404,7 +527,6 @@ bool runContractFunction(const char* nodeIp, int nodePort,
     size_t outputSize,
     QCPtr* qcPtr = nullptr)
 {
-    QCPtr qc = (!qcPtr) ? make_qc(nodeIp, nodePort) : *qcPtr;
     std::vector<uint8_t> packet(sizeof(RequestResponseHeader) + sizeof(RequestContractFunction) + inputSize);
     RequestResponseHeader& packetHeader = (RequestResponseHeader&)packet[0];
     RequestContractFunction& packetRcf = (RequestContractFunction&)packet[sizeof(RequestResponseHeader)];
@@ -418,6 +540,25 @@ bool runContractFunction(const char* nodeIp, int nodePort,
     packetRcf.contractIndex = contractIndex;
     if (inputSize)
         memcpy(packetInputData, inputPtr, inputSize);
+
+    if (!qcPtr && !g_nodeSet.empty())
+    {
+        // the output is empty if the invocation failed, so wait for another node in this case
+        std::vector<uint8_t> payload;
+        if (!nodeSetRequest(packet.data(), packet.size(), RespondContractFunction::type(),
+                [outputSize](const uint8_t*, size_t size) { return size >= outputSize; }, payload))
+        {
+            return false;
+        }
+        if (payload.size() > outputSize)
+        {
+            LOG("WARNING: Response of runContractFunction() is %llu bytes longer than expected. Dropping unexpected part that cannot be interpreted.\n", (unsigned long long)(payload.size() - outputSize));
+        }
+        memcpy(outputPtr, payload.data(), outputSize);
+        return true;
+    }
+
+    QCPtr qc = (!qcPtr) ? make_qc(nodeIp, nodePort) : *qcPtr;
     qc->sendData(&packet[0], packetHeader.size());
 
     const size_t fullPacketSize = sizeof(RequestResponseHeader) + outputSize;
@@ -445,6 +586,66 @@ bool runContractFunction(const char* nodeIp, int nodePort,
     return false;
 }
 
+std::vector<bool> runContractFunctionMany(const char* nodeIp, int nodePort,
+    unsigned int contractIndex,
+    unsigned short funcNumber,
+    const void* inputs,
+    size_t inputSize,
+    void* outputs,
+    size_t outputSize,
+    size_t numCalls,
+    unsigned int maxInFlight)
+{
+    QubicEventLoop loop;
+    AsyncQCPtr conn = loop.connect(nodeIp, nodePort);
+    conn->setMaxInFlight(maxInFlight);
+
+    std::vector<std::future<bool>> results;
+    for (size_t i = 0; i < numCalls; i++)
+    {
+        std::vector<uint8_t> packet(sizeof(RequestResponseHeader) + sizeof(RequestContractFunction) + inputSize);
+        RequestResponseHeader& packetHeader = (RequestResponseHeader&)packet[0];
+        RequestContractFunction& packetRcf = (RequestContractFunction&)packet[sizeof(RequestResponseHeader)];
+        packetHeader.setSize(uint32_t(packet.size()));
+        packetHeader.randomizeDejavu();
+        packetHeader.setType(RequestContractFunction::type());
+        packetRcf.inputSize = uint16_t(inputSize);
+        packetRcf.inputType = funcNumber;
+        packetRcf.contractIndex = contractIndex;
+        if (inputSize)
+            memcpy(&packet[sizeof(RequestResponseHeader) + sizeof(RequestContractFunction)], (const uint8_t*)inputs + i * inputSize, inputSize);
+
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto success = std::make_shared<bool>(false);
+        uint8_t* output = (uint8_t*)outputs + i * outputSize;
+        results.push_back(promise->get_future());
+        conn->request(std::move(packet),
+            [success, output, outputSize](const RequestResponseHeader& header, const uint8_t* payload)
+            {
+                if (header.type() == END_RESPOND)
+                    return true;
+                if (header.type() != RespondContractFunction::type())
+                    return false;
+                // the output is empty if the invocation failed; longer output cannot be interpreted and is dropped
+                if (header.size() - sizeof(RequestResponseHeader) >= outputSize)
+                {
+                    memcpy(output, payload, outputSize);
+                    *success = true;
+                }
+                return true;
+            },
+            [promise, success](std::exception_ptr error)
+            {
+                promise->set_value(!error && *success);
+            });
+    }
+
+    std::vector<bool> ok(numCalls);
+    for (size_t i = 0; i < numCalls; i++)
+        ok[i] = results[i].get();
+    return ok;
+}
+
 bool runContractFunction(const char* nodeIp, int nodePort,
     unsigned int contractIndex,
     unsigned short funcNumber,
@@ -515,17 +716,14 @@ void invokeContractProcedure(const char* nodeIp, int nodePort,
 {
     auto qc = make_qc(nodeIp, nodePort);
 
-    uint8_t privateKey[32] = { 0 };
     uint8_t sourcePublicKey[32] = { 0 };
     uint64_t destPublicKey[4] = { contractIndex, 0, 0, 0 };
-    uint8_t subseed[32] = { 0 };
     uint8_t digest[32] = { 0 };
     uint8_t signature[64] = { 0 };
     char publicIdentity[128] = { 0 };
     char txHash[128] = { 0 };
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
 
     ContractObject contractObject = buildContractObject(formatInput, true);
     auto extraDataSize = (unsigned short)contractObject.getSize();
@@ -562,7 +760,7 @@ void invokeContractProcedure(const char* nodeIp, int nodePort,
         sizeof(Transaction) + extraDataSize,
         digest,
         32);
-    sign(subseed, sourcePublicKey, digest, packetSignature);
+    signer.sign(digest, packetSignature);
 
     qc->sendData(packet.data(), int(packet.size()));
 
@@ -585,17 +783,14 @@ void makeIPOBid(const char* nodeIp, int nodePort,
                 uint32_t scheduledTickOffset)
 {
     auto qc = make_qc(nodeIp, nodePort);
-    uint8_t privateKey[32] = {0};
     uint8_t sourcePublicKey[32] = {0};
     uint8_t destPublicKey[32] = {0};
-    uint8_t subseed[32] = {0};
     uint8_t digest[32] = {0};
     uint8_t signature[64] = {0};
     char publicIdentity[128] = {0};
     char txHash[128] = {0};
-    getSubseedFromSeed((uint8_t*)seed, subseed);
-    getPrivateKeyFromSubSeed(subseed, privateKey);
-    getPublicKeyFromPrivateKey(privateKey, sourcePublicKey);
+    const SigningContext& signer = getSigningContext(seed);
+    memcpy(sourcePublicKey, signer.publicKey(), 32);
     const bool isLowerCase = false;
     getIdentityFromPublicKey(sourcePublicKey, publicIdentity, isLowerCase);
     // Contracts are identified by their index stored in the first 64 bits of the id, all
@@ -626,7 +821,7 @@ void makeIPOBid(const char* nodeIp, int nodePort,
                    sizeof(packet.transaction) + sizeof(packet.ipo),
                    digest,
                    32);
-    sign(subseed, sourcePublicKey, digest, signature);
+    signer.sign(digest, signature);
     memcpy(packet.signature, signature, 64);
     packet.header.setSize(sizeof(packet));
     packet.header.zeroDejavu();
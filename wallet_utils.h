@@ -1,9 +1,16 @@
 #pragma once
 
+#include <vector>
+
 #include "structs.h"
 #include "connection.h"
+#include "event_loop.h"
 
 void printWalletInfo(const char* seed);
+// Write the identity and public key of each seed in seedFile (one per line) to outputFile as CSV, deriving on numThreads
+// threads (0 = one per hardware thread), and print the keys per second. See getPublicKeysFromSeeds() for the comb.
+void deriveKeysFromSeedFile(const char* seedFile, const char* outputFile, unsigned int numThreads,
+                            unsigned int combWidth, unsigned int combTables);
 void printBalance(const char* publicIdentity, const char* nodeIp, int nodePort);
 void makeStandardTransaction(const char* nodeIp, int nodePort, const char* seed,
                              const char* targetIdentity, const uint64_t amount, uint32_t scheduledTickOffset,
@@ -45,6 +52,17 @@ bool runContractFunction(const char* nodeIp, int nodePort,
     unsigned short funcNumber,
     const char* formatInput,
     const char* formatOutput);
+// Call a contract function numCalls times, pipelining the requests on one connection. inputs holds numCalls inputs of
+// inputSize bytes each, outputs receives numCalls outputs of outputSize bytes each. Returns which calls succeeded.
+std::vector<bool> runContractFunctionMany(const char* nodeIp, int nodePort,
+    unsigned int contractIndex,
+    unsigned short funcNumber,
+    const void* inputs,
+    size_t inputSize,
+    void* outputs,
+    size_t outputSize,
+    size_t numCalls,
+    unsigned int maxInFlight = DEFAULT_PIPELINE_DEPTH);
 void invokeContractProcedure(const char* nodeIp, int nodePort,
     const char* seed,
     uint64_t contractIndex,
@@ -55,6 +73,9 @@ void invokeContractProcedure(const char* nodeIp, int nodePort,
 
 void printReceipt(Transaction& tx, const char* txHash = nullptr, const uint8_t* extraData = nullptr, int moneyFlew = -1);
 bool verifyTx(Transaction& tx, const uint8_t* extraData, const uint8_t* signature);
+// Verify the signatures of many transactions at once with verifyBatch(), return one flag per transaction. Each
+// transaction is followed by its input and signature in memory.
+std::vector<bool> verifyTxs(const Transaction* const* txs, unsigned int count);
 void makeIPOBid(const char* nodeIp, int nodePort,
                 const char* seed,
                 uint32_t contractIndex,
@@ -0,0 +1,244 @@
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "wire_capture.h"
+#include "logger.h"
+
+static std::mutex recordMutex;
+static FILE* recordFile = nullptr;
+static std::chrono::steady_clock::time_point recordStartTime;
+static unsigned int recordConnections = 0;
+
+static bool replaying = false;
+static double replaySpeed = 1.0;
+static std::mutex replayMutex;
+// recorded connections not opened yet, by ip:port in the order they were opened
+static std::map<std::string, std::deque<std::unique_ptr<ReplayConnection>>> replayConnections;
+
+static std::string nodeKey(const char* nodeIp, int nodePort)
+{
+    return std::string(nodeIp) + ":" + std::to_string(nodePort);
+}
+
+bool startWireRecording(const char* fileName)
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (recordFile)
+        fclose(recordFile);
+    recordFile = fopen(fileName, "wb");
+    if (!recordFile)
+    {
+        LOG("Failed to open capture file %s\n", fileName);
+        return false;
+    }
+    uint32_t header[2] = { WIRE_CAPTURE_MAGIC, WIRE_CAPTURE_VERSION };
+    fwrite(header, sizeof(header), 1, recordFile);
+    fflush(recordFile);
+    recordStartTime = std::chrono::steady_clock::now();
+    recordConnections = 0;
+    return true;
+}
+
+bool isWireRecording()
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    return recordFile != nullptr;
+}
+
+// Append one event. recordMutex must be locked.
+static void writeEvent(WireCaptureEventKind kind, unsigned int connectionId, const uint8_t* data, uint32_t size)
+{
+    uint64_t timeMicrosec = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - recordStartTime).count();
+    uint8_t event[17];
+    event[0] = kind;
+    memcpy(event + 1, &connectionId, 4);
+    memcpy(event + 5, &timeMicrosec, 8);
+    memcpy(event + 13, &size, 4);
+    fwrite(event, sizeof(event), 1, recordFile);
+    if (size)
+        fwrite(data, size, 1, recordFile);
+    // keep the capture usable if the process is killed, which is likely when recording a hanging session
+    fflush(recordFile);
+}
+
+unsigned int recordWireConnection(const char* nodeIp, int nodePort)
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (!recordFile)
+        return 0;
+    unsigned int connectionId = recordConnections++;
+    std::string address = nodeKey(nodeIp, nodePort);
+    writeEvent(WIRE_CAPTURE_OPEN, connectionId, (const uint8_t*)address.data(), uint32_t(address.size()));
+    return connectionId;
+}
+
+void recordWireData(unsigned int connectionId, WireCaptureEventKind kind, const uint8_t* data, int size)
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (!recordFile)
+        return;
+    writeEvent(kind, connectionId, data, (size > 0) ? uint32_t(size) : 0);
+}
+
+bool startWireReplay(const char* fileName, double speed)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (!f)
+    {
+        LOG("Failed to open capture file %s\n", fileName);
+        return false;
+    }
+    uint32_t header[2];
+    if (fread(header, sizeof(header), 1, f) != 1 || header[0] != WIRE_CAPTURE_MAGIC || header[1] != WIRE_CAPTURE_VERSION)
+    {
+        LOG("%s is not a capture file of this version\n", fileName);
+        fclose(f);
+        return false;
+    }
+
+    struct RecordedConnection
+    {
+        std::string address;
+        uint64_t openTimeMicrosec;
+        size_t numSends;
+        uint64_t lastSendMicrosec; // relative to open
+        std::unique_ptr<ReplayConnection> replay;
+    };
+    std::map<unsigned int, RecordedConnection> connections;
+    std::vector<unsigned int> openOrder;
+    uint8_t event[17];
+    bool truncated = false;
+    while (fread(event, sizeof(event), 1, f) == 1)
+    {
+        unsigned int connectionId;
+        uint64_t timeMicrosec;
+        uint32_t size;
+        memcpy(&connectionId, event + 1, 4);
+        memcpy(&timeMicrosec, event + 5, 8);
+        memcpy(&size, event + 13, 4);
+        std::vector<uint8_t> data(size);
+        if (size && fread(data.data(), size, 1, f) != 1)
+        {
+            truncated = true;
+            break;
+        }
+
+        if (event[0] == WIRE_CAPTURE_OPEN)
+        {
+            RecordedConnection& conn = connections[connectionId];
+            conn.address.assign(data.begin(), data.end());
+            conn.openTimeMicrosec = timeMicrosec;
+            conn.numSends = 0;
+            conn.lastSendMicrosec = 0;
+            conn.replay.reset(new ReplayConnection());
+            openOrder.push_back(connectionId);
+            continue;
+        }
+        auto it = connections.find(connectionId);
+        if (it == connections.end())
+            continue;
+        RecordedConnection& conn = it->second;
+        uint64_t sinceOpen = (timeMicrosec > conn.openTimeMicrosec) ? timeMicrosec - conn.openTimeMicrosec : 0;
+        if (event[0] == WIRE_CAPTURE_SENT)
+        {
+            conn.numSends++;
+            conn.lastSendMicrosec = sinceOpen;
+        }
+        else if (event[0] == WIRE_CAPTURE_RECEIVED)
+        {
+            ReplayConnection::Chunk chunk;
+            chunk.timeMicrosec = sinceOpen;
+            chunk.sendIndex = conn.numSends;
+            chunk.sendTimeMicrosec = conn.lastSendMicrosec;
+            chunk.data = std::move(data);
+            conn.replay->mChunks.push_back(std::move(chunk));
+        }
+    }
+    fclose(f);
+    if (truncated)
+        LOG("Capture file %s is truncated, replaying the complete events\n", fileName);
+
+    std::lock_guard<std::mutex> lock(replayMutex);
+    replayConnections.clear();
+    for (unsigned int connectionId : openOrder)
+    {
+        RecordedConnection& conn = connections[connectionId];
+        replayConnections[conn.address].push_back(std::move(conn.replay));
+    }
+    replaySpeed = speed;
+    replaying = true;
+    return true;
+}
+
+bool isWireReplaying()
+{
+    return replaying;
+}
+
+std::unique_ptr<ReplayConnection> openReplayConnection(const char* nodeIp, int nodePort)
+{
+    std::lock_guard<std::mutex> lock(replayMutex);
+    auto it = replayConnections.find(nodeKey(nodeIp, nodePort));
+    if (it == replayConnections.end() || it->second.empty())
+        return nullptr;
+    std::unique_ptr<ReplayConnection> conn = std::move(it->second.front());
+    it->second.pop_front();
+    conn->mOpenTime = std::chrono::steady_clock::now();
+    return conn;
+}
+
+void ReplayConnection::sent()
+{
+    mSendTimes.push_back(std::chrono::steady_clock::now());
+}
+
+int ReplayConnection::receive(uint8_t* buffer, int size)
+{
+    int total = 0;
+    while (total < size && mNextChunk < mChunks.size())
+    {
+        const Chunk& chunk = mChunks[mNextChunk];
+        if (mOffset == 0 && replaySpeed > 0)
+        {
+            // Delay the chunk as long as it took after the send it followed. If the client sent less than in the
+            // recording, the session has diverged and the data is delivered right away.
+            std::chrono::steady_clock::time_point reference;
+            bool known = true;
+            if (chunk.sendIndex == 0)
+                reference = mOpenTime;
+            else if (chunk.sendIndex <= mSendTimes.size())
+                reference = mSendTimes[chunk.sendIndex - 1];
+            else
+                known = false;
+            if (known)
+            {
+                uint64_t delay = chunk.timeMicrosec - ((chunk.sendIndex == 0) ? 0 : chunk.sendTimeMicrosec);
+                std::this_thread::sleep_until(reference + std::chrono::microseconds((long long)(delay / replaySpeed)));
+            }
+        }
+        if (chunk.data.empty())
+        {
+            // receiving failed here in the recording
+            mNextChunk++;
+            break;
+        }
+        int n = int(chunk.data.size() - mOffset);
+        if (n > size - total)
+            n = size - total;
+        memcpy(buffer + total, chunk.data.data() + mOffset, n);
+        total += n;
+        mOffset += n;
+        if (mOffset == chunk.data.size())
+        {
+            mNextChunk++;
+            mOffset = 0;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Record (-record) and replay (-replay) of the bytes sent and received by QubicConnection.
+//
+// A capture file starts with WIRE_CAPTURE_MAGIC and WIRE_CAPTURE_VERSION (uint32 each), followed by events of
+//   uint8 kind, uint32 connection id, uint64 microseconds since the recording started, uint32 size, size bytes
+// Open events carry "ip:port" of the node. A receive event of size 0 means that receiving failed (timeout, closed
+// connection, or error).
+
+#define WIRE_CAPTURE_MAGIC 0x50414351 // "QCAP"
+#define WIRE_CAPTURE_VERSION 1
+
+enum WireCaptureEventKind : uint8_t
+{
+    WIRE_CAPTURE_OPEN = 0,
+    WIRE_CAPTURE_SENT = 1,
+    WIRE_CAPTURE_RECEIVED = 2,
+};
+
+// Start writing all QubicConnection traffic to fileName. Return false if the file cannot be created.
+bool startWireRecording(const char* fileName);
+bool isWireRecording();
+
+// Record that a connection to nodeIp:nodePort has been established. Return its id for recordWireData().
+unsigned int recordWireConnection(const char* nodeIp, int nodePort);
+
+// Record data sent to or received from the node. Thread safe.
+void recordWireData(unsigned int connectionId, WireCaptureEventKind kind, const uint8_t* data, int size);
+
+// Serve the connections recorded in fileName instead of connecting to nodes. speed scales the recorded delays
+// (2 = twice as fast, 0 = no delays). Return false if the file cannot be read.
+bool startWireReplay(const char* fileName, double speed);
+bool isWireReplaying();
+
+// One recorded connection, played back to a QubicConnection. The received data is delivered with the delay it had
+// after the corresponding send in the recording. What the client sends is not checked, so the client must issue the
+// same requests as in the recording.
+class ReplayConnection
+{
+public:
+    // Receive up to size bytes like recv() in a loop. Return less than size if the recording ends or receiving
+    // failed at this point of the recording.
+    int receive(uint8_t* buffer, int size);
+
+    // Notify that the client sent data.
+    void sent();
+
+private:
+    friend std::unique_ptr<ReplayConnection> openReplayConnection(const char* nodeIp, int nodePort);
+    friend bool startWireReplay(const char* fileName, double speed);
+
+    struct Chunk
+    {
+        uint64_t timeMicrosec; // since the connection was opened
+        size_t sendIndex;      // number of sends recorded before this chunk
+        uint64_t sendTimeMicrosec; // time of the last send before this chunk (or 0)
+        std::vector<uint8_t> data; // empty if receiving failed
+    };
+
+    std::vector<Chunk> mChunks;
+    size_t mNextChunk = 0;
+    size_t mOffset = 0; // in mChunks[mNextChunk]
+    std::chrono::steady_clock::time_point mOpenTime;
+    std::vector<std::chrono::steady_clock::time_point> mSendTimes; // of the client
+};
+
+// Return the next recorded connection to nodeIp:nodePort, or nullptr if there is none left.
+std::unique_ptr<ReplayConnection> openReplayConnection(const char* nodeIp, int nodePort);